@@ -116,18 +116,45 @@
 
 #include "UObject/Stack.h"
 #include "Engine/Level.h"
+#include "Engine/World.h"
 
 #include "GameFramework/Actor.h"
+#include "GameFramework/Pawn.h"
 
 #include "Misc/ExpressionParser.h"
 #include "Internationalization/Regex.h"
 
 #include "Misc/TextFilterUtils.h"
+#include "Hash/CityHash.h"
+#include "Hash/xxhash.h"
+#include "Async/ParallelFor.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/GarbageCollection.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "HAL/IConsoleManager.h"
 #include <inttypes.h> // For printing address.
 
-// Switch on to turn on unreal insights events for performance tests.
+#if PROPERTY_WATCHER_BENCHMARKS
+#include "Misc/MemStack.h"
+#include "Math/RandomStream.h"
+#include "Misc/Parse.h"
+#include "Components/SceneComponent.h"
+#include "UObject/UObjectIterator.h"
+#endif
+
+// Unreal Insights events, enable at runtime with -trace=cpu,PropertyWatcher or "Trace.Enable PropertyWatcher".
+#if CPUPROFILERTRACE_ENABLED
+UE_TRACE_CHANNEL_DEFINE(PropertyWatcherChannel)
+#define SCOPE_EVENT(name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(name, PropertyWatcherChannel)
+#else
 #define SCOPE_EVENT(name) 
-//#define SCOPE_EVENT(name) SCOPED_NAMED_EVENT_TEXT(name, FColor::Orange);
+#endif
 
 #if WITH_EDITORONLY_DATA
 #define MetaData_Available true
@@ -145,17 +172,24 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 	SCOPE_EVENT("PropertyWatcher::Update");
 
 	TMem.Init(TMemoryStartSize);
-	defer{ TMem.ClearAll(); };
+	Profiler.BeginFrame();
+	defer{ Counters.Emit(); };
+	defer{ Profiler.EndFrame(); };
+	defer{ TMem.Reset(); };
+	defer{ JsonIO.ApplyPendingWrites(); };
+
+	if (Init) {
+		NodeCache.Clear();
+		WatchPaths.Clear();
+	}
+	NodeCache.NewFrame();
+	JsonIO.UpdateExport();
+	SpatialIndex.HasOrigin = World && GetPlayerLocation(World, SpatialIndex.Origin);
+	Sampler.Update(World);
 
 	*WantsToLoad = false;
 	*WantsToSave = false;
 
-	// Performance test.
-	static const int TimerCount = 30;
-	static double Timers[TimerCount] = {};
-	static int TimerIndex = 0;
-	double StartTime = FPlatformTime::Seconds();
-
 	ImGui::SetNextWindowSize(ImVec2(430, 450), ImGuiCond_FirstUseEver);
 	bool WindowIsOpen = ImGui::Begin(ImGui_StoA(*("Property Watcher: " + WindowName)), IsOpen, ImGuiWindowFlags_MenuBar); defer{ ImGui::End(); };
 	if (!WindowIsOpen)
@@ -164,6 +198,15 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 	static ImVec2 FramePadding = ImVec2(ImGui::GetStyle().CellPadding.x, 2);
 	static bool ShowObjectNamesOnAllProperties = true;
 	static bool ShowPerformanceInfo = false;
+	static bool VirtualizedRows = false;
+	static bool HighlightValueChanges = true;
+	static float ValueChangeFadeTime = 1.5f;
+	Profiler.Enabled = ShowPerformanceInfo;
+#if PROPERTY_WATCHER_BENCHMARKS
+	Profiler.Enabled |= Benchmark.Active;
+	if (Benchmark.Active)
+		VirtualizedRows = Benchmark.VirtualizedRows;
+#endif
 
 	// Menu.
 	if (ImGui::BeginMenuBar()) {
@@ -180,7 +223,33 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 			ImGuiAddon::QuickTooltip("This puts the (<ObjectName>) at the end of properties that are also objects.");
 
 			ImGui::Checkbox("Show debug/performance info", &ShowPerformanceInfo);
-			ImGuiAddon::QuickTooltip("Displays item count and average elapsed time in ms.");
+			ImGuiAddon::QuickTooltip("Displays item count and average elapsed time in ms, and opens the profiler window.");
+
+			ImGui::SetNextItemWidth(150);
+			ImGui::SliderInt("Deep search depth", &DeepSearch.MaxDepth, 1, 20);
+			ImGui::SetNextItemWidth(150);
+			ImGui::DragFloat("Deep search budget (ms)", &DeepSearch.BudgetMs, 0.1f, 0.1f, 16.0f, "%.1f");
+			ImGuiAddon::QuickTooltip("Time per frame that the deep search is allowed to take.");
+
+			if (ImGui::Checkbox("Deep search background index", &DeepSearchIndex.Enabled) && !DeepSearchIndex.Enabled)
+				DeepSearchIndex.Clear();
+			ImGuiAddon::QuickTooltip("Deep search runs against an index that gets built on a worker thread.\nOnly object members are indexed, arrays/maps/sets and struct roots are skipped.");
+			if (DeepSearchIndex.Enabled) {
+				ImGui::SetNextItemWidth(150);
+				ImGui::DragFloat("Index refresh (s)", &DeepSearchIndex.RefreshInterval, 0.1f, 0.5f, 60.0f, "%.1f");
+				if (DeepSearchIndex.Index)
+					ImGui::TextDisabled("Index: %s, %d entries, %d objects, %.1f ms", ImGui_StoA(*DeepSearchIndex.Index->TabName), DeepSearchIndex.Index->Entries.Num(), DeepSearchIndex.Index->ObjectCount, DeepSearchIndex.Index->BuildMs);
+			}
+
+			ImGui::Checkbox("Highlight value changes", &HighlightValueChanges);
+			ImGuiAddon::QuickTooltip("Watch tab rows light up when their value changes.");
+			if (HighlightValueChanges) {
+				ImGui::SetNextItemWidth(150);
+				ImGui::DragFloat("Highlight fade time (s)", &ValueChangeFadeTime, 0.05f, 0.1f, 10.0f, "%.2f");
+			}
+
+			ImGui::Checkbox("Virtualized rows", &VirtualizedRows);
+			ImGuiAddon::QuickTooltip("Only draws the rows that are scrolled into view, for big open trees.\nNot used in the watch tab and while filtering.");
 		}
 		if (ImGui::BeginMenu("Help")) {
 			defer{ ImGui::EndMenu(); };
@@ -201,6 +270,7 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 		ColInfos.Infos.Add({ ColumnID_Category, "category", "Category",       FlagDefault | FlagNoSort | ImGuiTableColumnFlags_DefaultHide });
 		ColInfos.Infos.Add({ ColumnID_Address,  "address",  "Adress",         FlagDefault | ImGuiTableColumnFlags_DefaultHide });
 		ColInfos.Infos.Add({ ColumnID_Size,     "size",     "Size",           FlagDefault | ImGuiTableColumnFlags_DefaultHide });
+		ColInfos.Infos.Add({ ColumnID_Distance, "distance", "Distance",       FlagDefault | ImGuiTableColumnFlags_DefaultHide });
 		ColInfos.Infos.Add({ ColumnID_Remove,   "",         "Remove",         ImGuiTableColumnFlags_WidthFixed, ImGui::GetFrameHeight() });
 	}
 
@@ -209,7 +279,14 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 	static bool EnableClassCategoriesOnObjectItems = true;
 	static bool SearchFilterActive = false;
 	static char SearchString[100];
-	SimpleSearchParser SearchParser;
+	static SimpleSearchParser SearchParser;
+	static char ParsedSearchString[100];
+#if PROPERTY_WATCHER_BENCHMARKS
+	if (Benchmark.Active) {
+		FCStringAnsi::Strncpy(SearchString, ImGui_StoA(*Benchmark.SearchString), IM_ARRAYSIZE(SearchString));
+		SearchFilterActive = Benchmark.SearchFilter;
+	}
+#endif
 	{
 		// Search.
 		bool SelectAll = false;
@@ -244,7 +321,79 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 		ImGuiAddon::QuickTooltip("Show functions in actor items.");
 		ImGui::Spacing();
 
-		SearchParser.ParseExpression(SearchString, ColInfos.GetSearchNameArray());
+		// Parser views point into ParsedSearchString, so it only changes together with the compiled query.
+		if (FCStringAnsi::Strcmp(SearchString, ParsedSearchString) != 0) {
+			FCStringAnsi::Strncpy(ParsedSearchString, SearchString, IM_ARRAYSIZE(ParsedSearchString));
+			PROFILE_PHASE(Phase_SearchParse);
+			SearchParser.ParseExpression(ParsedSearchString, ColInfos.GetSearchNameArray());
+		}
+
+		// Deep search.
+		{
+			if (!DeepSearch.QueryEquals(SearchString) && (DeepSearch.IsRunning || DeepSearch.Results.Num()))
+				DeepSearch.Clear();
+
+			ImGui::BeginDisabled(!SearchParser.Commands.Num() && !DeepSearch.IsRunning);
+			if (ImGui::Button(DeepSearch.IsRunning ? "Stop###DeepSearch" : "Deep Search###DeepSearch")) {
+				if (DeepSearch.IsRunning)
+					DeepSearch.Stop();
+				else
+					DeepSearch.Request(SearchString, ColInfos.GetSearchNameArray(), EnableClassCategoriesOnObjectItems);
+			}
+			ImGui::EndDisabled();
+			ImGuiAddon::QuickTooltip("Searches closed items as well, a bit every frame.\nF3/Shift+F3 go to the next/previous result.");
+
+			int ResultCount = DeepSearch.Results.Num();
+			ImGui::SameLine();
+			ImGui::BeginDisabled(!ResultCount);
+			{
+				bool GotoPrev = ImGui::ArrowButton("##PrevResult", ImGuiDir_Left);
+				ImGui::SameLine();
+				bool GotoNext = ImGui::ArrowButton("##NextResult", ImGuiDir_Right);
+				if (ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) && ImGui::IsKeyPressed(ImGuiKey_F3)) {
+					if (ImGui::IsKeyDown(ImGuiMod_Shift))
+						GotoPrev = true;
+					else
+						GotoNext = true;
+				}
+
+				if (ResultCount && GotoNext)
+					DeepSearch.Goto((DeepSearch.CurrentResult + 1) % ResultCount);
+				else if (ResultCount && GotoPrev)
+					DeepSearch.Goto((DeepSearch.CurrentResult - 1 + ResultCount) % ResultCount);
+
+				ImGui::SameLine();
+				if (ImGui::Button(*TMem.Printf("Results %d/%d###DeepSearchResults", DeepSearch.CurrentResult + 1, ResultCount)))
+					ImGui::OpenPopup("DeepSearchResultsPopup");
+			}
+			ImGui::EndDisabled();
+
+			if (DeepSearch.IsRunning) {
+				ImGui::SameLine();
+				if (DeepSearch.UsesIndex)
+					ImGui::TextDisabled(DeepSearchIndex.IsQuerying() ? "Searching index..." : "Building index...");
+				else
+					ImGui::TextDisabled("Searching... (%d objects)", DeepSearch.VisitedObjects.Num());
+			}
+
+			ImGui::SetNextWindowSizeConstraints(ImVec2(0, 0), ImVec2(FLT_MAX, 400));
+			if (ImGui::BeginPopup("DeepSearchResultsPopup")) {
+				ImGuiListClipper Clipper;
+				Clipper.Begin(DeepSearch.Results.Num());
+				while (Clipper.Step())
+					for (int i = Clipper.DisplayStart; i < Clipper.DisplayEnd; i++) {
+						ImGui::PushID(i);
+						if (ImGui::Selectable(ImGui_StoA(*DeepSearch.Results[i].Path), i == DeepSearch.CurrentResult))
+							DeepSearch.Goto(i);
+						ImGui::PopID();
+					}
+				ImGui::EndPopup();
+			}
+
+			DeepSearchIndex.Update();
+			DeepSearch.Step();
+			ImGui::Spacing();
+		}
 	}
 
 	// Tabs.
@@ -258,11 +407,24 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 		static bool DrawHoveredAddresses = false;
 		defer{ DrawHoveredAddresses = AddressHoveredThisFrame; };
 
-		static TArray<FString> Tabs = { "Objects", "Actors", "Watch" };
+		// Tabs pick up the deep search request when they're drawn.
+		defer{ DeepSearch.StartRequested = false; DeepSearch.SelectTab = false; };
+
+		static TArray<FString> Tabs = { "Objects", "Actors", "Watch", "Snapshots" };
 		for (auto CurrentTab : Tabs) {
-			if (ImGui::BeginTabItem(ImGui_StoA(*CurrentTab))) {
+			int TabFlags = DeepSearch.SelectTab && DeepSearch.TabName == CurrentTab ? ImGuiTabItemFlags_SetSelected : 0;
+#if PROPERTY_WATCHER_BENCHMARKS
+			if (Benchmark.Active && Benchmark.Tab == CurrentTab)
+				TabFlags |= ImGuiTabItemFlags_SetSelected;
+#endif
+			if (ImGui::BeginTabItem(ImGui_StoA(*CurrentTab), 0, TabFlags)) {
 				defer{ ImGui::EndTabItem(); };
 
+				if (CurrentTab == "Snapshots") {
+					SnapshotsTab();
+					continue;
+				}
+
 				if (CurrentTab == "Watch")
 					WatchTab(true, WatchedMembers, WantsToSave, WantsToLoad, CategoryItems);
 				else if (CurrentTab == "Actors")
@@ -290,6 +452,10 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 						ImGui::TableSetupColumn(ImGui_StoA(*It.DisplayName), Flags, It.InitWidth, i);
 					}
 					ImGui::TableHeadersRow();
+#if PROPERTY_WATCHER_BENCHMARKS
+					if (Benchmark.Active && Benchmark.ScrollY >= 0)
+						ImGui::SetScrollY(Benchmark.ScrollY);
+#endif
 					
 					TArray<FString> CurrentPath;
 					TreeState State = {};
@@ -300,8 +466,13 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 					State.EnableClassCategoriesOnObjectItems = EnableClassCategoriesOnObjectItems;
 					State.ListFunctionsOnObjectItems = ListFunctionsOnObjectItems;
 					State.ShowObjectNamesOnAllProperties = ShowObjectNamesOnAllProperties;
-					State.SearchParser = SearchParser;
+					State.HighlightValueChanges = HighlightValueChanges;
+					State.ValueChangeFadeTime = ValueChangeFadeTime;
+					State.SearchParser = &SearchParser;
 					State.ScrollRegionRange = FFloatInterval(ImGui::GetScrollY(), ImGui::GetScrollY() + TableSize.y);
+					State.IsVirtualized = VirtualizedRows && !SearchFilterActive && CurrentTab != "Watch";
+					State.ScrollTargetID = DeepSearch.TabName == CurrentTab ? DeepSearch.ScrollTargetID : 0;
+					State.HighlightedNodeID = DeepSearch.Results.IsValidIndex(DeepSearch.CurrentResult) ? DeepSearch.Results[DeepSearch.CurrentResult].RowID : 0;
 					
 					defer {
 						if (State.AddressWasHovered) {
@@ -309,6 +480,8 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 							AddressHoveredThisFrame = true;
 							HoveredAddress = State.HoveredAddress;
 						};
+						if (State.ScrolledToTarget)
+							DeepSearch.ScrollTargetID = 0;
 					};
 
 					if (CurrentTab == "Objects")
@@ -342,15 +515,7 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 		ImGui::SameLine();
 		ImGui::Text("-");
 		ImGui::SameLine();
-		{
-			Timers[TimerIndex] = FPlatformTime::Seconds() - StartTime;
-			TimerIndex = (TimerIndex + 1) % TimerCount;
-			double AverageTime = 0;
-			for (int i = 0; i < TimerCount; i++)
-				AverageTime += Timers[i];
-			AverageTime /= TimerCount;
-			ImGui::Text("%.3f ms", AverageTime * 1000.0f);
-		}
+		ImGui::Text("%.3f ms", Profiler.GetAverageMs(Phase_Frame));
 		ImGui::SameLine();
 		ImGui::Text("-");
 		ImGui::SameLine();
@@ -361,6 +526,8 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 		ImGui::SameLine();
 
 		ImGui::Text("HoveredId: %u", ImGui::GetHoveredID());
+
+		Profiler.DrawWindow(&ShowPerformanceInfo);
 	}
 
 	ImRect TargetRect(ImGui::GetWindowContentRegionMin(), ImGui::GetWindowContentRegionMax());
@@ -380,21 +547,62 @@ void Update(FString WindowName, TArray<PropertyItemCategory>& CategoryItems, TAr
 }
 
 void ObjectsTab(bool DrawControls, TArray<PropertyItemCategory>& CategoryItems, TreeState* State) {
+	SCOPE_EVENT("PropertyWatcher::ObjectsTab");
+	PROFILE_PHASE(Phase_ObjectsTab);
+
 	if (DrawControls) {
 		return;
 	}
 	
+	uint64 TabID = MakeNodeID(0, 0, (void*)NodeKey_ObjectsTab, 0);
+
+	bool RefreshIndex = DeepSearchIndex.NeedsRefresh("Objects");
+	if (State->IsVirtualized || DeepSearch.StartRequested || RefreshIndex) {
+		static FlatTree Tree;
+		static TArray<PropertyItem> Roots;
+		TArray<FlatCategory> Categories;
+
+		Roots.Reset();
+		for (auto& Category : CategoryItems) {
+			FlatCategory& Flat = Categories.AddDefaulted_GetRef();
+			Flat.Name = TMem.SToA(Category.Name);
+			Flat.ID = MakeNodeID(TabID, 0, (void*)NodeKey_Category, GetTypeHash(Category.Name));
+			Flat.Start = Roots.Num();
+			for (int i = 0; i < Category.Items.Num(); i++) {
+				PropertyItem& Item = Roots.Add_GetRef(Category.Items[i]);
+				Item.NodeID = MakeNodeID(Flat.ID, Item.Ptr, Item.Prop, i);
+			}
+			Flat.End = Roots.Num();
+		}
+
+		if (DeepSearch.StartRequested)
+			DeepSearch.Start("Objects", Roots, Categories);
+		if (RefreshIndex && !DeepSearchIndex.IsBuilding())
+			DeepSearchIndex.Refresh(Roots, Categories);
+
+		if (State->IsVirtualized) {
+			Tree.Update(*State, Roots, Categories);
+			DrawFlatTree(*State, Tree);
+			return;
+		}
+	}
+
 	TInlineComponentArray<FAView> CurrentPath;
 	for (auto& Category : CategoryItems) {
 		bool MakeCategorySection = !Category.Name.IsEmpty();
+		uint64 CategoryID = MakeNodeID(TabID, 0, (void*)NodeKey_Category, GetTypeHash(Category.Name));
 
 		TreeNodeState NodeState = {};
+		NodeState.Node = NodeCache.FindOrAdd(CategoryID, true);
 		if (MakeCategorySection)
 			BeginSection(TMem.SToA(Category.Name), NodeState, *State, -1, ImGuiTreeNodeFlags_DefaultOpen);
 
 		if (NodeState.IsOpen || !MakeCategorySection)
-			for (auto& Item : Category.Items)
+			for (int i = 0; i < Category.Items.Num(); i++) {
+				PropertyItem& Item = Category.Items[i];
+				Item.NodeID = MakeNodeID(CategoryID, Item.Ptr, Item.Prop, i);
 				DrawItemRow(*State, Item, CurrentPath);
+			}
 
 		if (MakeCategorySection)
 			EndSection(NodeState, *State);
@@ -402,14 +610,23 @@ void ObjectsTab(bool DrawControls, TArray<PropertyItemCategory>& CategoryItems,
 }
 
 void ActorsTab(bool DrawControls, UWorld* World, TreeState* State, ColumnInfos* ColInfos, bool Init) {
-	static TArray<PropertyItem> ActorItems;
+	SCOPE_EVENT("PropertyWatcher::ActorsTab");
+	PROFILE_PHASE(Phase_ActorsTab);
+
+	static ActorTable Actors;
 	static bool UpdateActorsEveryFrame = false;
 	static bool SearchAroundPlayer = false;
 	static float ActorsSearchRadius = 5;
+	static int NearestCount = 0;
 	static bool DrawOverlapSphere = false;
+	static TWeakObjectPtr<UClass> FilterClass;
+	static bool IncludeSubclasses = true;
+	static uint32 GatheredVersion = 0; // Registry version the items were gathered from, 0 if they came from somewhere else.
 
-	if (Init)
-		ActorItems.Empty();
+	if (Init) {
+		Actors.Empty();
+		GatheredVersion = 0;
+	}
 
 	if (DrawControls) {
 		static TArray<bool> CollisionChannelsActive;
@@ -424,10 +641,14 @@ void ActorsTab(bool DrawControls, UWorld* World, TreeState* State, ColumnInfos*
 		if (!World)
 			return;
 
+		WorldActors.Update(World);
+
 		if (World->GetCurrentLevel()) {
 			ImGui::Text("Current World: %s, ", ImGui_StoA(*World->GetName()));
 			ImGui::SameLine();
-			ImGui::Text("Current Level: %s", ImGui_StoA(*World->GetCurrentLevel()->GetName()));
+			ImGui::Text("Current Level: %s, ", ImGui_StoA(*World->GetCurrentLevel()->GetName()));
+			ImGui::SameLine();
+			ImGui::Text("Actors: %d", WorldActors.Num());
 			ImGui::Spacing();
 		}
 
@@ -436,16 +657,69 @@ void ActorsTab(bool DrawControls, UWorld* World, TreeState* State, ColumnInfos*
 		if (ImGui::Button("Update Actors"))
 			UpdateActors = true;
 		ImGui::SameLine();
-		if (ImGui::Button("x", ImVec2(ImGui::GetFrameHeight(), 0)))
-			ActorItems.Empty();
+		if (ImGui::Button("x", ImVec2(ImGui::GetFrameHeight(), 0))) {
+			Actors.Empty();
+			GatheredVersion = 0;
+		}
 		if (UpdateActorsEveryFrame) ImGui::EndDisabled();
 
 		ImGui::SameLine();
 		ImGui::Checkbox("Update actors every frame", &UpdateActorsEveryFrame);
 		ImGui::SameLine();
 		ImGui::Checkbox("Search around player", &SearchAroundPlayer);
+
+		bool FilterChanged = false;
+		ImGui::SetNextItemWidth(ImGui::GetFontSize() * 15);
+		if (ImGui::BeginCombo("Class", FilterClass.IsValid() ? ImGui_StoA(*FilterClass->GetName()) : "All")) {
+			if (ImGui::Selectable("All", !FilterClass.IsValid())) {
+				FilterClass = 0;
+				FilterChanged = true;
+			}
+
+			TArray<UClass*> Classes;
+			WorldActors.Buckets.GetKeys(Classes);
+			Classes.Sort([](UClass& a, UClass& b) { return a.GetName() < b.GetName(); });
+			for (UClass* Class : Classes) {
+				FAView Label = TMem.Printf("%s (%d)", ImGui_StoA(*Class->GetName()), WorldActors.Buckets[Class].Num());
+				if (ImGui::Selectable(Label.GetData(), FilterClass.Get() == Class)) {
+					FilterClass = Class;
+					FilterChanged = true;
+				}
+			}
+			ImGui::EndCombo();
+		}
+		ImGui::SameLine();
+		FilterChanged |= ImGui::Checkbox("Subclasses", &IncludeSubclasses);
 		ImGui::Spacing();
 
+		// Every frame updates only apply what changed in the registry since the last gather.
+		TArrayView<ActorRegistry::ActorChange> Changes;
+		if (UpdateActorsEveryFrame && !SearchAroundPlayer && !FilterChanged && GatheredVersion && WorldActors.GetChanges(GatheredVersion, Changes)) {
+			UpdateActors = false;
+
+			if (Changes.Num()) {
+				// Actors that were in the list when their first change was a remove, and the ones that are there at the end.
+				TSet<AActor*> Removed;
+				TMap<AActor*, bool> LastChange;
+				for (auto& Change : Changes) {
+					if (!LastChange.Contains(Change.Actor) && !Change.Added)
+						Removed.Add(Change.Actor);
+					LastChange.Add(Change.Actor, Change.Added);
+				}
+				Actors.Remove(Removed);
+
+				UClass* Filter = FilterClass.Get();
+				for (auto& It : LastChange) {
+					if (!It.Value || !IsValid(It.Key))
+						continue;
+					UClass* Class = It.Key->GetClass();
+					if (!Filter || Class == Filter || (IncludeSubclasses && Class->IsChildOf(Filter)))
+						Actors.Add(It.Key);
+				}
+			}
+			GatheredVersion = WorldActors.Version;
+		}
+
 		bool DoRaytrace = false;
 		{
 			if (!SearchAroundPlayer) ImGui::BeginDisabled();
@@ -487,11 +761,19 @@ void ActorsTab(bool DrawControls, UWorld* World, TreeState* State, ColumnInfos*
 			ImGui::SetNextItemWidth(150);
 			ImGui::InputFloat("Search radius in meters", &ActorsSearchRadius, 1.0, 1.0, "%.1f");
 			ImGui::SameLine();
+			ImGui::SetNextItemWidth(100);
+			if (ImGui::InputInt("Nearest", &NearestCount))
+				NearestCount = FMath::Max(NearestCount, 0);
+			ImGuiAddon::QuickTooltip("Only shows the n nearest actors, 0 shows everything in the search radius.");
+			ImGui::SameLine();
 			ImGui::Checkbox("Draw Search sphere", &DrawOverlapSphere);
 
 			if (!SearchAroundPlayer) ImGui::EndDisabled();
 		}
 
+		if (SearchAroundPlayer)
+			SpatialIndex.Update(WorldActors);
+
 		{
 			APlayerController* PlayerController = World->GetFirstPlayerController();
 			TArray<TEnumAsByte<EObjectTypeQuery>> traceObjectTypes;
@@ -503,32 +785,27 @@ void ActorsTab(bool DrawControls, UWorld* World, TreeState* State, ColumnInfos*
 
 			FVector SpherePos = PlayerController->GetPawn()->GetActorTransform().GetLocation();
 			if (UpdateActors) {
-				ActorItems.Empty();
+				TArray<PropertyItem> NewItems;
+				GatheredVersion = 0;
 
 				if (SearchAroundPlayer) {
 					TArray<AActor*> ResultActors;
-					{
-						//UClass* seekClass = AStaticMeshActor::StaticClass();					
-						UClass* seekClass = 0;
-						TArray<AActor*> ignoreActors = {};
-
-						UKismetSystemLibrary::SphereOverlapActors(World, SpherePos, ActorsSearchRadius * 100, traceObjectTypes, seekClass, ignoreActors, ResultActors);
-					}
+					if (NearestCount > 0)
+						SpatialIndex.QueryNearest(SpherePos, NearestCount, FilterClass.Get(), IncludeSubclasses, ResultActors);
+					else
+						SpatialIndex.QueryRadius(SpherePos, ActorsSearchRadius * 100, FilterClass.Get(), IncludeSubclasses, ResultActors);
 
 					for (auto It : ResultActors) {
 						if (!It) continue;
-						ActorItems.Push(MakeObjectItem(It));
+						NewItems.Push(MakeObjectItem(It));
 					}
 
 				} else {
-					ULevel* CurrentLevel = World->GetCurrentLevel();
-					if (CurrentLevel) {
-						for (auto& Actor : CurrentLevel->Actors) {
-							if (!Actor) continue;
-							ActorItems.Push(MakeObjectItem(Actor));
-						}
-					}
+					WorldActors.GetActors(FilterClass.Get(), IncludeSubclasses, NewItems);
+					GatheredVersion = WorldActors.Version;
 				}
+
+				Actors.Set(NewItems);
 			}
 
 			if (DrawOverlapSphere)
@@ -539,8 +816,10 @@ void ActorsTab(bool DrawControls, UWorld* World, TreeState* State, ColumnInfos*
 				bool Result = PlayerController->GetHitResultUnderCursorForObjects(traceObjectTypes, true, HitResult);
 				if (Result) {
 					AActor* HitActor = HitResult.GetActor();
-					if (HitActor)
-						ActorItems.Push(MakeObjectItem(HitActor));
+					if (HitActor) {
+						Actors.Add(HitActor);
+						GatheredVersion = 0;
+					}
 				}
 			}
 		}
@@ -548,1256 +827,5835 @@ void ActorsTab(bool DrawControls, UWorld* World, TreeState* State, ColumnInfos*
 		return;
 	}
 
-	// Sorting.
-	{
-		static ImGuiTableSortSpecs* s_current_sort_specs = NULL;
-		auto SortFun = [](const void* lhs, const void* rhs) -> int {
-			PropertyItem* a = (PropertyItem*)lhs;
-			PropertyItem* b = (PropertyItem*)rhs;
-			for (int n = 0; n < s_current_sort_specs->SpecsCount; n++) {
-				const ImGuiTableColumnSortSpecs* sort_spec = &s_current_sort_specs->Specs[n];
-				int delta = 0;
-				switch (sort_spec->ColumnUserID) {
-					//case ColumnID_Name:    delta = (strcmp(ImGui_StoA(*((UObject*)a->Ptr)->GetName()), ImGui_StoA(*((UObject*)b->Ptr)->GetName())));
-					//case ColumnID_Cpptype: delta = strcmp(a->GetCPPType().GetData(), b->GetCPPType().GetData());
-					case ColumnID_Name: {
-						delta = FCString::Strcmp(*((UObject*)a->Ptr)->GetName(), *((UObject*)b->Ptr)->GetName());
-					} break;
-					case ColumnID_Cpptype: {
-						delta = a->GetCPPType().Compare(b->GetCPPType());
-					} break;
-					case ColumnID_Address: {
-						delta = (int64)a->Ptr - (int64)b->Ptr;
-					} break;
-					case ColumnID_Size: {
-						delta = a->GetSize() - b->GetSize();
-					} break;
-					default: IM_ASSERT(0);
-				}
-				if (delta > 0)
-					return (sort_spec->SortDirection == ImGuiSortDirection_Ascending) ? +1 : -1;
-				if (delta < 0)
-					return (sort_spec->SortDirection == ImGuiSortDirection_Ascending) ? -1 : +1;
-			}
-
-			return ((int64)a->Ptr - (int64)b->Ptr);
-		};
-
-		if (ImGuiTableSortSpecs* sorts_specs = ImGui::TableGetSortSpecs()) {
-			if (sorts_specs->SpecsDirty) {
-				s_current_sort_specs = sorts_specs; // Store in variable accessible by the sort function.
-				if (ActorItems.Num() > 1)
-					qsort(ActorItems.GetData(), (size_t)ActorItems.Num(), sizeof(ActorItems[0]), SortFun);
-				s_current_sort_specs = NULL;
-				sorts_specs->SpecsDirty = false;
-			}
+	// Sorting. Items that get added later are inserted at their sorted position.
+	if (ImGuiTableSortSpecs* SortSpecs = ImGui::TableGetSortSpecs()) {
+		if (SortSpecs->SpecsDirty) {
+			Actors.SetSpecs(SortSpecs);
+			Actors.Sort();
+			SortSpecs->SpecsDirty = false;
 		}
 	}
-	
-	TInlineComponentArray<FAView> CurrentPath;
-	for (auto& Item : ActorItems)
-		DrawItemRow(*State, Item, CurrentPath);
-}
-
-void WatchTab(bool DrawControls, TArray<MemberPath>& WatchedMembers, bool* WantsToSave, bool* WantsToLoad, TArray<PropertyItemCategory>& CategoryItems, TreeState* State) {
-	if (DrawControls) {
-		if (ImGui::Button("Clear All"))
-			WatchedMembers.Empty();
-		ImGui::SameLine();
-		if (ImGui::Button("Save"))
-			*WantsToSave = true;
-		ImGui::SameLine();
-		if (ImGui::Button("Load"))
-			*WantsToLoad = true;
 
+	TArray<PropertyItem>& ActorItems = Actors.Items;
+	uint64 TabID = MakeNodeID(0, 0, (void*)NodeKey_ActorsTab, 0);
+	for (auto& Item : ActorItems)
+		Item.NodeID = MakeNodeID(TabID, Item.Ptr, 0, 0);
+
+	TArray<FlatCategory> NoCategories;
+	if (DeepSearch.StartRequested)
+		DeepSearch.Start("Actors", ActorItems, NoCategories);
+	if (DeepSearchIndex.NeedsRefresh("Actors"))
+		DeepSearchIndex.Refresh(ActorItems, NoCategories);
+
+	if (State->IsVirtualized) {
+		static FlatTree Tree;
+		Tree.Update(*State, ActorItems, NoCategories);
+		DrawFlatTree(*State, Tree);
 		return;
 	}
 
-	TArray<PropertyItem> Items;
-	for (auto& It : CategoryItems)
-		Items.Append(It.Items);
-
 	TInlineComponentArray<FAView> CurrentPath;
-	int MemberIndexToDelete = -1;
-	bool MoveHappened = false;
-	int MoveIndexFrom = -1;
-	int MoveIndexTo = -1;
-	FString NewPathName;
+	for (auto& Item : ActorItems)
+		DrawItemRow(*State, Item, CurrentPath);
+}
 
-	int i = 0;
-	for (auto& Member : WatchedMembers) {
-		State->CurrentWatchItemIndex = i++;
-		State->WatchItemGotDeleted = false;
-		State->RenameHappened = false;
-		State->PathStringPtr = &Member.PathString;
+void ActorRegistry::Update(UWorld* _World) {
+	if (World.Get() == _World && (_World || !Slots.Num()))
+		return;
 
-		bool Found = Member.UpdateItemFromPath(Items);
-		if (!Found) {
-			Member.CachedItem.Ptr = 0;
-			Member.CachedItem.Prop = 0;
-		}
+	Unbind();
+	if (_World)
+		Bind(_World);
+}
 
-		DrawItemRow(*State, Member.CachedItem, CurrentPath);
+void ActorRegistry::Bind(UWorld* _World) {
+	SCOPE_EVENT("PropertyWatcher::ActorRegistry::Bind");
+
+	World = _World;
+	SpawnedHandle = _World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateLambda([this](AActor* Actor) { AddActor(Actor); }));
+	DestroyedHandle = _World->AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateLambda([this](AActor* Actor) { RemoveActor(Actor); }));
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddLambda([this](ULevel* Level, UWorld* InWorld) {
+		if (InWorld == World.Get())
+			AddLevel(Level);
+	});
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddLambda([this](ULevel* Level, UWorld* InWorld) {
+		if (InWorld != World.Get())
+			return;
+		if (Level)
+			RemoveLevel(Level);
+		else
+			Unbind(); // Whole world is going away.
+	});
 
-		if (State->WatchItemGotDeleted)
-			MemberIndexToDelete = State->CurrentWatchItemIndex;
+	for (ULevel* Level : _World->GetLevels())
+		AddLevel(Level);
+	Version++;
+	ResetChangeLog();
+}
 
-		if (State->MoveHappened) {
-			MoveHappened = true;
-			MoveIndexFrom = State->MoveFrom;
-			MoveIndexTo = State->MoveTo;
-		}
+void ActorRegistry::Unbind() {
+	if (UWorld* OldWorld = World.Get()) {
+		OldWorld->RemoveOnActorSpawnedHandler(SpawnedHandle);
+		OldWorld->RemoveOnActorDestroyedHandler(DestroyedHandle);
 	}
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
 
-	if (MemberIndexToDelete != -1)
-		WatchedMembers.RemoveAt(MemberIndexToDelete);
-
-	if (MoveHappened)
-		WatchedMembers.Swap(MoveIndexFrom, MoveIndexTo);
+	World = 0;
+	Buckets.Empty();
+	Slots.Empty();
+	Version++;
+	ResetChangeLog();
 }
 
-//
+void ActorRegistry::AddActor(AActor* Actor) {
+	if (!Actor || Slots.Contains(Actor))
+		return;
 
-void TreeState::EnableForceToggleNode(bool Mode, int StackIndexLimit) {
-	ForceToggleNodeOpenClose = true;
-	ForceToggleNodeMode = Mode;
-	ForceToggleNodeStackIndexLimit = StackIndexLimit;
+	UClass* Class = Actor->GetClass();
+	TArray<AActor*>& Bucket = Buckets.FindOrAdd(Class);
+	Slots.Add(Actor, { Class, Bucket.Add(Actor) });
+	LogChange(Actor, true);
+}
 
-	VisitedPropertiesStack.Empty();
+void ActorRegistry::RemoveActor(AActor* Actor) {
+	ActorSlot Slot;
+	if (!Slots.RemoveAndCopyValue(Actor, Slot))
+		return;
+
+	TArray<AActor*>& Bucket = Buckets[Slot.Class];
+	Bucket.RemoveAtSwap(Slot.Index);
+	if (Slot.Index < Bucket.Num())
+		Slots[Bucket[Slot.Index]].Index = Slot.Index;
+	else if (!Bucket.Num())
+		Buckets.Remove(Slot.Class);
+	LogChange(Actor, false);
 }
 
-bool TreeState::ItemIsInfiniteLooping(VisitedPropertyInfo& PropertyInfo) {
-	if (!PropertyInfo.Address)
-		return false;
+void ActorRegistry::AddLevel(ULevel* Level) {
+	if (!Level)
+		return;
+	Slots.Reserve(Slots.Num() + Level->Actors.Num());
+	for (AActor* Actor : Level->Actors)
+		AddActor(Actor);
+}
 
-	int Count = 0;
-	for (auto& It : VisitedPropertiesStack) {
-		if (It.Compare(PropertyInfo)) {
-			Count++;
-			if (Count == 3) // @Todo: Think about what's appropriate.
-				return true;
-		}
-	}
-	return false;
+void ActorRegistry::RemoveLevel(ULevel* Level) {
+	for (AActor* Actor : Level->Actors)
+		RemoveActor(Actor);
 }
 
-//
+void ActorRegistry::GetActors(UClass* FilterClass, bool IncludeSubclasses, TArray<PropertyItem>& Out) {
+	SCOPE_EVENT("PropertyWatcher::ActorRegistry::GetActors");
 
-void DrawItemRow(TreeState& State, PropertyItem& Item, TInlineComponentArray<FAView>& CurrentMemberPath, int StackIndex) {
-	SCOPE_EVENT("PropertyWatcher::DrawItemRow");
+	auto AddBucket = [&Out](TArray<AActor*>& Bucket) {
+		Out.Reserve(Out.Num() + Bucket.Num());
+		for (AActor* Actor : Bucket)
+			if (IsValid(Actor))
+				Out.Push(MakeObjectItem(Actor));
+	};
 
-	if (State.ItemDrawCount > 100000) // @Todo: Random safety measure against infinite recursion, could be better?
+	if (FilterClass && !IncludeSubclasses) {
+		if (TArray<AActor*>* Bucket = Buckets.Find(FilterClass))
+			AddBucket(*Bucket);
 		return;
+	}
 
-	bool ItemCanBeOpened = Item.CanBeOpened();
-	bool ItemIsVisible = State.IsCurrentItemVisible();
-	bool SearchIsActive = (bool)State.SearchParser.Commands.Num();
+	for (auto& It : Buckets)
+		if (!FilterClass || It.Key->IsChildOf(FilterClass))
+			AddBucket(It.Value);
+}
 
-	CachedColumnText ColumnTexts;
-	FAView ItemDisplayName;
-	bool ItemIsSearched = false;
-	
-	if (!ItemIsVisible && !State.SearchFilterActive) {
-		ItemDisplayName = "";
+bool ActorRegistry::GetChanges(uint32 SinceVersion, TArrayView<ActorChange>& Changes) {
+	if (SinceVersion < ChangeLogVersion || SinceVersion > Version)
+		return false;
+	Changes = MakeArrayView(ChangeLog).Slice(SinceVersion - ChangeLogVersion, Version - SinceVersion);
+	return true;
+}
 
-	} else {
-		ItemDisplayName = GetColumnCellText(Item, ColumnID_Name, &State, &CurrentMemberPath, &StackIndex);
+void ActorRegistry::LogChange(AActor* Actor, bool Added) {
+	if (ChangeLog.Num() >= MaxChangeLog)
+		ResetChangeLog();
+	ChangeLog.Push({ Actor, Added });
+	Version++;
+}
 
-		if (SearchIsActive) {
-			ColumnTexts.Add(ColumnID_Name, ItemDisplayName); // Default.
+void ActorRegistry::ResetChangeLog() {
+	ChangeLog.Reset();
+	ChangeLogVersion = Version;
+}
 
-			// Cache the cell texts that we need for the text search.
-			for (auto& Command : State.SearchParser.Commands)
-				if (Command.Type == SimpleSearchParser::Command_Test && !ColumnTexts.Get(Command.Tst.ColumnID)) {
-					FAView view = GetColumnCellText(Item, Command.Tst.ColumnID, &State, &CurrentMemberPath, &StackIndex);
-					if (view.IsEmpty()) {
-						int stop = 234;
-					}
-					ColumnTexts.Add(Command.Tst.ColumnID, view);
-				}
+void NameRanks::Build(TArray<FName>& Names) {
+	Ranks.Reset();
+	Sorted.Reset();
+	SortedRanks.Reset();
+
+	for (FName Name : Names) {
+		if (Ranks.Contains(Name.GetComparisonIndex()))
+			continue;
+		Ranks.Add(Name.GetComparisonIndex(), 0);
+		Name.SetNumber(NAME_NO_NUMBER_INTERNAL);
+		Sorted.Push(Name);
+	}
 
-			ItemIsSearched = State.SearchParser.ApplyTests(ColumnTexts);
-		}
+	Sorted.Sort([](const FName& A, const FName& B) { return A.Compare(B) < 0; });
+	for (int i = 0; i < Sorted.Num(); i++) {
+		uint32 Rank = (i + 1) * Spacing;
+		SortedRanks.Push(Rank);
+		Ranks[Sorted[i].GetComparisonIndex()] = Rank;
 	}
+}
 
-	auto FindOrGetColumnText = [&Item, &ColumnTexts](int ColumnID) -> FAView {
-		if (FAView* Result = ColumnTexts.Get(ColumnID))
-			return *Result;
-		else
-			return GetColumnCellText(Item, ColumnID);
-	};
+bool NameRanks::GetKey(FName Name, uint64& Key) {
+	uint32* Rank = Ranks.Find(Name.GetComparisonIndex());
+	if (!Rank) {
+		FName Base = Name;
+		Base.SetNumber(NAME_NO_NUMBER_INTERNAL);
+		int Pos = Algo::LowerBound(Sorted, Base, [](const FName& A, const FName& B) { return A.Compare(B) < 0; });
+
+		uint32 Low = Pos > 0 ? SortedRanks[Pos - 1] : 0;
+		uint32 High = Pos < SortedRanks.Num() ? SortedRanks[Pos] : Low + 2 * Spacing;
+		if (High - Low < 2)
+			return false;
+
+		Sorted.Insert(Base, Pos);
+		SortedRanks.Insert(Low + (High - Low) / 2, Pos);
+		Rank = &Ranks.Add(Name.GetComparisonIndex(), SortedRanks[Pos]);
+	}
 
-	// Item is skipped.
-	if (State.SearchFilterActive && !ItemIsSearched && !ItemCanBeOpened)
-		return;
+	Key = ((uint64)*Rank << 32) | (uint32)Name.GetNumber();
+	return true;
+}
 
-	// Misc setup.
-	
-	State.ItemDrawCount++;
-	FAView ItemAuthoredName = ItemCanBeOpened ? Item.GetAuthoredName() : "";
-	if (ItemCanBeOpened)
-		CurrentMemberPath.Push(ItemAuthoredName);
+void ActorTable::Set(TArray<PropertyItem>& NewItems) {
+	SCOPE_EVENT("PropertyWatcher::ActorTable::Set");
 
-	TreeNodeState NodeState;
-	{
-		NodeState = {};
-		NodeState.HasBranches = ItemCanBeOpened;
-		NodeState.ItemInfo.Set(Item);
+	Items = MoveTemp(NewItems);
 
-		if (ItemIsVisible && ItemIsSearched) {
-			NodeState.PushTextColor = true;
-			NodeState.TextColor = ImVec4(1, 0.5f, 0, 1);
-		}
+	TArray<FName> AllNames;
+	AllNames.Reserve(Items.Num() * 2);
+	for (PropertyItem& Item : Items) {
+		AllNames.Push(((UObject*)Item.Ptr)->GetFName());
+		AllNames.Push(((UObject*)Item.Ptr)->GetClass()->GetFName());
 	}
+	Names.Build(AllNames);
 
-	bool IsTopWatchItem = State.CurrentWatchItemIndex != -1 && StackIndex == 0;
-	if (IsTopWatchItem)
-		ImGui::PushID(State.CurrentWatchItemIndex);
+	RebuildKeys();
+	Sort();
+}
 
-	// @Column(name): Property name
-	{
-		if (ItemIsVisible && !Item.IsValid())
-			ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled));
+void ActorTable::RebuildKeys() {
+	Keys.SetNum(Items.Num());
+	for (int i = 0; i < Items.Num(); i++)
+		MakeKey(Items[i], Keys[i]);
+}
 
-		BeginTreeNode(*ItemAuthoredName, *ItemDisplayName, NodeState, State, StackIndex, 0);
+void ActorTable::Add(AActor* Actor) {
+	PropertyItem Item = MakeObjectItem(Actor);
+	ActorSortKey Key;
+	if (!MakeKey(Item, Key)) {
+		// Out of rank space, start over with this one included.
+		Items.Push(Item);
+		TArray<PropertyItem> AllItems = MoveTemp(Items);
+		Set(AllItems);
+		return;
+	}
 
-		bool NodeIsMarkedAsInlined = false;
+	int Index = Specs.Num() ? Algo::UpperBound(Keys, Key, [this](const ActorSortKey& A, const ActorSortKey& B) { return Less(A, B); }) : Keys.Num();
+	Keys.Insert(Key, Index);
+	Items.Insert(Item, Index);
+}
 
-		// Right click popup for inlining.
-		if(NodeState.HasBranches) {
-			// Do tree push to get right bool from storage when node is open or closed.
-			if (!NodeState.IsOpen) 
-				ImGui::TreePush(*ItemAuthoredName);
+void ActorTable::Remove(TSet<AActor*>& Actors) {
+	if (!Actors.Num())
+		return;
 
-			ImGuiID StorageIDIsInlined = ImGui::GetID("IsInlined");
-			ImGuiID StorageIDInlinedStackDepth = ImGui::GetID("InlinedStackDepth");
+	int Count = 0;
+	for (int i = 0; i < Items.Num(); i++) {
+		if (Actors.Contains((AActor*)Items[i].Ptr))
+			continue;
+		Items[Count] = Items[i];
+		Keys[Count] = Keys[i];
+		Count++;
+	}
+	Items.SetNum(Count);
+	Keys.SetNum(Count);
+}
 
-			auto Storage = ImGui::GetStateStorage();
-			NodeIsMarkedAsInlined = Storage->GetBool(StorageIDIsInlined);
-			int InlinedStackDepth = Storage->GetInt(StorageIDInlinedStackDepth, 1);
+void ActorTable::Empty() {
+	Items.Empty();
+	Keys.Empty();
+}
 
-			if (NodeIsMarkedAsInlined && !State.ForceInlineChildItems && InlinedStackDepth)
-				TreeNodeSetInline(NodeState, State, CurrentMemberPath.Num(), StackIndex, InlinedStackDepth);
+void ActorTable::SetSpecs(ImGuiTableSortSpecs* SortSpecs) {
+	Specs.Reset();
+	for (int i = 0; i < SortSpecs->SpecsCount; i++)
+		Specs.Push({ (int)SortSpecs->Specs[i].ColumnUserID, SortSpecs->Specs[i].SortDirection == ImGuiSortDirection_Descending });
+}
 
-			if (ImGui::IsItemClicked(ImGuiMouseButton_Right))
-				ImGui::OpenPopup("ItemPopup");
+void ActorTable::Sort() {
+	if (!Specs.Num() || Items.Num() < 2)
+		return;
 
-			if (ImGui::BeginPopup("ItemPopup")) {
-				if (ImGui::Checkbox("Inlined", &NodeIsMarkedAsInlined))
-					Storage->SetBool(StorageIDIsInlined, NodeIsMarkedAsInlined);
+	SCOPE_EVENT("PropertyWatcher::ActorTable::Sort");
+
+	// Distances change all the time, so they are only taken when sorting.
+	if (Specs.ContainsByPredicate([](ActorSortSpec& Spec) { return Spec.ColumnID == ColumnID_Distance; }))
+		for (int i = 0; i < Items.Num(); i++)
+			Keys[i].DistanceSq = GetActorDistanceSq((AActor*)Items[i].Ptr);
+
+	TArray<int> Order;
+	Order.SetNum(Items.Num());
+	for (int i = 0; i < Order.Num(); i++)
+		Order[i] = i;
+	Algo::StableSort(Order, [this](int A, int B) { return Less(Keys[A], Keys[B]); });
+
+	TArray<PropertyItem> SortedItems;
+	TArray<ActorSortKey> SortedKeys;
+	SortedItems.Reserve(Order.Num());
+	SortedKeys.Reserve(Order.Num());
+	for (int i : Order) {
+		SortedItems.Push(Items[i]);
+		SortedKeys.Push(Keys[i]);
+	}
+	Items = MoveTemp(SortedItems);
+	Keys = MoveTemp(SortedKeys);
+}
 
-				ImGui::SameLine();
-				ImGui::BeginDisabled(!NodeIsMarkedAsInlined);
-				if (ImGui::SliderInt("Stack Depth", &InlinedStackDepth, 0, 9))
-					Storage->SetInt(StorageIDInlinedStackDepth, InlinedStackDepth);
-				ImGui::EndDisabled();
+bool ActorTable::MakeKey(PropertyItem& Item, ActorSortKey& Key) {
+	UObject* Obj = (UObject*)Item.Ptr;
+	Key.Address = (uint64)Obj;
+	Key.Size = Obj->GetClass()->GetPropertiesSize();
+	Key.DistanceSq = GetActorDistanceSq((AActor*)Obj);
+	return Names.GetKey(Obj->GetFName(), Key.NameKey) && Names.GetKey(Obj->GetClass()->GetFName(), Key.ClassKey);
+}
 
-				ImGui::EndPopup();
-			}
+bool ActorTable::Less(const ActorSortKey& A, const ActorSortKey& B) const {
+	for (const ActorSortSpec& Spec : Specs) {
+		int Delta = 0;
+		switch (Spec.ColumnID) {
+			case ColumnID_Name:    Delta = A.NameKey < B.NameKey ? -1 : A.NameKey > B.NameKey; break;
+			case ColumnID_Cpptype: Delta = A.ClassKey < B.ClassKey ? -1 : A.ClassKey > B.ClassKey; break;
+			case ColumnID_Address: Delta = A.Address < B.Address ? -1 : A.Address > B.Address; break;
+			case ColumnID_Size:    Delta = A.Size - B.Size; break;
+			case ColumnID_Distance: Delta = A.DistanceSq < B.DistanceSq ? -1 : A.DistanceSq > B.DistanceSq; break;
+		}
+		if (Delta)
+			return Spec.Descending ? Delta > 0 : Delta < 0;
+	}
+	return A.Address < B.Address;
+}
 
-			if (!NodeState.IsOpen) 
-				ImGui::TreePop();
+void ActorGrid::Update(ActorRegistry& Registry) {
+	TArrayView<ActorRegistry::ActorChange> Changes;
+	if (!RegistryVersion || !Registry.GetChanges(RegistryVersion, Changes))
+		Rebuild(Registry);
+	else {
+		// Only the last change of an actor counts, earlier ones can be about an actor that got collected since,
+		// with its address reused. Adds only go through for actors the registry still has.
+		TMap<AActor*, bool> LastChange;
+		for (auto& Change : Changes)
+			LastChange.Add(Change.Actor, Change.Added);
+
+		for (auto& It : LastChange) {
+			Remove(It.Key);
+			if (It.Value && Registry.Slots.Contains(It.Key))
+				Add(It.Key);
 		}
+	}
+	RegistryVersion = Registry.Version;
+
+	int Count = FMath::Min(RefreshBudget, Entries.Num());
+	for (int i = 0; i < Count; i++) {
+		if (RefreshCursor >= Entries.Num())
+			RefreshCursor = 0;
+		Move(RefreshCursor, Entries[RefreshCursor].Actor->GetActorLocation());
+		RefreshCursor++;
+	}
+}
 
-		if (ItemIsVisible)
-		{
-			// Drag to watch window.
-			if (StackIndex > 0 && Item.Type != PointerType::Function) {
-				if (ImGui::BeginDragDropSource()) {
-					TMemBuilder(Builder);
-					for (int i = 0; i < CurrentMemberPath.Num(); i++) {
-						if (i > 0) Builder.AppendChar('.');
-						Builder.Append(CurrentMemberPath[i]);
-					}
-					if (!NodeState.HasBranches)
-						Builder << '.' << ItemDisplayName;
+void ActorGrid::Rebuild(ActorRegistry& Registry) {
+	SCOPE_EVENT("PropertyWatcher::ActorGrid::Rebuild");
 
-					ImGui::SetDragDropPayload("PropertyWatcherMember", *Builder, Builder.Len());
-					ImGui::Text("Add to watch list:");
-					ImGui::Text(*Builder);
-					ImGui::EndDragDropSource();
-				}
-			}
+	Entries.Reset();
+	EntryIndexes.Reset();
+	Cells.Reset();
+	RefreshCursor = 0;
 
-			// Drag to move watch item. Only available when top level watch list item.
-			if (IsTopWatchItem) {
-				if (ImGui::BeginDragDropSource()) {
-					ImGui::SetDragDropPayload("PropertyWatcherMoveIndex", &State.CurrentWatchItemIndex, sizeof(int));
-					ImGui::Text("Move Item: %d", State.CurrentWatchItemIndex);
-					ImGui::EndDragDropSource();
-				}
+	Entries.Reserve(Registry.Num());
+	for (auto& It : Registry.Slots)
+		Add(It.Key);
+}
 
-				if (ImGui::BeginDragDropTarget()) {
-					if (const ImGuiPayload* Payload = ImGui::AcceptDragDropPayload("PropertyWatcherMoveIndex")) {
-						if (Payload->Data) {
-							State.MoveHappened = true;
-							State.MoveFrom = *(int*)Payload->Data;
-							State.MoveTo = State.CurrentWatchItemIndex;
-						}
-					}
-					ImGui::EndDragDropTarget();
-				}
+void ActorGrid::Add(AActor* Actor) {
+	// Actors without a root component don't have a location.
+	if (!IsValid(Actor) || !Actor->GetRootComponent() || EntryIndexes.Contains(Actor))
+		return;
 
-				// Handle watch list item path editing.
-				if (State.PathStringPtr) {
-					ImGui::SameLine();
-					ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0, 0, 0, 0));
-					ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - ImGui::GetFrameHeight());
+	FVector Location = Actor->GetActorLocation();
+	uint64 Cell = GetCellKey(GetCellCoord(Location));
+	int Index = Entries.Add({ Actor, Location, Cell });
+	EntryIndexes.Add(Actor, Index);
+	Cells.FindOrAdd(Cell).Push(Index);
+}
 
-					FString StringID = FString::Printf(TEXT("##InputPathText %d"), State.CurrentWatchItemIndex);
+void ActorGrid::Remove(AActor* Actor) {
+	int Index;
+	if (!EntryIndexes.RemoveAndCopyValue(Actor, Index))
+		return;
 
-					static TArray<char> StringBuffer;
-					StringBuffer.Empty();
-					StringBuffer.Append(ImGui_StoA(**State.PathStringPtr), State.PathStringPtr->Len() + 1);
-					if (ImGuiAddon::InputText(ImGui_StoA(*StringID), StringBuffer, ImGuiInputTextFlags_EnterReturnsTrue))
-						(*State.PathStringPtr) = FString(StringBuffer);
+	RemoveFromCell(Entries[Index].Cell, Index);
 
-					ImGui::PopStyleColor(1);
-				}
-			}
+	// Last entry moves into the hole.
+	int Last = Entries.Num() - 1;
+	if (Index != Last) {
+		Entry& Moved = Entries[Last];
+		TArray<int>& Cell = Cells[Moved.Cell];
+		Cell[Cell.Find(Last)] = Index;
+		EntryIndexes[Moved.Actor] = Index;
+	}
+	Entries.RemoveAtSwap(Index);
+}
 
-			if (NodeIsMarkedAsInlined) {
-				ImGui::SameLine();
-				ImGui::Text("*");
-			}
+void ActorGrid::Move(int Index, const FVector& Location) {
+	Entry& E = Entries[Index];
+	E.Location = Location;
 
-			// This puts the (<ObjectName>) at the end of properties that are also objects.
-			if (State.ShowObjectNamesOnAllProperties) {
-				if (Item.Type == PointerType::Property && CastField<FObjectProperty>(Item.Prop) && Item.Ptr) {
-					ImGui::SameLine();
-					ImGui::BeginDisabled();
-					FName Name = ((UObject*)Item.Ptr)->GetFName();
-					ImGui::Text(*TMem.Printf("(%s)", *TMem.NToA(Name)));
-					ImGui::EndDisabled();
-				}
+	uint64 Cell = GetCellKey(GetCellCoord(Location));
+	if (Cell == E.Cell)
+		return;
+
+	RemoveFromCell(E.Cell, Index);
+	Cells.FindOrAdd(Cell).Push(Index);
+	E.Cell = Cell;
+}
+
+void ActorGrid::RemoveFromCell(uint64 Cell, int Index) {
+	TArray<int>* Indexes = Cells.Find(Cell);
+	if (!Indexes)
+		return;
+	Indexes->RemoveSingleSwap(Index);
+	if (!Indexes->Num())
+		Cells.Remove(Cell);
+}
+
+FIntVector ActorGrid::GetCellCoord(const FVector& Location) {
+	return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+}
+
+uint64 ActorGrid::GetCellKey(const FIntVector& Coord) {
+	const uint64 Mask = (1 << 21) - 1;
+	return (((uint64)Coord.X & Mask) << 42) | (((uint64)Coord.Y & Mask) << 21) | ((uint64)Coord.Z & Mask);
+}
+
+// Returns false when the radius covers more cells than there are, in that case every entry got tested.
+bool ActorGrid::QueryIndexes(const FVector& Center, float Radius, UClass* FilterClass, bool IncludeSubclasses, TArray<int>& Out) {
+	float RadiusSq = Radius * Radius;
+	auto TestCell = [&](TArray<int>& Indexes) {
+		for (int Index : Indexes) {
+			Entry& E = Entries[Index];
+			if (FVector::DistSquared(E.Location, Center) > RadiusSq)
+				continue;
+			if (FilterClass) {
+				UClass* Class = E.Actor->GetClass();
+				if (Class != FilterClass && !(IncludeSubclasses && Class->IsChildOf(FilterClass)))
+					continue;
 			}
+			Out.Push(Index);
 		}
+	};
 
-		if (ItemIsVisible && !Item.IsValid())
-			ImGui::PopStyleColor(1);
+	double CellSpan = (double)Radius * 2 / CellSize + 2;
+	if (CellSpan * CellSpan * CellSpan > Cells.Num()) {
+		for (auto& It : Cells)
+			TestCell(It.Value);
+		return false;
 	}
 
-	// Draw other columns if visible. 
-	if (!ItemIsVisible || NodeState.ItemIsInlined) {
-		ImGui::TableSetColumnIndex(ImGui::TableGetColumnCount() - 1);
+	FIntVector Min = GetCellCoord(Center - FVector(Radius));
+	FIntVector Max = GetCellCoord(Center + FVector(Radius));
+	for (int x = Min.X; x <= Max.X; x++)
+		for (int y = Min.Y; y <= Max.Y; y++)
+			for (int z = Min.Z; z <= Max.Z; z++)
+				if (TArray<int>* Indexes = Cells.Find(GetCellKey(FIntVector(x, y, z))))
+					TestCell(*Indexes);
+	return true;
+}
 
-	} else {
-		// @Column(value): Property Value
-		if (ImGui::TableNextColumn()) {
-			ImGui::SetNextItemWidth(-FLT_MIN);
-			if (Item.IsValid())
-				DrawPropertyValue(Item);
+void ActorGrid::QueryRadius(const FVector& Center, float Radius, UClass* FilterClass, bool IncludeSubclasses, TArray<AActor*>& Out) {
+	SCOPE_EVENT("PropertyWatcher::ActorGrid::QueryRadius");
+
+	TArray<int> Indexes;
+	QueryIndexes(Center, Radius, FilterClass, IncludeSubclasses, Indexes);
+	for (int Index : Indexes)
+		Out.Push(Entries[Index].Actor);
+}
+
+void ActorGrid::QueryNearest(const FVector& Center, int Count, UClass* FilterClass, bool IncludeSubclasses, TArray<AActor*>& Out) {
+	SCOPE_EVENT("PropertyWatcher::ActorGrid::QueryNearest");
+
+	// Grow the radius until there are enough, everything inside of it is closer than anything outside.
+	TArray<int> Indexes;
+	for (float Radius = CellSize; ; Radius *= 2) {
+		Indexes.Reset();
+		if (!QueryIndexes(Center, Radius, FilterClass, IncludeSubclasses, Indexes)) {
+			Indexes.Reset();
+			QueryIndexes(Center, FLT_MAX, FilterClass, IncludeSubclasses, Indexes);
+			break;
 		}
+		if (Indexes.Num() >= Count)
+			break;
+	}
 
-		// @Column(metadata): Metadata							
-		if (ImGui::TableNextColumn() && Item.Prop) {
-			if (ItemHasMetaData(Item)) {
-				ImGui::TextDisabled("(?)");
-				if (ImGui::IsItemHovered(ImGuiHoveredFlags_DelayShort)) {
-					ImGui::BeginTooltip();
-					ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
-					
-					if (MetaData_Available)
-						ImGui::TextUnformatted(*FindOrGetColumnText(ColumnID_Metadata));
-					else
-						ImGui::TextUnformatted("Data not available in shipping builds.");
+	Indexes.Sort([this, &Center](int A, int B) { return FVector::DistSquared(Entries[A].Location, Center) < FVector::DistSquared(Entries[B].Location, Center); });
+	for (int i = 0; i < FMath::Min(Count, Indexes.Num()); i++)
+		Out.Push(Entries[Indexes[i]].Actor);
+}
 
-					ImGui::PopTextWrapPos();
-					ImGui::EndTooltip();
+bool GetPlayerLocation(UWorld* World, FVector& Location) {
+	APlayerController* PlayerController = World->GetFirstPlayerController();
+	APawn* Pawn = PlayerController ? PlayerController->GetPawn() : 0;
+	if (!Pawn)
+		return false;
+	Location = Pawn->GetActorLocation();
+	return true;
+}
+
+float GetActorDistanceSq(AActor* Actor) {
+	if (!SpatialIndex.HasOrigin || !Actor->GetRootComponent())
+		return FLT_MAX;
+	return FVector::DistSquared(Actor->GetActorLocation(), SpatialIndex.Origin);
+}
+
+void WatchTab(bool DrawControls, TArray<MemberPath>& WatchedMembers, bool* WantsToSave, bool* WantsToLoad, TArray<PropertyItemCategory>& CategoryItems, TreeState* State) {
+	SCOPE_EVENT("PropertyWatcher::WatchTab");
+	PROFILE_PHASE(Phase_WatchTab);
+
+	if (DrawControls) {
+		if (ImGui::Button("Clear All"))
+			WatchedMembers.Empty();
+		ImGui::SameLine();
+		if (ImGui::Button("Save"))
+			*WantsToSave = true;
+		ImGui::SameLine();
+		if (ImGui::Button("Load"))
+			*WantsToLoad = true;
+
+		ImGui::SameLine();
+		ImGui::Checkbox("Sampler", &Sampler.Enabled);
+		ImGuiAddon::QuickTooltip("Reads the sampled watches every tick, also while the window is closed, and plots them.\nOnly numbers, bools and enums stored directly in an object can be sampled.");
+		if (Sampler.Enabled) {
+			static const ETickingGroup Groups[] = { TG_PrePhysics, TG_DuringPhysics, TG_PostPhysics, TG_PostUpdateWork };
+			static const char* GroupNames[] = { "Pre physics", "During physics", "Post physics", "Post update work" };
+			int GroupIndex = 0;
+			for (int i = 0; i < IM_ARRAYSIZE(Groups); i++)
+				if (Groups[i] == Sampler.TickGroup)
+					GroupIndex = i;
+
+			ImGui::SameLine();
+			ImGui::SetNextItemWidth(130);
+			if (ImGui::Combo("##TickGroup", &GroupIndex, GroupNames, IM_ARRAYSIZE(GroupNames)))
+				Sampler.TickGroup = Groups[GroupIndex];
+			ImGuiAddon::QuickTooltip("Tick group the values get read in.");
+
+			ImGui::SameLine();
+			ImGui::SetNextItemWidth(80);
+			ImGui::DragFloat("Plot (s)", &Sampler.PlotSeconds, 0.1f, 1.0f, 30.0f, "%.1f");
+			ImGui::SameLine();
+			ImGui::TextDisabled("%d sampled, %.2f us/tick", Sampler.Watches.Num(), Sampler.LastTickUs);
+
+			// The watch list gets saved with the capture, the file only knows the paths.
+			static FString CaptureStatus;
+			ImGui::SameLine();
+			if (ImGui::Button(Capture.IsCapturing ? "Stop capture" : "Capture")) {
+				if (Capture.IsCapturing) {
+					Capture.Stop();
+					CaptureStatus = Capture.FilePath;
+				} else if (Capture.Start(CaptureStatus)) {
+					*WantsToSave = true;
+					CaptureStatus.Empty();
 				}
-				ImGui::IsItemHovered();
 			}
-		}
+			ImGuiAddon::QuickTooltip("Records the sampled watches every tick into a file in Saved/PropertyWatcher, until stopped.");
 
-		// @Column(type): Property Type
-		if (ImGui::TableNextColumn()) {
-			if (Item.IsValid()) {
-				{
-					ImVec4 cText = ImVec4(0, 0, 0, 0);
-					GetItemColor(Item, cText);
-					ImGui::PushStyleColor(ImGuiCol_Text, cText); 
-					ImGui::Bullet();
-					ImGui::PopStyleColor();
+			if (Capture.IsCapturing) {
+				ImGui::SameLine();
+				ImGui::TextDisabled("%lld rows, %.1f KB%s", Capture.RowsWritten, Capture.BytesWritten / 1024.0f,
+					Capture.DroppedBlocks ? *TMem.Printf(", %d blocks dropped", Capture.DroppedBlocks) : "");
+
+			} else if (!Capture.FilePath.IsEmpty()) {
+				ImGui::SameLine();
+				if (ImGui::Button("Export CSV")) {
+					FString CsvPath = FPaths::ChangeExtension(Capture.FilePath, TEXT("csv"));
+					CaptureStatus = ExportCaptureToCsv(Capture.FilePath, CsvPath, CaptureStatus) ? CsvPath : CaptureStatus;
 				}
+			}
+
+			if (!CaptureStatus.IsEmpty()) {
 				ImGui::SameLine();
-				ImGui::Text(*FindOrGetColumnText(ColumnID_Type));
+				ImGui::TextDisabled(ImGui_StoA(*CaptureStatus));
 			}
 		}
 
-		// @Column(cpptype): CPP Type
-		if (ImGui::TableNextColumn())
-			ImGui::Text(*FindOrGetColumnText(ColumnID_Cpptype));
+		return;
+	}
 
-		// @Column(class): Owner Class
-		if (ImGui::TableNextColumn())
-			ImGui::Text(*FindOrGetColumnText(ColumnID_Class));
+	WatchPaths.NewFrame(CategoryItems);
 
-		// @Column(category): Metadata Category
-		if (ImGui::TableNextColumn())
-			ImGui::Text(*FindOrGetColumnText(ColumnID_Category));
+	uint64 TabID = MakeNodeID(0, 0, (void*)NodeKey_WatchTab, 0);
 
-		// @Column(address): Adress
-		if (ImGui::TableNextColumn()) {
-			if (State.DrawHoveredAddress && Item.Ptr == State.HoveredAddress)
-				ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), *FindOrGetColumnText(ColumnID_Address));
-			else
-				ImGui::Text(*FindOrGetColumnText(ColumnID_Address));
+	double Time = ImGui::GetTime();
 
-			if (ImGui::IsItemHovered()) {
-				State.AddressWasHovered = true;
-				State.HoveredAddress = Item.Ptr;
-			}
+	TInlineComponentArray<FAView> CurrentPath;
+	int MemberIndexToDelete = -1;
+	bool MoveHappened = false;
+	int MoveIndexFrom = -1;
+	int MoveIndexTo = -1;
+	FString NewPathName;
+
+	int i = 0;
+	for (auto& Member : WatchedMembers) {
+		State->CurrentWatchItemIndex = i++;
+		State->WatchItemGotDeleted = false;
+		State->RenameHappened = false;
+		State->PathStringPtr = &Member.PathString;
+
+		WatchPaths.Resolve(Member);
+		Member.CachedItem.NodeID = MakeNodeID(TabID, 0, 0, GetTypeHash(Member.PathString));
+
+		State->ValueChangeHighlight = 0;
+		if (State->HighlightValueChanges) {
+			UpdateValueChange(Member, Time);
+			if (Member.LastChangeTime >= 0)
+				State->ValueChangeHighlight = FMath::Max(0.0f, 1.0f - (float)(Time - Member.LastChangeTime) / State->ValueChangeFadeTime);
 		}
 
-		// @Column(size): Size
-		if (ImGui::TableNextColumn())
-			ImGui::Text(*FindOrGetColumnText(ColumnID_Size));
+		DrawItemRow(*State, Member.CachedItem, CurrentPath);
+		if (Sampler.Enabled) {
+			ImGui::PushID(State->CurrentWatchItemIndex);
+			DrawSampleRow(Member);
+			ImGui::PopID();
+		}
 
-		// Close Button
-		if (ImGui::TableNextColumn())
-			if (IsTopWatchItem)
-				if (ImGui::Button("x", ImVec2(ImGui::GetFrameHeight(), 0)))
-					State.WatchItemGotDeleted = true;
+		if (State->WatchItemGotDeleted)
+			MemberIndexToDelete = State->CurrentWatchItemIndex;
+
+		if (State->MoveHappened) {
+			MoveHappened = true;
+			MoveIndexFrom = State->MoveFrom;
+			MoveIndexTo = State->MoveTo;
+		}
+	}
+
+	// Searches below the watches that resolved this frame, with the same node IDs as the rows above.
+	if (DeepSearch.StartRequested) {
+		TArray<PropertyItem> Roots;
+		for (auto& Member : WatchedMembers)
+			if (Member.CachedItem.Ptr)
+				Roots.Add(Member.CachedItem);
+
+		TArray<FlatCategory> NoCategories;
+		DeepSearch.Start("Watch", Roots, NoCategories);
+	}
+
+	if (MemberIndexToDelete != -1)
+		WatchedMembers.RemoveAt(MemberIndexToDelete);
+
+	if (MoveHappened)
+		WatchedMembers.Swap(MoveIndexFrom, MoveIndexTo);
+
+	if (Sampler.Enabled)
+		Sampler.RemoveUnseen(WatchPaths.Frame);
+}
+
+// Extra row under numeric watches while the sampler is on, with the toggle and the plot.
+void DrawSampleRow(MemberPath& Member) {
+	SampledWatch* Watch = Sampler.Find(Member.PathString);
+	if (Watch) {
+		Watch->SeenFrame = WatchPaths.Frame;
+		Sampler.BindWatch(*Watch, Member);
+	}
+
+	// Sampled watches keep their row when the path stops resolving, so they can be turned off.
+	FNumericProperty* Numeric;
+	FBoolProperty* Bool;
+	PropertyItem& Item = Member.CachedItem;
+	if (!Watch && (Item.Type != PointerType::Property || !Item.Prop || !GetSampleProperties(Item.Prop, Numeric, Bool)))
+		return;
+
+	ImGui::TableNextRow();
+	ImGui::TableNextColumn();
+	ImGui::Indent();
+	defer{ ImGui::Unindent(); };
+
+	bool Sampled = Watch != 0;
+	bool Toggled = ImGui::Checkbox("Sample", &Sampled);
+	ImGuiAddon::QuickTooltip("Paths are resolved again while the watch tab is drawn. Without it, sampling only continues on an object\n"
+		"that replaced the old owner under the same name, e.g. after a level reload. Other changes along the path are missed.", ImGuiHoveredFlags_DelayNormal);
+	if (Toggled) {
+		Sampler.SetSampled(Member.PathString, Sampled);
+		return;
+	}
+	if (!Watch)
+		return;
+
+	ImGui::SameLine();
+	if (ImGui::SmallButton(Watch->PlotOpen ? "Hide plot" : "Plot"))
+		Watch->PlotOpen = !Watch->PlotOpen;
+
+	if (Watch->Offset < 0) {
+		ImGui::SameLine();
+		ImGui::TextDisabled("(not sampled)");
+		ImGuiAddon::QuickTooltip("The value has to be stored directly in an object, not in a container or behind a pointer of a struct.", ImGuiHoveredFlags_DelayShort);
+	}
+
+	if (ImGui::TableNextColumn())
+		DrawSamplePlot(Watch->Ring, Watch->PlotOpen ? 150 : ImGui::GetFrameHeight(), Watch->PlotOpen);
+}
+
+void DrawSamplePlot(SampleRing& Ring, float Height, bool Detailed) {
+	ImVec2 Pos = ImGui::GetCursorScreenPos();
+	ImVec2 Size = ImVec2(FMath::Max(ImGui::GetContentRegionAvail().x, 10.0f), Height);
+	ImGui::Dummy(Size);
+	if (!ImGui::IsItemVisible())
+		return;
+
+	TMem.PushMarker(); defer{ TMem.PopMarker(); };
+
+	double Now = FPlatformTime::Seconds();
+	double MinTime = Now - Sampler.PlotSeconds;
+	TempArray<SampleRing::Sample> Samples;
+	Ring.CopySince(MinTime, Samples);
+
+	ImDrawList* DrawList = ImGui::GetWindowDrawList();
+	if (Detailed)
+		DrawList->AddRectFilled(Pos, ImVec2(Pos.x + Size.x, Pos.y + Size.y), ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+	if (!Samples.Num()) {
+		DrawList->AddText(ImVec2(Pos.x + 2, Pos.y), ImGui::GetColorU32(ImGuiCol_TextDisabled), "No samples");
+		return;
+	}
+
+	double Min = Samples[0].Value, Max = Samples[0].Value;
+	for (auto& It : Samples) {
+		Min = FMath::Min(Min, It.Value);
+		Max = FMath::Max(Max, It.Value);
+	}
+	double Range = Max > Min ? Max - Min : 1.0;
+	double Bottom = Max > Min ? Min : Min - 0.5; // Flat lines go in the middle.
+
+	auto ToX = [&](double Time) { return Pos.x + (float)((Time - MinTime) / Sampler.PlotSeconds) * Size.x; };
+	auto ToY = [&](double Value) { return Pos.y + Size.y - 1 - (float)((Value - Bottom) / Range) * (Size.y - 2); };
+
+	// One column per pixel with its min and max, so spikes don't get lost when there are more samples than pixels.
+	TempArray<ImVec2> Points;
+	Points.Reserve(FMath::Min(Samples.Num(), (int)Size.x * 2 + 2));
+	int Column = INT_MIN;
+	float ColumnMin = 0, ColumnMax = 0;
+	auto FlushColumn = [&]() {
+		if (Column == INT_MIN)
+			return;
+		Points.Add(ImVec2((float)Column, ColumnMin));
+		if (ColumnMax != ColumnMin)
+			Points.Add(ImVec2((float)Column, ColumnMax));
+	};
+	for (auto& It : Samples) {
+		int X = (int)ToX(It.Time);
+		float Y = ToY(It.Value);
+		if (X != Column) {
+			FlushColumn();
+			Column = X;
+			ColumnMin = ColumnMax = Y;
+		} else {
+			ColumnMin = FMath::Min(ColumnMin, Y);
+			ColumnMax = FMath::Max(ColumnMax, Y);
+		}
+	}
+	FlushColumn();
+
+	ImU32 LineColor = ImGui::GetColorU32(ImGuiCol_PlotLines);
+	if (Points.Num() == 1)
+		DrawList->AddCircleFilled(Points[0], 1.5f, LineColor);
+	else
+		DrawList->AddPolyline(Points.GetData(), Points.Num(), LineColor, ImDrawFlags_None, 1.0f);
+
+	if (Detailed) {
+		ImU32 TextColor = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+		DrawList->AddText(ImVec2(Pos.x + 2, Pos.y), TextColor, *TMem.Printf("%g", Max));
+		DrawList->AddText(ImVec2(Pos.x + 2, Pos.y + Size.y - ImGui::GetTextLineHeight()), TextColor, *TMem.Printf("%g", Min));
+	}
+
+	if (ImGui::IsItemHovered()) {
+		SampleRing::Sample* Hovered = &Samples.Last();
+		if (Detailed) {
+			float MouseX = ImGui::GetIO().MousePos.x;
+			for (auto& It : Samples)
+				if (FMath::Abs(ToX(It.Time) - MouseX) < FMath::Abs(ToX(Hovered->Time) - MouseX))
+					Hovered = &It;
+			DrawList->AddLine(ImVec2(ToX(Hovered->Time), Pos.y), ImVec2(ToX(Hovered->Time), Pos.y + Size.y), ImGui::GetColorU32(ImGuiCol_TextDisabled));
+		}
+		ImGui::SetTooltip("%g (%.2f s ago)\nMin %g, max %g, %d samples", Hovered->Value, Now - Hovered->Time, Min, Max, Samples.Num());
+	}
+}
+
+void SnapshotsTab() {
+	SCOPE_EVENT("PropertyWatcher::SnapshotsTab");
+	PROFILE_PHASE(Phase_SnapshotsTab);
+
+	SnapshotState& S = Snapshots;
+
+	if (!S.Snapshots.Num()) {
+		ImGui::TextDisabled("Right click on an object item and press \"Take snapshot\".");
+		return;
+	}
+
+	ImGuiTableFlags TableFlags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders;
+	if (ImGui::BeginTable("SnapshotTable", 6, TableFlags)) {
+		ImGui::TableSetupColumn("A");
+		ImGui::TableSetupColumn("B");
+		ImGui::TableSetupColumn("Snapshot", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Objects");
+		ImGui::TableSetupColumn("Size");
+		ImGui::TableSetupColumn("Capture");
+		ImGui::TableHeadersRow();
+
+		int SnapshotToDelete = -1;
+		for (int i = 0; i < S.Snapshots.Num(); i++) {
+			MemorySnapshot& Snapshot = *S.Snapshots[i];
+			ImGui::PushID(i); defer{ ImGui::PopID(); };
+
+			ImGui::TableNextColumn();
+			ImGui::RadioButton("##A", &S.SelectedA, i);
+			ImGui::TableNextColumn();
+			ImGui::RadioButton("##B", &S.SelectedB, i);
+			ImGui::TableNextColumn();
+			if (ImGui::SmallButton("X"))
+				SnapshotToDelete = i;
+			ImGui::SameLine();
+			ImGui::Text(ImGui_StoA(*Snapshot.Name));
+			ImGui::TableNextColumn();
+			ImGui::Text("%d", Snapshot.Objects.Num());
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f KB", Snapshot.GetDataSize() / 1024.0f);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f ms", Snapshot.CaptureMs);
+		}
+		ImGui::EndTable();
+
+		if (SnapshotToDelete != -1) {
+			S.Snapshots.RemoveAt(SnapshotToDelete);
+			for (int* Selected : { &S.SelectedA, &S.SelectedB }) {
+				if (*Selected == SnapshotToDelete)
+					*Selected = -1;
+				else if (*Selected > SnapshotToDelete)
+					(*Selected)--;
+			}
+		}
+	}
+
+	ImGui::RadioButton("Compare A against live memory", &S.SelectedB, -1);
+	ImGui::SameLine();
+	ImGui::BeginDisabled(!S.Snapshots.IsValidIndex(S.SelectedA));
+	if (ImGui::Button("Diff"))
+		S.Diff();
+	ImGui::EndDisabled();
+	if (!S.DiffInfo.IsEmpty()) {
+		ImGui::SameLine();
+		ImGui::TextDisabled(ImGui_StoA(*S.DiffInfo));
+	}
+
+	ImGuiTableFlags ChangeTableFlags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY;
+	if (ImGui::BeginTable("SnapshotChanges", 3, ChangeTableFlags, ImVec2(0, ImGui::GetContentRegionAvail().y))) {
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Member", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("A", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("B", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableHeadersRow();
+
+		ImGuiListClipper Clipper;
+		Clipper.Begin(S.Changes.Num());
+		while (Clipper.Step())
+			for (int i = Clipper.DisplayStart; i < Clipper.DisplayEnd; i++) {
+				SnapshotChange& Change = S.Changes[i];
+				ImGui::TableNextColumn();
+				ImGui::Text(ImGui_StoA(*Change.Path));
+				ImGui::TableNextColumn();
+				ImGui::Text(ImGui_StoA(*Change.OldValue));
+				ImGui::TableNextColumn();
+				ImGui::Text(ImGui_StoA(*Change.NewValue));
+			}
+		ImGui::EndTable();
+	}
+}
+
+//
+
+void TreeState::EnableForceToggleNode(bool Mode, int StackIndexLimit) {
+	ForceToggleNodeOpenClose = true;
+	ForceToggleNodeMode = Mode;
+	ForceToggleNodeStackIndexLimit = StackIndexLimit;
+
+	VisitedPropertiesStack.Empty();
+}
+
+bool TreeState::ItemIsInfiniteLooping(VisitedPropertyInfo& PropertyInfo) {
+	return IsInfiniteLooping(VisitedPropertiesStack, PropertyInfo);
+}
+
+FORCEINLINE bool ItemPointsToObject(PropertyItem& Item) {
+	return Item.Type == PointerType::Object || TagHasFlag(Item.GetTag(), TagFlag_Object);
+}
+
+uint64 HashItemValue(PropertyItem& Item) {
+	if (!Item.Ptr)
+		return 0;
+
+	// Object items point at the object instead of the property slot, the value is which object it is.
+	if (ItemPointsToObject(Item))
+		return FXxHash64::HashBuffer(&Item.Ptr, sizeof(Item.Ptr)).Hash;
+
+	// Containers hash their count and elements, not the allocation, so a reallocation with the same contents isn't a change.
+	// XXH3 has SSE2/NEON paths, so even big arrays are cheap enough to hash every frame.
+	PropertyTag Tag = Item.GetTag();
+	if (Tag == Tag_Array) {
+		FArrayProperty* ArrayProp = (FArrayProperty*)Item.Prop;
+		FScriptArrayHelper Helper(ArrayProp, Item.Ptr);
+		uint64 Hash = Helper.Num();
+		if (Helper.Num())
+			Hash = CityHash128to64({ Hash, FXxHash64::HashBuffer(Helper.GetRawPtr(0), (uint64)Helper.Num() * ArrayProp->Inner->GetSize()).Hash });
+		return Hash;
+
+	} else if (Tag == Tag_Str) {
+		FString& String = *(FString*)Item.Ptr;
+		uint64 Hash = String.Len();
+		if (String.Len())
+			Hash = CityHash128to64({ Hash, FXxHash64::HashBuffer(*String, String.Len() * sizeof(TCHAR)).Hash });
+		return Hash;
+
+	} else if (Tag == Tag_Map) {
+		FScriptMapHelper Helper((FMapProperty*)Item.Prop, Item.Ptr);
+		int KeySize = Helper.GetKeyProperty()->GetSize();
+		int ValueSize = Helper.GetValueProperty()->GetSize();
+		uint64 Hash = Helper.Num();
+		for (int i = 0; i < Helper.GetMaxIndex(); i++)
+			if (Helper.IsValidIndex(i)) {
+				Hash = CityHash128to64({ Hash, FXxHash64::HashBuffer(Helper.GetKeyPtr(i), KeySize).Hash });
+				Hash = CityHash128to64({ Hash, FXxHash64::HashBuffer(Helper.GetValuePtr(i), ValueSize).Hash });
+			}
+		return Hash;
+
+	} else if (Tag == Tag_Set) {
+		FScriptSetHelper Helper((FSetProperty*)Item.Prop, Item.Ptr);
+		int ElementSize = Helper.GetElementProperty()->GetSize();
+		uint64 Hash = Helper.Num();
+		for (int i = 0; i < Helper.GetMaxIndex(); i++)
+			if (Helper.IsValidIndex(i))
+				Hash = CityHash128to64({ Hash, FXxHash64::HashBuffer(Helper.GetElementPtr(i), ElementSize).Hash });
+		return Hash;
+	}
+
+	int Size = Item.GetSize();
+	if (Size <= 0)
+		return 0;
+	return FXxHash64::HashBuffer(Item.Ptr, Size).Hash;
+}
+
+void UpdateValueChange(MemberPath& Member, double Time) {
+	uint64 Hash = HashItemValue(Member.CachedItem);
+
+	// Path pointing to different memory doesn't count as a change. For object items the pointer is the value.
+	void* Address = ItemPointsToObject(Member.CachedItem) ? 0 : Member.CachedItem.Ptr;
+	if (Address != Member.HashedPtr) {
+		Member.HashedPtr = Address;
+		Member.ValueHash = Hash;
+		Member.LastChangeTime = -1;
+
+	} else if (Hash != Member.ValueHash) {
+		Member.ValueHash = Hash;
+		Member.LastChangeTime = Time;
+	}
+}
+
+bool IsInfiniteLooping(TArray<VisitedPropertyInfo>& VisitedStack, VisitedPropertyInfo& PropertyInfo) {
+	if (!PropertyInfo.Address)
+		return false;
+
+	int Count = 0;
+	for (auto& It : VisitedStack) {
+		if (It.Compare(PropertyInfo)) {
+			Count++;
+			if (Count == 3) // @Todo: Think about what's appropriate.
+				return true;
+		}
+	}
+	return false;
+}
+
+//
+
+void DrawItemRow(TreeState& State, PropertyItem& Item, TInlineComponentArray<FAView>& CurrentMemberPath, int StackIndex) {
+	SCOPE_EVENT("PropertyWatcher::DrawItemRow");
+
+	if (State.ItemDrawCount > 100000) // @Todo: Random safety measure against infinite recursion, could be better?
+		return;
+
+	bool ItemCanBeOpened = Item.CanBeOpened();
+	bool ItemIsVisible = State.IsCurrentItemVisible();
+	bool SearchIsActive = State.SearchParser && State.SearchParser->Commands.Num();
+
+	Counters.RowsVisited++;
+	if (ItemIsVisible)
+		Counters.RowsDrawn++;
+
+	CachedColumnText ColumnTexts;
+	FAView ItemDisplayName;
+	bool ItemIsSearched = false;
+	
+	if (!ItemIsVisible && !State.SearchFilterActive) {
+		ItemDisplayName = "";
+
+	} else {
+		ItemDisplayName = GetColumnCellText(Item, ColumnID_Name, &State, &CurrentMemberPath, &StackIndex);
+
+		if (SearchIsActive) {
+			ColumnTexts.Add(ColumnID_Name, ItemDisplayName); // Default.
+
+			// Layout members share their name view, if it wasn't replaced by a path the text is exactly the property name.
+			if (Item.Prop && Item.NameOverwrite.IsEmpty() && !Item.CachedName.IsEmpty() && ItemDisplayName.GetData() == Item.CachedName.GetData())
+				ColumnTexts.Name = Item.Prop->GetFName();
+
+			// Cache the cell texts that we need for the text search.
+			for (auto& Command : State.SearchParser->Commands)
+				if (Command.Type == SimpleSearchParser::Command_Test && !ColumnTexts.Get(Command.Tst.ColumnID)) {
+					FAView view = GetColumnCellText(Item, Command.Tst.ColumnID, &State, &CurrentMemberPath, &StackIndex);
+					if (view.IsEmpty()) {
+						int stop = 234;
+					}
+					ColumnTexts.Add(Command.Tst.ColumnID, view);
+				}
+
+			ItemIsSearched = State.SearchParser->ApplyTests(ColumnTexts);
+		}
+	}
+
+	auto FindOrGetColumnText = [&Item, &ColumnTexts](int ColumnID) -> FAView {
+		if (FAView* Result = ColumnTexts.Get(ColumnID))
+			return *Result;
+		else
+			return GetColumnCellText(Item, ColumnID);
+	};
+
+	// Item is skipped.
+	if (State.SearchFilterActive && !ItemIsSearched && !ItemCanBeOpened)
+		return;
+
+	// Misc setup.
+	
+	State.ItemDrawCount++;
+	FAView ItemAuthoredName = ItemCanBeOpened ? Item.GetAuthoredName() : "";
+	if (ItemCanBeOpened)
+		CurrentMemberPath.Push(ItemAuthoredName);
+
+	TreeNodeState NodeState;
+	{
+		NodeState = {};
+		NodeState.HasBranches = ItemCanBeOpened;
+		NodeState.ItemInfo.Set(Item);
+		NodeState.OverrideNoTreePush = State.IsVirtualized; // Indentation comes from the flattened row.
+
+		if (ItemCanBeOpened) {
+			if (!Item.NodeID)
+				Item.NodeID = MakeNodeID(0, Item.Ptr, Item.Prop, 0);
+			NodeState.Node = NodeCache.FindOrAdd(Item.NodeID);
+		}
+
+		if (ItemIsVisible && ItemIsSearched) {
+			NodeState.PushTextColor = true;
+			NodeState.TextColor = ImVec4(1, 0.5f, 0, 1);
+		}
+
+		if (ItemIsVisible && State.HighlightedNodeID && Item.NodeID == State.HighlightedNodeID) {
+			NodeState.PushTextColor = true;
+			NodeState.TextColor = ImVec4(1, 0.9f, 0, 1);
+		}
+	}
+
+	bool IsTopWatchItem = State.CurrentWatchItemIndex != -1 && StackIndex == 0;
+	if (IsTopWatchItem)
+		ImGui::PushID(State.CurrentWatchItemIndex);
+
+	// @Column(name): Property name
+	{
+		if (ItemIsVisible && !Item.IsValid())
+			ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled));
+
+		BeginTreeNode(*ItemAuthoredName, *ItemDisplayName, NodeState, State, StackIndex, 0);
+
+		if (IsTopWatchItem && ItemIsVisible && State.ValueChangeHighlight > 0)
+			ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, ImGui::GetColorU32(ImVec4(1, 0.8f, 0, 0.35f * State.ValueChangeHighlight)));
+
+		if (State.ScrollTargetID && Item.NodeID == State.ScrollTargetID) {
+			ImGui::SetScrollHereY(0.5f);
+			State.ScrolledToTarget = true;
+		}
+
+		bool NodeIsMarkedAsInlined = false;
+
+		// Right click popup for inlining.
+		if(NodeState.HasBranches) {
+			TreeNode* Node = NodeState.Node;
+			NodeIsMarkedAsInlined = Node->IsInlined;
+
+			// Flattened trees do the inlining when the rows get built.
+			if (NodeIsMarkedAsInlined && !State.ForceInlineChildItems && Node->InlinedStackDepth && !State.IsVirtualized)
+				TreeNodeSetInline(NodeState, State, CurrentMemberPath.Num(), StackIndex, Node->InlinedStackDepth);
+
+			if (State.IsVirtualized && NodeState.ActivatedForceToggleNodeOpenClose)
+				ForceToggleNodesRecursive(State, Item, StackIndex);
+
+			// Popup id has to be in the node scope when the node is closed as well.
+			bool PushPopupScope = !NodeState.IsOpen || NodeState.OverrideNoTreePush;
+			if (PushPopupScope)
+				ImGui::TreePush(*ItemAuthoredName);
+
+			if (ImGui::IsItemClicked(ImGuiMouseButton_Right))
+				ImGui::OpenPopup("ItemPopup");
+
+			if (ImGui::BeginPopup("ItemPopup")) {
+				if (ImGui::Checkbox("Inlined", &Node->IsInlined))
+					NodeCache.MarkChanged(Node->ID);
+
+				ImGui::SameLine();
+				ImGui::BeginDisabled(!Node->IsInlined);
+				if (ImGui::SliderInt("Stack Depth", &Node->InlinedStackDepth, 0, 9))
+					NodeCache.MarkChanged(Node->ID);
+				ImGui::EndDisabled();
+
+				if (UObject* Obj = GetItemObject(Item)) {
+					if (ImGui::Button("Take snapshot")) {
+						Snapshots.Capture(Obj);
+						ImGui::CloseCurrentPopup();
+					}
+					ImGuiAddon::QuickTooltip("Copies the memory of the object and its subobjects, see the snapshots tab.");
+				}
+
+				ImGui::Separator();
+				DrawJsonPopupControls(Item);
+
+				ImGui::EndPopup();
+			}
+
+			if (PushPopupScope)
+				ImGui::TreePop();
+		}
+
+		if (ItemIsVisible)
+		{
+			// Drag to watch window.
+			if (StackIndex > 0 && Item.Type != PointerType::Function) {
+				if (ImGui::BeginDragDropSource()) {
+					TMemBuilder(Builder);
+					for (int i = 0; i < CurrentMemberPath.Num(); i++) {
+						if (i > 0) Builder.AppendChar('.');
+						Builder.Append(CurrentMemberPath[i]);
+					}
+					if (!NodeState.HasBranches)
+						Builder << '.' << ItemDisplayName;
+
+					ImGui::SetDragDropPayload("PropertyWatcherMember", *Builder, Builder.Len());
+					ImGui::Text("Add to watch list:");
+					ImGui::Text(*Builder);
+					ImGui::EndDragDropSource();
+				}
+			}
+
+			// Drag to move watch item. Only available when top level watch list item.
+			if (IsTopWatchItem) {
+				if (ImGui::BeginDragDropSource()) {
+					ImGui::SetDragDropPayload("PropertyWatcherMoveIndex", &State.CurrentWatchItemIndex, sizeof(int));
+					ImGui::Text("Move Item: %d", State.CurrentWatchItemIndex);
+					ImGui::EndDragDropSource();
+				}
+
+				if (ImGui::BeginDragDropTarget()) {
+					if (const ImGuiPayload* Payload = ImGui::AcceptDragDropPayload("PropertyWatcherMoveIndex")) {
+						if (Payload->Data) {
+							State.MoveHappened = true;
+							State.MoveFrom = *(int*)Payload->Data;
+							State.MoveTo = State.CurrentWatchItemIndex;
+						}
+					}
+					ImGui::EndDragDropTarget();
+				}
+
+				// Handle watch list item path editing.
+				if (State.PathStringPtr) {
+					ImGui::SameLine();
+					ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0, 0, 0, 0));
+					ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - ImGui::GetFrameHeight());
+
+					FString StringID = FString::Printf(TEXT("##InputPathText %d"), State.CurrentWatchItemIndex);
+
+					static TArray<char> StringBuffer;
+					StringBuffer.Empty();
+					StringBuffer.Append(ImGui_StoA(**State.PathStringPtr), State.PathStringPtr->Len() + 1);
+					if (ImGuiAddon::InputText(ImGui_StoA(*StringID), StringBuffer, ImGuiInputTextFlags_EnterReturnsTrue))
+						(*State.PathStringPtr) = FString(StringBuffer);
+
+					ImGui::PopStyleColor(1);
+				}
+			}
+
+			if (NodeIsMarkedAsInlined) {
+				ImGui::SameLine();
+				ImGui::Text("*");
+			}
+
+			// This puts the (<ObjectName>) at the end of properties that are also objects.
+			if (State.ShowObjectNamesOnAllProperties) {
+				if (Item.Type == PointerType::Property && TagHasFlag(Item.GetTag(), TagFlag_Object) && Item.Ptr) {
+					ImGui::SameLine();
+					ImGui::BeginDisabled();
+					FName Name = ((UObject*)Item.Ptr)->GetFName();
+					ImGui::Text(*TMem.Printf("(%s)", *NameTable.Get(Name)));
+					ImGui::EndDisabled();
+				}
+			}
+		}
+
+		if (ItemIsVisible && !Item.IsValid())
+			ImGui::PopStyleColor(1);
+	}
+
+	// Draw other columns if visible. 
+	if (!ItemIsVisible || NodeState.ItemIsInlined) {
+		ImGui::TableSetColumnIndex(ImGui::TableGetColumnCount() - 1);
+
+	} else {
+		// @Column(value): Property Value
+		if (ImGui::TableNextColumn()) {
+			ImGui::SetNextItemWidth(-FLT_MIN);
+			if (Item.IsValid())
+				DrawPropertyValue(Item);
+		}
+
+		// @Column(metadata): Metadata							
+		if (ImGui::TableNextColumn() && Item.Prop) {
+			if (ItemHasMetaData(Item)) {
+				ImGui::TextDisabled("(?)");
+				if (ImGui::IsItemHovered(ImGuiHoveredFlags_DelayShort)) {
+					ImGui::BeginTooltip();
+					ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
+					
+					if (MetaData_Available)
+						ImGui::TextUnformatted(*FindOrGetColumnText(ColumnID_Metadata));
+					else
+						ImGui::TextUnformatted("Data not available in shipping builds.");
+
+					ImGui::PopTextWrapPos();
+					ImGui::EndTooltip();
+				}
+				ImGui::IsItemHovered();
+			}
+		}
+
+		// @Column(type): Property Type
+		if (ImGui::TableNextColumn()) {
+			if (Item.IsValid()) {
+				{
+					ImVec4 cText = ImVec4(0, 0, 0, 0);
+					GetItemColor(Item, cText);
+					ImGui::PushStyleColor(ImGuiCol_Text, cText); 
+					ImGui::Bullet();
+					ImGui::PopStyleColor();
+				}
+				ImGui::SameLine();
+				ImGui::Text(*FindOrGetColumnText(ColumnID_Type));
+			}
+		}
+
+		// @Column(cpptype): CPP Type
+		if (ImGui::TableNextColumn())
+			ImGui::Text(*FindOrGetColumnText(ColumnID_Cpptype));
+
+		// @Column(class): Owner Class
+		if (ImGui::TableNextColumn())
+			ImGui::Text(*FindOrGetColumnText(ColumnID_Class));
+
+		// @Column(category): Metadata Category
+		if (ImGui::TableNextColumn())
+			ImGui::Text(*FindOrGetColumnText(ColumnID_Category));
+
+		// @Column(address): Adress
+		if (ImGui::TableNextColumn()) {
+			if (State.DrawHoveredAddress && Item.Ptr == State.HoveredAddress)
+				ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), *FindOrGetColumnText(ColumnID_Address));
+			else
+				ImGui::Text(*FindOrGetColumnText(ColumnID_Address));
+
+			if (ImGui::IsItemHovered()) {
+				State.AddressWasHovered = true;
+				State.HoveredAddress = Item.Ptr;
+			}
+		}
+
+		// @Column(size): Size
+		if (ImGui::TableNextColumn())
+			ImGui::Text(*FindOrGetColumnText(ColumnID_Size));
+
+		// @Column(distance): Distance to the player
+		if (ImGui::TableNextColumn())
+			ImGui::Text(*FindOrGetColumnText(ColumnID_Distance));
+
+		// Close Button
+		if (ImGui::TableNextColumn())
+			if (IsTopWatchItem)
+				if (ImGui::Button("x", ImVec2(ImGui::GetFrameHeight(), 0)))
+					State.WatchItemGotDeleted = true;
+	}
+
+	// Draw leaf properties.
+	if (NodeState.IsOpen && !State.IsVirtualized) {
+		bool PushAddressesStack = State.ForceToggleNodeOpenClose || State.ForceInlineChildItems;
+		if (PushAddressesStack)
+			State.VisitedPropertiesStack.Push(NodeState.ItemInfo);
+		TMem.PushMarker();
+
+		DrawItemChildren(State, Item, CurrentMemberPath, StackIndex);
+		
+		TMem.PopMarker();
+		if (PushAddressesStack)
+			State.VisitedPropertiesStack.Pop(false);
+	}
+
+	if (ItemCanBeOpened)
+		CurrentMemberPath.Pop(false);
+
+	EndTreeNode(NodeState, State);
+
+	if (IsTopWatchItem)
+		ImGui::PopID();
+}
+
+void DrawItemChildren(TreeState& State, PropertyItem& Item, TInlineComponentArray<FAView>& CurrentMemberPath, int StackIndex) {
+	check(Item.Ptr); // Do we need this check here? Can't remember.
+
+	if (TagHasFlag(Item.GetTag(), TagFlag_ObjectPointer)) {
+		int StackOffset = 0;
+		PropertyItem ObjectItem = GetContainerItem(Item, StackOffset);
+		if (StackOffset)
+			return DrawItemChildren(State, ObjectItem, CurrentMemberPath, StackIndex + StackOffset);
+	}
+
+	bool ItemIsObjectProp = TagHasFlag(Item.GetTag(), TagFlag_Object);
+	bool ItemIsObject = ItemIsObjectProp || Item.Type == PointerType::Object;
+
+	TreeNode* Node = NodeCache.FindOrAdd(Item.NodeID);
+
+	// Members.
+	{
+		TArray<PropertyItem>& Members = NodeCache.GetChildren(*Node, Item);
+
+		SectionHelper SectionHelper;
+		if (State.EnableClassCategoriesOnObjectItems && ItemIsObject) {
+			if (UClass* Class = ((UObject*)Item.Ptr)->GetClass())
+				SectionHelper.InitFromLayout(*GetStructLayout(Class));
+		}
+
+		if (!SectionHelper.Enabled) {
+			for (auto& It : Members)
+				DrawItemRow(State, It, CurrentMemberPath, StackIndex + 1);
+
+		} else {
+			for (int SectionIndex = 0; SectionIndex < SectionHelper.GetSectionCount(); SectionIndex++) {
+				int MemberStartIndex, MemberEndIndex;
+				auto CurrentSectionName = SectionHelper.GetSectionInfo(SectionIndex, MemberStartIndex, MemberEndIndex);
+
+				TreeNodeState NodeState = {};
+				NodeState.OverrideNoTreePush = true;
+				NodeState.Node = NodeCache.FindOrAdd(MakeNodeID(Item.NodeID, 0, (void*)NodeKey_Section, SectionIndex), SectionIndex == 0);
+				BeginSection(CurrentSectionName, NodeState, State, StackIndex, SectionIndex == 0 ? ImGuiTreeNodeFlags_DefaultOpen : 0);
+
+				if (NodeState.IsOpen)
+					for (int MemberIndex = MemberStartIndex; MemberIndex < MemberEndIndex; MemberIndex++)
+						DrawItemRow(State, Members[MemberIndex], CurrentMemberPath, StackIndex + 1);
+
+				EndSection(NodeState, State);
+			}
+		}
+	}
+
+	// Functions.
+	if (State.ListFunctionsOnObjectItems && Item.Ptr && ItemIsObject) {
+		StructLayout* FunctionLayout = GetFunctionLayout((UObject*)Item.Ptr);
+
+		if (FunctionLayout && FunctionLayout->Functions.Num()) {
+			TArray<UFunction*>& Functions = FunctionLayout->Functions;
+			uint64 FunctionSectionID = MakeNodeID(Item.NodeID, 0, (void*)NodeKey_Functions, 0);
+
+			TreeNodeState FunctionSection = {};
+			FunctionSection.Node = NodeCache.FindOrAdd(FunctionSectionID);
+			BeginSection("Functions", FunctionSection, State, StackIndex, 0);
+
+			if (FunctionSection.IsOpen) {
+				SectionHelper SectionHelper;
+				if (State.EnableClassCategoriesOnObjectItems)
+					SectionHelper.InitFromFunctions(*FunctionLayout);
+
+				if (!SectionHelper.Enabled) {
+					for (auto It : Functions)
+						DrawItemRow(State, MakeFunctionItem(Item.Ptr, It), CurrentMemberPath, StackIndex + 1);
+
+				} else {
+					for (int SectionIndex = 0; SectionIndex < SectionHelper.GetSectionCount(); SectionIndex++) {
+						int MemberStartIndex, MemberEndIndex;
+						auto CurrentSectionName = SectionHelper.GetSectionInfo(SectionIndex, MemberStartIndex, MemberEndIndex);
+
+						TreeNodeState NodeState = {};
+						NodeState.OverrideNoTreePush = true;
+						NodeState.Node = NodeCache.FindOrAdd(MakeNodeID(FunctionSectionID, 0, (void*)NodeKey_Section, SectionIndex), SectionIndex == 0);
+						BeginSection(CurrentSectionName, NodeState, State, StackIndex, SectionIndex == 0 ? ImGuiTreeNodeFlags_DefaultOpen : 0);
+
+						if (NodeState.IsOpen)
+							for (int MemberIndex = MemberStartIndex; MemberIndex < MemberEndIndex; MemberIndex++)
+								DrawItemRow(State, MakeFunctionItem(Item.Ptr, Functions[MemberIndex]), CurrentMemberPath, StackIndex + 1);
+
+						EndSection(NodeState, State);
+					}
+				}
+			}
+
+			EndSection(FunctionSection, State);
+		}
+	}
+}
+
+UObject* GetItemObject(PropertyItem& Item) {
+	int StackOffset = 0;
+	PropertyItem Container = GetContainerItem(Item, StackOffset);
+	if (Container.Ptr && (Container.Type == PointerType::Object || TagHasFlag(Container.GetTag(), TagFlag_Object)))
+		return (UObject*)Container.Ptr;
+	return 0;
+}
+
+PropertyItem GetContainerItem(PropertyItem& Item, int& StackOffset) {
+	StackOffset = 0;
+	if (TagHasFlag(Item.GetTag(), TagFlag_ObjectPointer)) {
+		UObject* Obj = 0;
+		if (GetObjFromObjPointerProp(Item, Obj)) {
+			PropertyItem ObjectItem = MakeObjectItem(Obj);
+			ObjectItem.NodeID = Item.NodeID; // Same row, so it shares the node.
+			StackOffset = 1;
+			return ObjectItem;
+		}
+	}
+	return Item;
+}
+
+void DrawFlatTree(TreeState& State, FlatTree& Tree) {
+	SCOPE_EVENT("PropertyWatcher::DrawFlatTree");
+
+#if PROPERTY_WATCHER_BENCHMARKS
+	Benchmark.FlatRows += Tree.Rows.Num();
+#endif
+
+	int ScrollTargetIndex = -1;
+	if (State.ScrollTargetID)
+		for (int i = 0; i < Tree.VisibleRows.Num(); i++)
+			if (Tree.Rows[Tree.VisibleRows[i]].ID == State.ScrollTargetID) {
+				ScrollTargetIndex = i;
+				break;
+			}
+
+	ImGuiListClipper Clipper;
+	Clipper.Begin(Tree.VisibleRows.Num());
+	while (Clipper.Step())
+		for (int i = Clipper.DisplayStart; i < Clipper.DisplayEnd; i++)
+			DrawFlatRow(State, Tree, Tree.VisibleRows[i]);
+
+	if (Tree.Truncated) {
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::TextColored(ImVec4(1, 0.7f, 0.3f, 1), "Rows truncated at %d, close some nodes to see the rest.", Tree.MaxRowCount);
+	}
+
+	// Target row is probably clipped, so we scroll by row height.
+	if (ScrollTargetIndex != -1 && Clipper.ItemsHeight > 0) {
+		float TargetPosY = Clipper.StartPosY + ScrollTargetIndex * Clipper.ItemsHeight;
+		ImGui::SetScrollFromPosY(TargetPosY - ImGui::GetWindowPos().y, 0.5f);
+		State.ScrolledToTarget = true;
+	}
+}
+
+void DrawFlatRow(TreeState& State, FlatTree& Tree, int RowIndex) {
+	FlatRow& Row = Tree.Rows[RowIndex];
+
+	ImGui::PushID((const void*)(UPTRINT)Row.ID); defer{ ImGui::PopID(); };
+
+	// Tables pick up the indentation when the row starts, so this has to happen before the first column.
+	float Indent = Row.IndentLevel * ImGui::GetStyle().IndentSpacing;
+	if (Indent)
+		ImGui::Indent(Indent);
+	defer{ if (Indent) ImGui::Unindent(Indent); };
+
+	if (Row.Kind == FlatRow_Section) {
+		TreeNodeState NodeState = {};
+		NodeState.OverrideNoTreePush = true;
+		NodeState.Node = NodeCache.FindOrAdd(Row.ID);
+		BeginSection(Tree.GetRowName(Row), NodeState, State, Row.StackIndex);
+
+		if (NodeState.ActivatedForceToggleNodeOpenClose) {
+			if (Row.Parent == -1) {
+				for (int i = Row.MemberStart; i < Row.MemberEnd; i++)
+					ForceToggleNode(State, (*Tree.Roots)[i], 0);
+
+			} else if (PropertyItem* ParentItem = Tree.ResolveItem(Row.Parent))
+				ForceToggleNodesRecursive(State, *ParentItem, Tree.Rows[Row.Parent].StackIndex, Row.MemberStart, Row.MemberEnd);
+		}
+
+		EndSection(NodeState, State);
+		return;
+	}
+
+	PropertyItem* Item = Tree.ResolveItem(RowIndex);
+	if (!Item) {
+		// Tree changed under us, rows get rebuilt next frame.
+		ImGui::TableNextColumn();
+		ImGui::TableSetColumnIndex(ImGui::TableGetColumnCount() - 1);
+		return;
+	}
+
+	// Member path from the parent rows. Inlined parents don't have a row so their names go in front of ours.
+	TInlineComponentArray<FAView> CurrentPath;
+	int InlinedParentCount = 0;
+	bool CountInlinedParents = true;
+	for (int Parent = Row.Parent; Parent != -1; Parent = Tree.Rows[Parent].Parent) {
+		FlatRow& ParentRow = Tree.Rows[Parent];
+		CurrentPath.Insert(ParentRow.Item.GetAuthoredName(), 0);
+
+		if (CountInlinedParents && ParentRow.IsHidden)
+			InlinedParentCount++;
+		else
+			CountInlinedParents = false;
+	}
+
+	State.RowHasInlinedParent = InlinedParentCount > 0;
+	State.InlineMemberPathIndexOffset = CurrentPath.Num() - InlinedParentCount;
+
+	DrawItemRow(State, *Item, CurrentPath, Row.StackIndex);
+
+	State.RowHasInlinedParent = false;
+}
+
+void ForceToggleNode(TreeState& State, PropertyItem& Item, int StackIndex) {
+	if (StackIndex > State.ForceToggleNodeStackIndexLimit || !Item.CanBeOpened())
+		return;
+
+	VisitedPropertyInfo Info;
+	Info.Set(Item);
+	if (State.ForceToggleNodeMode && State.ItemIsInfiniteLooping(Info))
+		return;
+
+	TreeNode* Node = NodeCache.FindOrAdd(Item.NodeID);
+	bool WasOpen = Node->IsOpen;
+	Node->IsOpen = State.ForceToggleNodeMode;
+
+	// Closing only has to go through what was visible.
+	if (Node->IsOpen || WasOpen)
+		ForceToggleNodesRecursive(State, Item, StackIndex);
+}
+
+// Does what drawing the children for one frame does in immediate mode, flattened trees don't draw the closed rows.
+void ForceToggleNodesRecursive(TreeState& State, PropertyItem& Item, int StackIndex, int MemberStart, int MemberEnd) {
+	if (State.ItemDrawCount++ > 100000) // Same safety measure as in DrawItemRow.
+		return;
+
+	int StackOffset = 0;
+	PropertyItem Container = GetContainerItem(Item, StackOffset);
+	if (!Container.Ptr)
+		return;
+	StackIndex += StackOffset;
+
+	TreeNode* Node = NodeCache.FindOrAdd(Container.NodeID);
+	TArray<PropertyItem>& Members = NodeCache.GetChildren(*Node, Container);
+	bool AllMembers = MemberStart == 0 && MemberEnd == -1;
+	if (MemberEnd == -1 || MemberEnd > Members.Num())
+		MemberEnd = Members.Num();
+
+	bool ItemIsObject = TagHasFlag(Container.GetTag(), TagFlag_Object) || Container.Type == PointerType::Object;
+	if (AllMembers && State.EnableClassCategoriesOnObjectItems && ItemIsObject && StackIndex <= State.ForceToggleNodeStackIndexLimit) {
+		StructLayout* Layout = GetStructLayout(((UObject*)Container.Ptr)->GetClass());
+		if (Layout->SectionNames.Num() >= 2)
+			for (int SectionIndex = 0; SectionIndex < Layout->SectionNames.Num(); SectionIndex++)
+				NodeCache.FindOrAdd(MakeNodeID(Container.NodeID, 0, (void*)NodeKey_Section, SectionIndex), SectionIndex == 0)->IsOpen = State.ForceToggleNodeMode;
+	}
+
+	VisitedPropertyInfo Info;
+	Info.Set(Item);
+	State.VisitedPropertiesStack.Push(Info);
+
+	for (int i = MemberStart; i < MemberEnd; i++)
+		ForceToggleNode(State, Members[i], StackIndex + 1);
+
+	State.VisitedPropertiesStack.Pop(false);
+	NodeCache.StructureVersion++;
+}
+
+bool ItemHasMetaData(PropertyItem& Item) {
+	if (!Item.Prop)
+		return false;
+
+	return !DisplayTexts.Get(Item.Prop).Metadata.IsEmpty();
+}
+
+FAView GetColumnCellText(PropertyItem& Item, int ColumnID, TreeState* State, TInlineComponentArray<FAView>* CurrentMemberPath, int* StackIndex) {
+	FAView Result = "";
+	if (ColumnID == ColumnID_Name) {
+		if (CurrentMemberPath && StackIndex) {
+			bool TopLevelWatchListItem = State->CurrentWatchItemIndex != -1 && (*StackIndex) == 0;
+			bool PathIsEditable = TopLevelWatchListItem && State->PathStringPtr;
+
+			if (!PathIsEditable) {
+				if ((State->ForceInlineChildItems && State->InlineStackIndexLimit) || State->RowHasInlinedParent) {
+					TMemBuilder(Builder);
+					for (int i = State->InlineMemberPathIndexOffset; i < CurrentMemberPath->Num(); i++)
+						Builder.Appendf("%s.", (*CurrentMemberPath)[i].GetData());
+					Builder.Append(Item.GetAuthoredName());
+					Result = *Builder;
+
+				} else
+					Result = Item.GetAuthoredName();
+			}
+		}
+
+	} else if (ColumnID == ColumnID_Value) {
+		Result = GetValueStringFromItem(Item);
+
+	} else if (ColumnID == ColumnID_Metadata && Item.Prop) {
+		Result = DisplayTexts.Get(Item.Prop).Metadata;
+
+	} else if (ColumnID == ColumnID_Type) {
+		Result = Item.GetPropertyType();
+
+	} else if (ColumnID == ColumnID_Cpptype) {
+		Result = Item.GetCPPType();
+
+	} else if (ColumnID == ColumnID_Class) {
+		if (Item.Prop)
+			Result = DisplayTexts.Get(Item.Prop).Class;
+		else if (Item.Type == PointerType::Function)
+			Result = DisplayTexts.Get(Item.StructPtr).Class;
+
+	} else if (ColumnID == ColumnID_Category) {
+		Result = GetItemMetadataCategory(Item);
+
+	} else if (ColumnID == ColumnID_Address) {
+		Result = TMem.Printf("0x%" PRIXPTR "\n", (uintptr_t)Item.Ptr);
+
+	} else if (ColumnID == ColumnID_Size) {
+		int Size = Item.GetSize();
+		if (Size != -1)
+			Result = TMem.Printf("%d B", Size);
+
+	} else if (ColumnID == ColumnID_Distance) {
+		if (SpatialIndex.HasOrigin && Item.Ptr && (Item.Type == PointerType::Object || TagHasFlag(Item.GetTag(), TagFlag_Object))) {
+			AActor* Actor = Cast<AActor>((UObject*)Item.Ptr);
+			if (Actor && Actor->GetRootComponent())
+				Result = TMem.Printf("%.1f m", FVector::Dist(Actor->GetActorLocation(), SpatialIndex.Origin) / 100);
+		}
+	}
+
+	return Result;
+}
+
+FAView GetValueStringFromItem(PropertyItem& Item) {
+	// Maybe we could just serialize the property to string?
+	// Since we don't handle that many types for now we can just do it by hand.
+	if (!Item.Ptr)
+		return "Null";
+
+	if (!Item.Prop)
+		return "";
+
+	auto FormatValue = GetTagInfo(Item.GetTag()).FormatValue;
+	return FormatValue ? FormatValue(Item) : "";
+}
+
+void DrawPropertyValue(PropertyItem& Item) {
+	if (Item.Ptr == 0)
+		ImGui::Text("<Null>");
+
+	else if (Item.Prop == 0)
+		ImGui::Text("{%d}", Item.GetMemberCount());
+
+	else
+		GetTagInfo(Item.GetTag()).DrawValue(Item);
+}
+
+// -------------------------------------------------------------------------------------------
+
+PropertyTag ResolvePropertyTag(FProperty* Prop) {
+	// Order matters, subclasses have to come before their base classes.
+	if (Prop->IsA(FClassProperty::StaticClass()))                   return Tag_Class;
+	if (Prop->IsA(FSoftClassProperty::StaticClass()))               return Tag_SoftClass;
+	if (Prop->IsA(FWeakObjectProperty::StaticClass()))              return Tag_WeakObject;
+	if (Prop->IsA(FLazyObjectProperty::StaticClass()))              return Tag_LazyObject;
+	if (Prop->IsA(FSoftObjectProperty::StaticClass()))              return Tag_SoftObject;
+	if (Prop->IsA(FObjectProperty::StaticClass()))                  return Tag_Object;
+	if (Prop->IsA(FInterfaceProperty::StaticClass()))               return Tag_Interface;
+	if (Prop->IsA(FBoolProperty::StaticClass()))                    return Tag_Bool;
+	if (Prop->IsA(FInt8Property::StaticClass()))                    return Tag_Int8;
+	if (Prop->IsA(FInt16Property::StaticClass()))                   return Tag_Int16;
+	if (Prop->IsA(FUInt16Property::StaticClass()))                  return Tag_UInt16;
+	if (Prop->IsA(FIntProperty::StaticClass()))                     return Tag_Int;
+	if (Prop->IsA(FUInt32Property::StaticClass()))                  return Tag_UInt32;
+	if (Prop->IsA(FInt64Property::StaticClass()))                   return Tag_Int64;
+	if (Prop->IsA(FUInt64Property::StaticClass()))                  return Tag_UInt64;
+	if (Prop->IsA(FFloatProperty::StaticClass()))                   return Tag_Float;
+	if (Prop->IsA(FDoubleProperty::StaticClass()))                  return Tag_Double;
+	if (Prop->IsA(FStrProperty::StaticClass()))                     return Tag_Str;
+	if (Prop->IsA(FNameProperty::StaticClass()))                    return Tag_Name;
+	if (Prop->IsA(FTextProperty::StaticClass()))                    return Tag_Text;
+	if (Prop->IsA(FArrayProperty::StaticClass()))                   return Tag_Array;
+	if (Prop->IsA(FMapProperty::StaticClass()))                     return Tag_Map;
+	if (Prop->IsA(FSetProperty::StaticClass()))                     return Tag_Set;
+	if (Prop->IsA(FMulticastDelegateProperty::StaticClass()))       return Tag_MulticastDelegate;
+	if (Prop->IsA(FDelegateProperty::StaticClass()))                return Tag_Delegate;
+
+	if (FByteProperty* ByteProp = CastField<FByteProperty>(Prop))
+		return ByteProp->IsEnum() ? Tag_Enum : Tag_Byte;
+
+	if (FStructProperty* StructProp = CastField<FStructProperty>(Prop)) {
+		static const TMap<FName, PropertyTag> StructTags = {
+			{ "Vector",      Tag_Vector },
+			{ "Rotator",     Tag_Rotator },
+			{ "Vector2D",    Tag_Vector2D },
+			{ "IntVector",   Tag_IntVector },
+			{ "IntVector2",  Tag_IntVector2 },
+			{ "IntPoint",    Tag_IntPoint },
+			{ "Timespan",    Tag_Timespan },
+			{ "DateTime",    Tag_DateTime },
+			{ "LinearColor", Tag_LinearColor },
+			{ "Color",       Tag_Color },
+			{ "Transform",   Tag_Transform },
+		};
+
+		const PropertyTag* Tag = StructTags.Find(StructProp->Struct->GetFName());
+		return Tag ? *Tag : Tag_Struct;
+	}
+
+	return Tag_Unknown;
+}
+
+PropertyTag GetPropertyTag(FProperty* Prop) {
+	if (!Prop)
+		return Tag_None;
+
+	PropertyTag& Tag = PropertyTagCache.FindOrAdd(Prop, Tag_Unresolved);
+	if (Tag == Tag_Unresolved) {
+		Tag = ResolvePropertyTag(Prop);
+		TrackReflectionKey(Prop, Prop->GetOwnerUObject());
+	}
+	return Tag;
+}
+
+PropertyTag PropertyItem::GetTag() {
+	if (Tag == Tag_Unresolved)
+		Tag = GetPropertyTag(Prop);
+	return Tag;
+}
+
+static TArray<char> ValueStringBuffer;
+
+template <typename T> struct NumericTypeInfo {};
+template <> struct NumericTypeInfo<int8>   { static constexpr ImGuiDataType DataType = ImGuiDataType_S8;     static constexpr int8   Step = 1;  static constexpr int8   StepFast = 10;  static constexpr const char* Format = "%d"; };
+template <> struct NumericTypeInfo<uint8>  { static constexpr ImGuiDataType DataType = ImGuiDataType_U8;     static constexpr uint8  Step = 1;  static constexpr uint8  StepFast = 10;  static constexpr const char* Format = "%u"; };
+template <> struct NumericTypeInfo<int16>  { static constexpr ImGuiDataType DataType = ImGuiDataType_S16;    static constexpr int16  Step = 1;  static constexpr int16  StepFast = 100; static constexpr const char* Format = "%d"; };
+template <> struct NumericTypeInfo<uint16> { static constexpr ImGuiDataType DataType = ImGuiDataType_U16;    static constexpr uint16 Step = 1;  static constexpr uint16 StepFast = 100; static constexpr const char* Format = "%u"; };
+template <> struct NumericTypeInfo<int32>  { static constexpr ImGuiDataType DataType = ImGuiDataType_S32;    static constexpr int32  Step = 1;  static constexpr int32  StepFast = 100; static constexpr const char* Format = "%d"; };
+template <> struct NumericTypeInfo<uint32> { static constexpr ImGuiDataType DataType = ImGuiDataType_U32;    static constexpr uint32 Step = 1;  static constexpr uint32 StepFast = 100; static constexpr const char* Format = "%u"; };
+template <> struct NumericTypeInfo<int64>  { static constexpr ImGuiDataType DataType = ImGuiDataType_S64;    static constexpr int64  Step = 1;  static constexpr int64  StepFast = 100; static constexpr const char* Format = "%" PRId64; };
+template <> struct NumericTypeInfo<uint64> { static constexpr ImGuiDataType DataType = ImGuiDataType_U64;    static constexpr uint64 Step = 1;  static constexpr uint64 StepFast = 100; static constexpr const char* Format = "%" PRIu64; };
+template <> struct NumericTypeInfo<float>  { static constexpr ImGuiDataType DataType = ImGuiDataType_Float;  static constexpr float  Step = 0;  static constexpr float  StepFast = 0;   static constexpr const char* Format = "%f"; };
+template <> struct NumericTypeInfo<double> { static constexpr ImGuiDataType DataType = ImGuiDataType_Double; static constexpr double Step = 0;  static constexpr double StepFast = 0;   static constexpr const char* Format = "%f"; };
+
+template <typename T>
+void DrawNumericValue(PropertyItem& Item) {
+	using Info = NumericTypeInfo<T>;
+	static T Step = Info::Step;
+	static T StepFast = Info::StepFast;
+
+	if constexpr (std::is_floating_point_v<T>)
+		ImGui::InputScalar("##Numeric", Info::DataType, Item.Ptr, 0, 0, std::is_same_v<T, float> ? "%.3f" : "%.6f");
+	else
+		ImGui::InputScalar("##Numeric", Info::DataType, Item.Ptr, &Step, &StepFast);
+}
+
+template <typename T>
+FAView FormatNumericValue(PropertyItem& Item) {
+	if constexpr (std::is_floating_point_v<T>)
+		return TMem.Printf(NumericTypeInfo<T>::Format, (double)*(T*)Item.Ptr);
+	else
+		return TMem.Printf(NumericTypeInfo<T>::Format, *(T*)Item.Ptr);
+}
+
+void DrawUnknownValue(PropertyItem& Item) {
+	ImGui::Text("<UnknownType>");
+}
+
+void DrawMemberCountValue(PropertyItem& Item) {
+	ImGui::Text("{%d}", Item.GetMemberCount());
+}
+
+void DrawBoolValue(PropertyItem& Item) {
+	FBoolProperty* BoolProp = (FBoolProperty*)Item.Prop;
+	bool TempBool = BoolProp->GetPropertyValue(Item.Ptr);
+	ImGui::Checkbox("", &TempBool);
+	BoolProp->SetPropertyValue(Item.Ptr, TempBool);
+}
+
+void DrawEnumValue(PropertyItem& Item) {
+	UEnum* Enum = ((FByteProperty*)Item.Prop)->Enum;
+	int Count = Enum->NumEnums();
+
+	uint8* Value = (uint8*)Item.Ptr;
+	int TempInt = *Value;
+	if (ImGui::Combo("##Enum", &TempInt, DisplayTexts.GetEnumComboItems(Enum).GetData(), Count))
+		*Value = TempInt;
+}
+
+void DrawStrValue(PropertyItem& Item) {
+	ImGuiAddon::InputString("##StringProp", *(FString*)Item.Ptr, ValueStringBuffer);
+}
+
+void DrawNameValue(PropertyItem& Item) {
+	FString Str = ((FName*)Item.Ptr)->ToString();
+	if (ImGuiAddon::InputString("##NameProp", Str, ValueStringBuffer)) (*((FName*)Item.Ptr)) = FName(Str);
+}
+
+void DrawTextValue(PropertyItem& Item) {
+	FString Str = ((FText*)Item.Ptr)->ToString();
+	if (ImGuiAddon::InputString("##TextProp", Str, ValueStringBuffer)) (*((FText*)Item.Ptr)) = FText::FromString(Str);
+}
+
+FAView FormatBoolValue(PropertyItem& Item) {
+	return ((FBoolProperty*)Item.Prop)->GetPropertyValue(Item.Ptr) ? "true" : "false";
+}
+
+FAView FormatStrValue(PropertyItem& Item) {
+	return TMem.SToA(*(FString*)Item.Ptr);
+}
+
+FAView FormatNameValue(PropertyItem& Item) {
+	return NameTable.Get(*((FName*)Item.Ptr));
+}
+
+FAView FormatTextValue(PropertyItem& Item) {
+	return TMem.SToA((FString&)((FText*)Item.Ptr)->ToString());
+}
+
+void DrawClassValue(PropertyItem& Item) {
+	UClass* Class = (UClass*)Item.Ptr;
+	ImGui::Text(ImGui_StoA(*Class->GetAuthoredName()));
+}
+
+void DrawSoftClassValue(PropertyItem& Item) {
+	FSoftObjectPtr* SoftClass = (FSoftObjectPtr*)Item.Ptr;
+	if (SoftClass->IsStale())
+		ImGui::Text("<Stale>");
+	else if (SoftClass->IsPending())
+		ImGui::Text("<Pending>");
+	else if (!SoftClass->IsValid())
+		ImGui::Text("<Null>");
+	else {
+		FString Path = SoftClass->ToSoftObjectPath().ToString();
+		if (Path.Len())
+			ImGuiAddon::InputString("##SoftClassProp", Path, ValueStringBuffer);
+	}
+}
+
+void DrawWeakObjectValue(PropertyItem& Item) {
+	TWeakObjectPtr<UObject>* WeakPtr = (TWeakObjectPtr<UObject>*)Item.Ptr;
+	if (WeakPtr->IsStale())
+		ImGui::Text("<Stale>");
+	if (!WeakPtr->IsValid())
+		ImGui::Text("<Null>");
+	else {
+		auto NewItem = MakeObjectItem(WeakPtr->Get());
+		DrawPropertyValue(NewItem);
+	}
+}
+
+void DrawLazyObjectValue(PropertyItem& Item) {
+	TLazyObjectPtr<UObject>* LazyPtr = (TLazyObjectPtr<UObject>*)Item.Ptr;
+	if (LazyPtr->IsStale())
+		ImGui::Text("<Stale>");
+	if (!LazyPtr->IsValid())
+		ImGui::Text("<Null>");
+	else {
+		auto NewItem = MakeObjectItem(LazyPtr->Get());
+		DrawPropertyValue(NewItem);
+	}
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+	FString ID = LazyPtr->GetUniqueID().ToString();
+	ImGuiAddon::InputString("##LazyObjectProp", ID, ValueStringBuffer);
+}
+
+void DrawSoftObjectValue(PropertyItem& Item) {
+	TSoftObjectPtr<UObject>* SoftObjPtr = (TSoftObjectPtr<UObject>*)Item.Ptr;
+	if (SoftObjPtr->IsPending())
+		ImGui::Text("<Pending>");
+	else if (!SoftObjPtr->IsValid())
+		ImGui::Text("<Null>");
+	else {
+		FString Path = SoftObjPtr->ToSoftObjectPath().ToString();
+		if (Path.Len())
+			ImGuiAddon::InputString("##SoftObjProp", Path, ValueStringBuffer);
+	}
+}
+
+void DrawObjectValue(PropertyItem& Item) {
+	int MemberCount = Item.GetMemberCount();
+	if (MemberCount)
+		ImGui::Text("{%d}", MemberCount);
+	else
+		ImGui::Text("{}");
+}
+
+void DrawArrayValue(PropertyItem& Item) {
+	FArrayProperty* ArrayProp = (FArrayProperty*)Item.Prop;
+	FScriptArrayHelper ScriptArrayHelper(ArrayProp, Item.Ptr);
+	ImGui::Text("%s [%d]", DisplayTexts.Get(ArrayProp->Inner).CppType.GetData(), ScriptArrayHelper.Num());
+}
+
+void DrawMapValue(PropertyItem& Item) {
+	FMapProperty* MapProp = (FMapProperty*)Item.Prop;
+	FScriptMapHelper Helper = FScriptMapHelper(MapProp, Item.Ptr);
+	ImGui::Text("<%s, %s> (%d)", DisplayTexts.Get(MapProp->KeyProp).CppType.GetData(), DisplayTexts.Get(MapProp->ValueProp).CppType.GetData(), Helper.Num());
+}
+
+void DrawSetValue(PropertyItem& Item) {
+	FScriptSetHelper Helper = FScriptSetHelper((FSetProperty*)Item.Prop, Item.Ptr);
+	ImGui::Text("<%s> {%d}", DisplayTexts.Get(Helper.GetElementProperty()).CppType.GetData(), Helper.Num());
+}
+
+void DrawMulticastDelegateValue(PropertyItem& Item) {
+	ImGui::Text("<NotImplemented>"); // @Todo
+}
+
+void DrawDelegateValue(PropertyItem& Item) {
+	auto ScriptDelegate = (TScriptDelegate<FWeakObjectPtr>*)Item.Ptr;
+	FString Text;
+	if (ScriptDelegate->IsBound()) Text = ScriptDelegate->GetFunctionName().ToString();
+	else                           Text = "<No Function Bound>";
+	ImGui::Text(ImGui_StoA(*Text));
+}
+
+void DrawVectorValue(PropertyItem& Item) {
+	ImGui::InputScalarN("##FVector", ImGuiDataType_Double, &((FVector*)Item.Ptr)->X, 3);
+}
+
+void DrawRotatorValue(PropertyItem& Item) {
+	ImGui::InputScalarN("##FVector", ImGuiDataType_Double, &((FRotator*)Item.Ptr)->Pitch, 3);
+}
+
+void DrawVector2DValue(PropertyItem& Item) {
+	ImGui::InputScalarN("##FVector2D", ImGuiDataType_Double, &((FVector2D*)Item.Ptr)->X, 2);
+}
+
+void DrawIntVectorValue(PropertyItem& Item) {
+	ImGui::InputInt3("##FIntVector", &((FIntVector*)Item.Ptr)->X);
+}
+
+void DrawIntPointValue(PropertyItem& Item) {
+	ImGui::InputInt2("##FIntPoint", &((FIntPoint*)Item.Ptr)->X);
+}
+
+void DrawTimespanValue(PropertyItem& Item) {
+	FString s = ((FTimespan*)Item.Ptr)->ToString();
+	if (ImGuiAddon::InputString("##FTimespan", s, ValueStringBuffer))
+		FTimespan::Parse(s, *((FTimespan*)Item.Ptr));
+}
+
+void DrawDateTimeValue(PropertyItem& Item) {
+	FString s = ((FDateTime*)Item.Ptr)->ToString();
+	if (ImGuiAddon::InputString("##FDateTime", s, ValueStringBuffer))
+		FDateTime::Parse(s, *((FDateTime*)Item.Ptr));
+}
+
+void DrawLinearColorValue(PropertyItem& Item) {
+	FLinearColor* lCol = (FLinearColor*)Item.Ptr;
+	FColor sCol = lCol->ToFColor(true);
+	float c[4] = { sCol.R / 255.0f, sCol.G / 255.0f, sCol.B / 255.0f, sCol.A / 255.0f };
+	if (ImGui::ColorEdit4("##FLinearColor", c, ImGuiColorEditFlags_AlphaPreview)) {
+		sCol = FColor(c[0] * 255, c[1] * 255, c[2] * 255, c[3] * 255);
+		*lCol = FLinearColor::FromSRGBColor(sCol);
+	}
+}
+
+void DrawColorValue(PropertyItem& Item) {
+	FColor* sCol = (FColor*)Item.Ptr;
+	float c[4] = { sCol->R / 255.0f, sCol->G / 255.0f, sCol->B / 255.0f, sCol->A / 255.0f };
+	if (ImGui::ColorEdit4("##FColor", c, ImGuiColorEditFlags_AlphaPreview))
+		*sCol = FColor(c[0] * 255, c[1] * 255, c[2] * 255, c[3] * 255);
+}
+
+const PropertyTagInfo& GetTagInfo(PropertyTag Tag) {
+	static PropertyTagInfo Infos[Tag_Count] = {};
+	static bool Init = true;
+	if (Init) {
+		Init = false;
+
+		for (auto& It : Infos)
+			It.DrawValue = DrawUnknownValue;
+
+		// Colors copied from GraphEditorSettings.cpp
+		FLinearColor BooleanPinTypeColor(0.300000f, 0.0f, 0.0f, 1.0f);              // maroon
+		FLinearColor BytePinTypeColor(0.0f, 0.160000f, 0.131270f, 1.0f);            // dark green
+		FLinearColor ClassPinTypeColor(0.1f, 0.0f, 0.5f, 1.0f);                     // deep purple (violet
+		FLinearColor IntPinTypeColor(0.013575f, 0.770000f, 0.429609f, 1.0f);        // green-blue
+		FLinearColor Int64PinTypeColor(0.413575f, 0.770000f, 0.429609f, 1.0f);
+		FLinearColor FloatPinTypeColor(0.357667f, 1.0f, 0.060000f, 1.0f);           // bright green
+		FLinearColor DoublePinTypeColor(0.039216f, 0.666667f, 0.0f, 1.0f);          // darker green
+		FLinearColor NamePinTypeColor(0.607717f, 0.224984f, 1.0f, 1.0f);            // lilac
+		FLinearColor DelegatePinTypeColor(1.0f, 0.04f, 0.04f, 1.0f);                // bright red
+		FLinearColor ObjectPinTypeColor(0.0f, 0.4f, 0.910000f, 1.0f);               // sharp blue
+		FLinearColor SoftClassPinTypeColor(1.0f, 0.3f, 1.0f, 1.0f);
+		FLinearColor InterfacePinTypeColor(0.8784f, 1.0f, 0.4f, 1.0f);              // pale green
+		FLinearColor StringPinTypeColor(1.0f, 0.0f, 0.660537f, 1.0f);               // bright pink
+		FLinearColor TextPinTypeColor(0.8f, 0.2f, 0.4f, 1.0f);                      // salmon (light pink
+		FLinearColor StructPinTypeColor(0.0f, 0.1f, 0.6f, 1.0f);                    // deep blue
+		FLinearColor VectorPinTypeColor(1.0f, 0.591255f, 0.016512f, 1.0f);          // yellow
+		FLinearColor RotatorPinTypeColor(0.353393f, 0.454175f, 1.0f, 1.0f);         // periwinkle
+		FLinearColor TransformPinTypeColor(1.0f, 0.172585f, 0.0f, 1.0f);            // orange
+
+		auto Set = [](PropertyTagInfo& Info, PropertyTagInfo::DrawFunc Draw, PropertyTagInfo::FormatFunc Format, int Flags) {
+			Info.DrawValue = Draw;
+			Info.FormatValue = Format;
+			Info.Flags = Flags;
+		};
+
+		auto SetColor = [](PropertyTagInfo& Info, FLinearColor LinearColor) {
+			FColor c = LinearColor.ToFColor(true);
+			Info.Color = { c.R / 255.0f, c.G / 255.0f, c.B / 255.0f, c.A / 255.0f };
+			Info.HasColor = true;
+		};
+
+		int Expandable = TagFlag_Expandable;
+
+		Set(Infos[Tag_Bool],              DrawBoolValue,                FormatBoolValue,              0);
+		Set(Infos[Tag_Int8],              DrawNumericValue<int8>,       FormatNumericValue<int8>,     TagFlag_Numeric);
+		Set(Infos[Tag_Byte],              DrawNumericValue<uint8>,      FormatNumericValue<uint8>,    TagFlag_Numeric);
+		Set(Infos[Tag_Enum],              DrawEnumValue,                FormatNumericValue<uint8>,    TagFlag_Numeric);
+		Set(Infos[Tag_Int16],             DrawNumericValue<int16>,      FormatNumericValue<int16>,    TagFlag_Numeric);
+		Set(Infos[Tag_UInt16],            DrawNumericValue<uint16>,     FormatNumericValue<uint16>,   TagFlag_Numeric);
+		Set(Infos[Tag_Int],               DrawNumericValue<int32>,      FormatNumericValue<int32>,    TagFlag_Numeric);
+		Set(Infos[Tag_UInt32],            DrawNumericValue<uint32>,     FormatNumericValue<uint32>,   TagFlag_Numeric);
+		Set(Infos[Tag_Int64],             DrawNumericValue<int64>,      FormatNumericValue<int64>,    TagFlag_Numeric);
+		Set(Infos[Tag_UInt64],            DrawNumericValue<uint64>,     FormatNumericValue<uint64>,   TagFlag_Numeric);
+		Set(Infos[Tag_Float],             DrawNumericValue<float>,      FormatNumericValue<float>,    TagFlag_Numeric);
+		Set(Infos[Tag_Double],            DrawNumericValue<double>,     FormatNumericValue<double>,   TagFlag_Numeric);
+		Set(Infos[Tag_Str],               DrawStrValue,                 FormatStrValue,               0);
+		Set(Infos[Tag_Name],              DrawNameValue,                FormatNameValue,              0);
+		Set(Infos[Tag_Text],              DrawTextValue,                FormatTextValue,              0);
+
+		Set(Infos[Tag_Object],            DrawObjectValue,              0, Expandable | TagFlag_Object);
+		Set(Infos[Tag_Class],             DrawClassValue,               0, Expandable | TagFlag_Object);
+		Set(Infos[Tag_SoftClass],         DrawSoftClassValue,           0, Expandable | TagFlag_ObjectPointer);
+		Set(Infos[Tag_WeakObject],        DrawWeakObjectValue,          0, Expandable | TagFlag_ObjectPointer);
+		Set(Infos[Tag_LazyObject],        DrawLazyObjectValue,          0, Expandable | TagFlag_ObjectPointer);
+		Set(Infos[Tag_SoftObject],        DrawSoftObjectValue,          0, Expandable | TagFlag_ObjectPointer);
+		Set(Infos[Tag_Interface],         DrawUnknownValue,             0, 0);
+
+		Set(Infos[Tag_Array],             DrawArrayValue,               0, Expandable);
+		Set(Infos[Tag_Map],               DrawMapValue,                 0, Expandable);
+		Set(Infos[Tag_Set],               DrawSetValue,                 0, Expandable);
+		Set(Infos[Tag_Delegate],          DrawDelegateValue,            0, Expandable);
+		Set(Infos[Tag_MulticastDelegate], DrawMulticastDelegateValue,   0, Expandable);
+
+		// @Todo: The struct types that are drawn in one row shouldn't be hardcoded.
+		Set(Infos[Tag_Struct],            DrawMemberCountValue,         0, Expandable | TagFlag_Struct);
+		Set(Infos[Tag_Vector],            DrawVectorValue,              0, TagFlag_Struct);
+		Set(Infos[Tag_Rotator],           DrawRotatorValue,             0, TagFlag_Struct);
+		Set(Infos[Tag_Vector2D],          DrawVector2DValue,            0, TagFlag_Struct);
+		Set(Infos[Tag_IntVector],         DrawIntVectorValue,           0, TagFlag_Struct);
+		Set(Infos[Tag_IntVector2],        DrawMemberCountValue,         0, TagFlag_Struct);
+		Set(Infos[Tag_IntPoint],          DrawIntPointValue,            0, Expandable | TagFlag_Struct);
+		Set(Infos[Tag_Timespan],          DrawTimespanValue,            0, TagFlag_Struct);
+		Set(Infos[Tag_DateTime],          DrawDateTimeValue,            0, TagFlag_Struct);
+		Set(Infos[Tag_LinearColor],       DrawLinearColorValue,         0, Expandable | TagFlag_Struct);
+		Set(Infos[Tag_Color],             DrawColorValue,               0, Expandable | TagFlag_Struct);
+		Set(Infos[Tag_Transform],         DrawMemberCountValue,         0, Expandable | TagFlag_Struct);
+
+		SetColor(Infos[Tag_Bool],       BooleanPinTypeColor);
+		SetColor(Infos[Tag_Byte],       BytePinTypeColor);
+		SetColor(Infos[Tag_Enum],       BytePinTypeColor);
+		SetColor(Infos[Tag_Class],      ClassPinTypeColor);
+		SetColor(Infos[Tag_Int],        IntPinTypeColor);
+		SetColor(Infos[Tag_Int64],      Int64PinTypeColor);
+		SetColor(Infos[Tag_Float],      FloatPinTypeColor);
+		SetColor(Infos[Tag_Double],     DoublePinTypeColor);
+		SetColor(Infos[Tag_Name],       NamePinTypeColor);
+		SetColor(Infos[Tag_Delegate],   DelegatePinTypeColor);
+		SetColor(Infos[Tag_Object],     ObjectPinTypeColor);
+		SetColor(Infos[Tag_SoftClass],  SoftClassPinTypeColor);
+		SetColor(Infos[Tag_Interface],  InterfacePinTypeColor);
+		SetColor(Infos[Tag_Str],        StringPinTypeColor);
+		SetColor(Infos[Tag_Text],       TextPinTypeColor);
+		SetColor(Infos[Tag_Vector],     VectorPinTypeColor);
+		SetColor(Infos[Tag_Rotator],    RotatorPinTypeColor);
+		SetColor(Infos[Tag_Transform],  TransformPinTypeColor);
+		for (int Tag = Tag_Struct; Tag <= Tag_Transform; Tag++)
+			if (!Infos[Tag].HasColor)
+				SetColor(Infos[Tag], StructPinTypeColor);
+	}
+
+	return Infos[Tag];
+}
+
+void WatchPathResolver::NewFrame(TArray<PropertyItemCategory>& _Categories) {
+	Frame++;
+	Categories = &_Categories;
+
+	// Root items are usually rebuilt by the caller every frame, the lookup only gets rebuilt when they actually change.
+	uint64 Hash = _Categories.Num();
+	for (auto& Category : _Categories) {
+		for (auto& Item : Category.Items) {
+			Hash = CityHash128to64({ Hash, (uint64)Item.Ptr ^ ((uint64)Item.StructPtr << 1) ^ ((uint64)Item.Prop << 2) ^ (uint64)Item.Type });
+			Hash = CityHash128to64({ Hash, CityHash64(Item.NameOverwrite.GetData(), Item.NameOverwrite.Len()) });
+		}
+	}
+	if (Hash == RootsHash)
+		return;
+
+	RootsHash = Hash;
+	RootLookup.Reset();
+	for (int i = 0; i < _Categories.Num(); i++)
+		for (int j = 0; j < _Categories[i].Items.Num(); j++)
+			RootLookup.Add(FString(_Categories[i].Items[j].GetAuthoredName()), FIntPoint(i, j)); // Last one wins, like the path search did.
+
+	// Roots can point to different memory now.
+	for (auto& Node : Nodes)
+		Node.ResolvedFrame = 0;
+}
+
+bool WatchPathResolver::Resolve(MemberPath& Member) {
+	SCOPE_EVENT("PropertyWatcher::WatchPathResolver::Resolve");
+	PROFILE_PHASE(Phase_WatchResolve);
+
+	Counters.WatchResolves++;
+	int* NodeIndex = PathNodes.Find(Member.PathString);
+	int Index = NodeIndex ? *NodeIndex : Compile(Member.PathString);
+
+	bool Found = Index > 0 && ResolveNode(Index);
+	Member.CachedItem = Found ? Nodes[Index].Item : PropertyItem();
+
+	// Have to set this either way, because we want to see the path in the watch window.
+	Member.CachedItem.NameOverwrite = TMem.SToA(Member.PathString);
+	return Found;
+}
+
+int WatchPathResolver::Compile(const FString& PathString) {
+	if (Nodes.Num() > MaxNodes)
+		Clear();
+	if (!Nodes.Num())
+		Nodes.AddDefaulted();
+
+	TArray<FString> Segments;
+	PathString.ParseIntoArray(Segments, TEXT("."));
+
+	int Current = 0;
+	for (FString& Segment : Segments) {
+		if (int* Child = Nodes[Current].Children.Find(Segment)) {
+			Current = *Child;
+			continue;
+		}
+
+		WatchPathNode Node;
+		Node.Parent = Current;
+		Node.Segment = Segment;
+		if (Segment.StartsWith(TEXT("["))) {
+			Node.Index = FCString::Atoi(*Segment + 1);
+			if (Segment.EndsWith(TEXT(" Key")))
+				Node.MapPart = 1;
+			else if (Segment.EndsWith(TEXT(" Value")))
+				Node.MapPart = 2;
+		}
+
+		int NewIndex = Nodes.Add(MoveTemp(Node));
+		Nodes[Current].Children.Add(Segment, NewIndex);
+		Current = NewIndex;
+	}
+
+	PathNodes.Add(PathString, Current);
+	return Current;
+}
+
+bool WatchPathResolver::ResolveNode(int NodeIndex) {
+	// Nodes don't get added while resolving, so the reference stays valid.
+	WatchPathNode& Node = Nodes[NodeIndex];
+	if (Node.ResolvedFrame == Frame)
+		return Node.Found;
+
+	Node.ResolvedFrame = Frame;
+	Node.Found = false;
+
+	if (Node.Parent == 0) {
+		FIntPoint* Root = RootLookup.Find(Node.Segment);
+		if (Root && Categories->IsValidIndex(Root->X) && (*Categories)[Root->X].Items.IsValidIndex(Root->Y)) {
+			Node.Item = (*Categories)[Root->X].Items[Root->Y];
+			Node.Found = true;
+		}
+
+	} else if (ResolveNode(Node.Parent))
+		Node.Found = ResolveStep(Node, Nodes[Node.Parent].Item);
+
+	return Node.Found;
+}
+
+// Same member lookup as PropertyItem::GetMembers, without making items for all the siblings.
+bool WatchPathResolver::ResolveStep(WatchPathNode& Node, PropertyItem& Parent) {
+	if (!Parent.Ptr)
+		return false;
+
+	PropertyItem Container = Parent;
+	PropertyTag Tag = Container.GetTag();
+	if (TagHasFlag(Tag, TagFlag_ObjectPointer)) {
+		UObject* Obj = 0;
+		if (!GetObjFromObjPointerProp(Container, Obj))
+			return false;
+		Container = MakeObjectItem(Obj);
+		Tag = Container.GetTag();
+	}
+
+	UStruct* Struct = 0;
+	if (Container.Type == PointerType::Object || TagHasFlag(Tag, TagFlag_Object))
+		Struct = ((UObject*)Container.Ptr)->GetClass();
+	else if (Container.Type == PointerType::Struct || TagHasFlag(Tag, TagFlag_Struct))
+		Struct = Container.StructPtr ? Container.StructPtr : ((FStructProperty*)Container.Prop)->Struct;
+
+	if (Struct) {
+		StructLayout* Layout = GetStructLayout(Struct);
+		if (Node.CachedStruct != Struct) {
+			Node.CachedStruct = Struct;
+			Node.CachedMember = -1;
+
+			auto Name = StringCast<ANSICHAR>(*Node.Segment, Node.Segment.Len());
+			FAView NameView(Name.Get(), Name.Length());
+			for (int i = 0; i < Layout->Members.Num(); i++) {
+				if (Layout->Members[i].Name.Equals(NameView, ESearchCase::IgnoreCase)) {
+					Node.CachedMember = i;
+					break;
+				}
+			}
+		}
+		if (!Layout->Members.IsValidIndex(Node.CachedMember))
+			return false;
+
+		MemberLayout& Member = Layout->Members[Node.CachedMember];
+		Node.Item = MakePropertyItem(Layout->GetMemberPtr(Member, Container.Ptr), Member.Prop);
+		Node.Item.CachedName = Member.Name;
+		Node.Item.Tag = Member.Tag;
+		return true;
+	}
+
+	if (Node.Index < 0)
+		return false;
+
+	if (Tag == Tag_Array) {
+		FArrayProperty* ArrayProp = (FArrayProperty*)Container.Prop;
+		FScriptArrayHelper Helper(ArrayProp, Container.Ptr);
+		if (Node.MapPart || Node.Index >= Helper.Num())
+			return false;
+
+		PropertyTag MemberTag = GetPropertyTag(ArrayProp->Inner);
+		void* MemberPtr = Helper.GetRawPtr(Node.Index);
+		if (TagHasFlag(MemberTag, TagFlag_Object))
+			MemberPtr = ((FObjectProperty*)ArrayProp->Inner)->GetObjectPropertyValue(MemberPtr);
+
+		Node.Item = MakeArrayItem(MemberPtr, ArrayProp->Inner, Node.Index);
+		Node.Item.Tag = MemberTag;
+		return true;
+	}
+
+	if (Tag == Tag_Map) {
+		FScriptMapHelper Helper((FMapProperty*)Container.Prop, Container.Ptr);
+		if (!Node.MapPart || Node.Index >= Helper.Num())
+			return false;
+
+		bool IsKey = Node.MapPart == 1;
+		FProperty* MemberProp = IsKey ? Helper.GetKeyProperty() : Helper.GetValueProperty();
+		void* MemberPtr = IsKey ? (void*)Helper.GetKeyPtr(Node.Index) : ContainerToValuePointer(PointerType::Map, Helper.GetValuePtr(Node.Index), MemberProp);
+
+		Node.Item = MakeArrayItem(MemberPtr, MemberProp, Node.Index);
+		Node.Item.Tag = GetPropertyTag(MemberProp);
+		TMem.Append(&Node.Item.NameOverwrite, IsKey ? " Key" : " Value");
+		return true;
+	}
+
+	if (Tag == Tag_Set) {
+		FScriptSetHelper Helper((FSetProperty*)Container.Prop, Container.Ptr);
+		if (Node.MapPart || Node.Index >= Helper.Num())
+			return false;
+
+		FProperty* MemberProp = Helper.GetElementProperty();
+		Node.Item = MakeArrayItem(ContainerToValuePointer(PointerType::Array, Helper.Set->GetData(Node.Index, Helper.SetLayout), MemberProp), MemberProp, Node.Index);
+		Node.Item.Tag = GetPropertyTag(MemberProp);
+		return true;
+	}
+
+	return false;
+}
+
+void WatchPathResolver::InvalidateMembers() {
+	for (auto& Node : Nodes) {
+		Node.CachedStruct = 0;
+		Node.ResolvedFrame = 0;
+	}
+}
+
+// A collected struct's address can come back as another struct, the cached member index wouldn't fit it.
+void WatchPathResolver::InvalidateStructs(const TSet<const void*>& Collected) {
+	for (auto& Node : Nodes) {
+		if (Node.CachedStruct && Collected.Contains(Node.CachedStruct)) {
+			Node.CachedStruct = 0;
+			Node.ResolvedFrame = 0;
+		}
+	}
+}
+
+// Closest object on the path, if the value lives inside of it. Values in containers or behind pointers of structs
+// can move while the object stays alive.
+UObject* WatchPathResolver::FindOwner(const FString& PathString, void* Ptr) {
+	int* NodeIndex = PathNodes.Find(PathString);
+	if (!NodeIndex || !Ptr)
+		return 0;
+
+	for (int i = Nodes[*NodeIndex].Parent; i > 0; i = Nodes[i].Parent) {
+		if (!Nodes[i].Found)
+			return 0;
+
+		if (UObject* Object = GetItemObject(Nodes[i].Item)) {
+			SIZE_T Offset = (char*)Ptr - (char*)Object;
+			return Ptr >= (void*)Object && Offset < (SIZE_T)Object->GetClass()->GetStructureSize() ? Object : 0;
+		}
+	}
+	return 0;
+}
+
+void WatchPathResolver::Clear() {
+	Nodes.Empty();
+	PathNodes.Empty();
+	RootLookup.Empty();
+	RootsHash = 0;
+}
+
+// -------------------------------------------------------------------------------------------
+
+void SampleRing::CopySince(double MinTime, TempArray<Sample>& Out) {
+	uint32 End = Head.load(std::memory_order_acquire);
+	uint32 Start = End - FMath::Min(End, Capacity);
+
+	// Samples are in time order, so walk back to the first one in range.
+	uint32 First = End;
+	while (First > Start && Samples[(First - 1) & (Capacity - 1)].Time >= MinTime)
+		First--;
+
+	Out.SetNumUninitialized(End - First);
+	for (uint32 i = First; i < End; i++)
+		Out[i - First] = Samples[i & (Capacity - 1)];
+
+	// The producer might have wrapped around while we were copying, the slot it writes next isn't safe either.
+	int64 SafeStart = (int64)Head.load(std::memory_order_acquire) + 1 - Capacity;
+	if ((int64)First < SafeStart)
+		Out.RemoveAt(0, (int)FMath::Min<int64>(SafeStart - First, Out.Num()), false);
+}
+
+bool GetSampleProperties(FProperty* Prop, FNumericProperty*& Numeric, FBoolProperty*& Bool) {
+	Numeric = 0;
+	Bool = 0;
+	if (FEnumProperty* EnumProp = CastField<FEnumProperty>(Prop))
+		Numeric = EnumProp->GetUnderlyingProperty();
+	else if (FNumericProperty* NumProp = CastField<FNumericProperty>(Prop))
+		Numeric = NumProp;
+	else
+		Bool = CastField<FBoolProperty>(Prop);
+
+	return Numeric || Bool;
+}
+
+void WatchSamplerTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) {
+	Sampler.Tick();
+}
+
+void WatchSampler::Update(UWorld* _World) {
+	if (!Enabled)
+		Capture.Stop();
+
+	UWorld* Target = Enabled ? _World : 0;
+	bool Registered = TickFunction.IsTickFunctionRegistered();
+	if (World.Get() == Target && Registered == (Target != 0) && (!Registered || TickFunction.TickGroup == TickGroup))
+		return;
+
+	Unbind();
+	if (Target)
+		Bind(Target);
+}
+
+void WatchSampler::Bind(UWorld* _World) {
+	World = _World;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = true;
+	TickFunction.TickGroup = TickGroup;
+	TickFunction.RegisterTickFunction(_World->PersistentLevel);
+
+	// Tick functions have to be gone before their level is. A running capture ends with the world.
+	WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddLambda([this](UWorld* InWorld, bool bSessionEnded, bool bCleanupResources) {
+		if (InWorld == World.Get()) {
+			Capture.Stop();
+			Unbind();
+		}
+	});
+}
+
+void WatchSampler::Unbind() {
+	if (TickFunction.IsTickFunctionRegistered())
+		TickFunction.UnRegisterTickFunction();
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+	World = 0;
+}
+
+void WatchSampler::Tick() {
+	SCOPE_EVENT("PropertyWatcher::WatchSampler::Tick");
+
+	uint64 StartCycles = FPlatformTime::Cycles64();
+	double Time = FPlatformTime::Seconds();
+	int CaptureRow = Capture.IsCapturing ? Capture.BeginRow(Time) : -1;
+	for (auto& It : Watches) {
+		SampledWatch& Watch = *It.Value;
+		UObject* Owner = Watch.Offset >= 0 ? Watch.Owner.Get() : 0;
+		if (!Owner && !(Owner = RebindStale(Watch, Time)))
+			continue;
+
+		void* Ptr = (char*)Owner + Watch.Offset;
+		double Value;
+		int64 IntValue;
+		if (Watch.Bool) {
+			IntValue = Watch.Bool->GetPropertyValue(Ptr) ? 1 : 0;
+			Value = (double)IntValue;
+		} else if (Watch.Numeric->IsFloatingPoint()) {
+			Value = Watch.Numeric->GetFloatingPointPropertyValue(Ptr);
+			IntValue = (int64)Value;
+		} else {
+			IntValue = Watch.Numeric->GetSignedIntPropertyValue(Ptr);
+			Value = (double)IntValue;
+		}
+
+		Watch.Ring.Push(Time, Value);
+		if (CaptureRow >= 0 && Watch.CaptureColumn >= 0)
+			Capture.SetValue(CaptureRow, Watch.CaptureColumn, Value, IntValue);
+	}
+	if (CaptureRow >= 0)
+		Capture.EndRow();
+	LastTickUs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0;
+}
+
+SampledWatch* WatchSampler::Find(const FString& Path) {
+	TUniquePtr<SampledWatch>* Watch = Watches.Find(Path);
+	return Watch ? Watch->Get() : 0;
+}
+
+void WatchSampler::SetSampled(const FString& Path, bool Sampled) {
+	if (Sampled)
+		Watches.Add(Path, MakeUnique<SampledWatch>())->CaptureColumn = Capture.IsCapturing ? Capture.FindColumn(Path) : -1;
+	else
+		Watches.Remove(Path);
+}
+
+void WatchSampler::BindWatch(SampledWatch& Watch, MemberPath& Member) {
+	PropertyItem& Item = Member.CachedItem;
+	UObject* Owner = 0;
+	if (Item.Ptr && Item.Prop && Item.Type == PointerType::Property && GetSampleProperties(Item.Prop, Watch.Numeric, Watch.Bool))
+		Owner = WatchPaths.FindOwner(Member.PathString, Item.Ptr);
+
+	// The watch tab knows best, whatever it can't resolve doesn't get rebound by the tick either.
+	if (!Owner) {
+		Watch.Owner = 0;
+		Watch.Offset = -1;
+		Watch.OwnerOffset = -1;
+		return;
+	}
+
+	if (Watch.Owner.Get() != Owner) {
+		Watch.OwnerPath = FSoftObjectPath(Owner);
+		Watch.OwnerClass = Owner->GetClass();
+	}
+	Watch.Owner = Owner;
+	Watch.Offset = (char*)Item.Ptr - (char*)Owner;
+	Watch.OwnerOffset = Watch.Offset;
+	Watch.OwnerProp = Item.Prop;
+}
+
+// Owner went away between two binds from the watch tab, e.g. a level got reloaded or an actor respawned while the
+// window is closed, or the binding got invalidated. Takes the object that now has the same path if it's still of the
+// same class, its property is then still the same as well. Checked a few times a second.
+UObject* WatchSampler::RebindStale(SampledWatch& Watch, double Time) {
+	if (Watch.OwnerOffset < 0 || Time < Watch.NextRebindTime)
+		return 0;
+
+	Watch.NextRebindTime = Time + 0.25;
+	UClass* Class = Watch.OwnerClass.Get();
+	UObject* Owner = Class ? Watch.OwnerPath.ResolveObject() : 0;
+	if (!Owner || Owner->GetClass() != Class || !IsValid(Owner))
+		return 0;
+	if (!GetSampleProperties(Watch.OwnerProp, Watch.Numeric, Watch.Bool))
+		return 0;
+
+	Watch.Owner = Owner;
+	Watch.Offset = Watch.OwnerOffset;
+	return Owner;
+}
+
+void WatchSampler::RemoveUnseen(uint64 Frame) {
+	for (auto It = Watches.CreateIterator(); It; ++It)
+		if (It->Value->SeenFrame != Frame)
+			It.RemoveCurrent();
+}
+
+// Properties can go away with a reload. The owner path and offset are kept, the tick binds again right away if the
+// owner's class is still the same, otherwise it waits for the watch tab.
+void WatchSampler::InvalidateBindings() {
+	for (auto& It : Watches) {
+		It.Value->Offset = -1;
+		It.Value->Owner = 0;
+		It.Value->Numeric = 0;
+		It.Value->Bool = 0;
+		It.Value->NextRebindTime = 0;
+	}
+}
+
+// -------------------------------------------------------------------------------------------
+
+void ByteWriter::VarInt(uint64 Value) {
+	while (Value >= 0x80) {
+		U8((uint8)(Value | 0x80));
+		Value >>= 7;
+	}
+	U8((uint8)Value);
+}
+
+// Control byte with the count of zero bytes on top and bottom, then the bytes in between. 0xFF if nothing changed.
+void ByteWriter::XorFloat(uint64 Bits, uint64 Prev) {
+	uint64 Xor = Bits ^ Prev;
+	if (!Xor) {
+		U8(0xFF);
+		return;
+	}
+
+	int Leading = (int)FMath::CountLeadingZeros64(Xor) / 8;
+	int Trailing = (int)FMath::CountTrailingZeros64(Xor) / 8;
+	U8((uint8)(Leading << 4 | Trailing));
+	for (int i = Trailing; i < 8 - Leading; i++)
+		U8((uint8)(Xor >> (i * 8)));
+}
+
+const uint8* ByteReader::Skip(int64 Count) {
+	if (Failed || Count < 0 || Count > End - Ptr) {
+		Failed = true;
+		return 0;
+	}
+	const uint8* Data = Ptr;
+	Ptr += Count;
+	return Data;
+}
+
+bool ByteReader::Bytes(void* Data, int64 Count) {
+	const uint8* Src = Skip(Count);
+	if (Src)
+		FMemory::Memcpy(Data, Src, Count);
+	return Src != 0;
+}
+
+uint64 ByteReader::VarInt() {
+	uint64 Value = 0;
+	for (int Shift = 0; Shift < 64; Shift += 7) {
+		uint8 Byte = U8();
+		Value |= (uint64)(Byte & 0x7F) << Shift;
+		if (!(Byte & 0x80))
+			return Value;
+	}
+	Failed = true;
+	return Value;
+}
+
+uint64 ByteReader::XorFloat(uint64 Prev) {
+	uint8 Control = U8();
+	if (Control == 0xFF)
+		return Prev;
+
+	int Leading = Control >> 4;
+	int Trailing = Control & 0xF;
+	if (Leading + Trailing >= 8) {
+		Failed = true;
+		return Prev;
+	}
+
+	uint64 Xor = 0;
+	for (int i = Trailing; i < 8 - Leading; i++)
+		Xor |= (uint64)U8() << (i * 8);
+	return Prev ^ Xor;
+}
+
+bool CaptureWriter::Start(FString& Error) {
+	if (IsCapturing)
+		return true;
+	if (!Sampler.Watches.Num()) {
+		Error = TEXT("No sampled watches to capture.");
+		return false;
+	}
+
+	FilePath = FPaths::ProjectSavedDir() / TEXT("PropertyWatcher") / FString::Printf(TEXT("Capture-%s.pwcap"), *FDateTime::Now().ToString());
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+	File.Reset(PlatformFile.OpenWrite(*FilePath));
+	if (!File) {
+		Error = FString::Printf(TEXT("Couldn't open %s for writing."), *FilePath);
+		return false;
+	}
+
+	Columns.Empty();
+	for (auto& It : Sampler.Watches) {
+		SampledWatch& Watch = *It.Value;
+		Watch.CaptureColumn = Columns.Num();
+		Columns.Add({ It.Key, !Watch.Numeric || Watch.Numeric->IsFloatingPoint() }); // Unbound watches are stored as floats.
+	}
+
+	for (CaptureBlock& Block : Blocks) {
+		Block.RowCount = 0;
+		Block.Times.SetNumUninitialized(BlockRows);
+		Block.Values.SetNumUninitialized(BlockRows * Columns.Num());
+		Block.Valid.SetNumZeroed(BlockRows * Columns.Num());
+	}
+
+	TArray<uint8> Header;
+	ByteWriter Writer = { Header };
+	Writer.Bytes(FileMagic, 8);
+	Writer.U32(Version);
+	Writer.U32(BlockRows);
+	Writer.U32(Columns.Num());
+	for (CaptureColumn& Column : Columns) {
+		FTCHARToUTF8 Path(*Column.Path);
+		Writer.U8(Column.IsFloat ? 1 : 0);
+		Writer.VarInt(Path.Length());
+		Writer.Bytes(Path.Get(), Path.Length());
+	}
+	File->Write(Header.GetData(), Header.Num());
+
+	CurrentBlock = 0;
+	StartTime = FPlatformTime::Seconds();
+	BlocksSinceKeyframe = KeyframeInterval;
+	ForceKeyframe = false;
+	RowsWritten = 0;
+	DroppedBlocks = 0;
+	BytesWritten = Header.Num();
+	IsCapturing = true;
+	PreExitHandle = FCoreDelegates::OnPreExit.AddLambda([this]() { Stop(); });
+	return true;
+}
+
+void CaptureWriter::Stop() {
+	if (!IsCapturing)
+		return;
+
+	IsCapturing = false;
+	FCoreDelegates::OnPreExit.Remove(PreExitHandle);
+	if (PendingWrite.IsValid())
+		PendingWrite.Wait();
+	Submit();
+	if (PendingWrite.IsValid())
+		PendingWrite.Wait();
+	PendingWrite = {};
+	File.Reset();
+
+	for (auto& It : Sampler.Watches)
+		It.Value->CaptureColumn = -1;
+}
+
+void CaptureWriter::Submit() {
+	CaptureBlock& Block = Blocks[CurrentBlock];
+	if (!Block.RowCount)
+		return;
+
+	if (PendingWrite.IsValid() && !PendingWrite.IsReady()) {
+		DroppedBlocks++;
+		ForceKeyframe = true;
+		Block.RowCount = 0;
+		return;
+	}
+
+	RowsWritten += Block.RowCount;
+	PendingWrite = Async(EAsyncExecution::ThreadPool, [this, &Block]() {
+		EncodeBlock(Block);
+		File->Write(Encoded.GetData(), Encoded.Num());
+		BytesWritten += Encoded.Num();
+		Block.RowCount = 0;
+	});
+	CurrentBlock ^= 1;
+}
+
+void CaptureWriter::EncodeBlock(CaptureBlock& Block) {
+	SCOPE_EVENT("PropertyWatcher::CaptureWriter::EncodeBlock");
+
+	bool Keyframe = ForceKeyframe.exchange(false) || BlocksSinceKeyframe >= KeyframeInterval;
+	if (Keyframe) {
+		BlocksSinceKeyframe = 0;
+		PrevTime = 0;
+		Prev.Init(0, Columns.Num());
+	}
+	BlocksSinceKeyframe++;
+
+	Encoded.Reset();
+	ByteWriter Writer = { Encoded };
+	Writer.U32(BlockMagic);
+	Writer.U32(Block.RowCount);
+	Writer.U8(Keyframe ? 1 : 0);
+	int SizeOffset = Encoded.Num();
+	Writer.U32(0); // Payload size, filled in at the end.
+
+	for (int Row = 0; Row < Block.RowCount; Row++) {
+		int64 Time = (int64)(Block.Times[Row] * 1000000.0);
+		Writer.ZigZag(Time - PrevTime);
+		PrevTime = Time;
+	}
+
+	int ColumnCount = Columns.Num();
+	for (int Column = 0; Column < ColumnCount; Column++) {
+		int BitmapOffset = Encoded.Num();
+		Encoded.AddZeroed((Block.RowCount + 7) / 8);
+		for (int Row = 0; Row < Block.RowCount; Row++)
+			if (Block.Valid[Row * ColumnCount + Column])
+				Encoded[BitmapOffset + Row / 8] |= 1 << (Row & 7);
+
+		bool IsFloat = Columns[Column].IsFloat;
+		for (int Row = 0; Row < Block.RowCount; Row++) {
+			int Index = Row * ColumnCount + Column;
+			if (!Block.Valid[Index])
+				continue;
+
+			uint64 Value = Block.Values[Index];
+			if (IsFloat)
+				Writer.XorFloat(Value, Prev[Column]);
+			else
+				Writer.ZigZag((int64)(Value - Prev[Column]));
+			Prev[Column] = Value;
+		}
+	}
+
+	uint32 PayloadSize = Encoded.Num() - SizeOffset - sizeof(uint32);
+	FMemory::Memcpy(&Encoded[SizeOffset], &PayloadSize, sizeof(PayloadSize));
+}
+
+int CaptureWriter::FindColumn(const FString& Path) {
+	return Columns.IndexOfByPredicate([&Path](const CaptureColumn& Column) { return Column.Path == Path; });
+}
+
+// Time in seconds, then one column per watch. Rows where a watch wasn't bound stay empty.
+bool ExportCaptureToCsv(const FString& CapturePath, const FString& CsvPath, FString& Error) {
+	SCOPE_EVENT("PropertyWatcher::ExportCaptureToCsv");
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *CapturePath)) {
+		Error = FString::Printf(TEXT("Couldn't read %s."), *CapturePath);
+		return false;
+	}
+
+	ByteReader Reader = { Data.GetData(), Data.GetData() + Data.Num() };
+	char Magic[8] = {};
+	Reader.Bytes(Magic, 8);
+	uint32 Version = Reader.U32();
+	uint32 BlockRows = Reader.U32();
+	uint32 ColumnCount = Reader.U32();
+	if (Reader.Failed || FMemory::Memcmp(Magic, CaptureWriter::FileMagic, 8) != 0 || Version != CaptureWriter::Version) {
+		Error = TEXT("Not a capture file, or a different version.");
+		return false;
+	}
+	// Every column takes at least two header bytes, and a block has to fit the int indices below.
+	if (BlockRows == 0 || BlockRows > (uint32)CaptureWriter::BlockRows || ColumnCount > (uint64)(Reader.End - Reader.Ptr) / 2 ||
+		(uint64)BlockRows * ColumnCount > MAX_int32) {
+		Error = TEXT("Corrupt capture file header.");
+		return false;
+	}
+
+	TAnsiStringBuilder<4096> Csv;
+	Csv << "time";
+	TArray<bool> IsFloat;
+	for (uint32 Column = 0; Column < ColumnCount && !Reader.Failed; Column++) {
+		IsFloat.Add(Reader.U8() != 0);
+		uint64 Len = Reader.VarInt();
+		const uint8* Path = Reader.Skip(Len);
+		if (!Path)
+			break;
+
+		Csv << ",\"";
+		for (const uint8* It = Path; It < Path + Len; It++) {
+			if (*It == '"')
+				Csv << '"';
+			Csv << (ANSICHAR)*It;
+		}
+		Csv << '"';
+	}
+	Csv << '\n';
+
+	TArray<int64> Times;
+	TArray<uint64> Values, Prev;
+	TArray<bool> Valid;
+	int64 PrevTime = 0;
+	bool HadKeyframe = false;
+	while (!Reader.Failed && Reader.Ptr < Reader.End) {
+		uint32 BlockMagic = Reader.U32();
+		uint32 RowCount = Reader.U32();
+		bool Keyframe = Reader.U8() & 1;
+		uint32 PayloadSize = Reader.U32();
+		if (Reader.Failed || BlockMagic != CaptureWriter::BlockMagic || RowCount > BlockRows) {
+			Reader.Failed = true;
+			break;
+		}
+		if (PayloadSize > Reader.End - Reader.Ptr)
+			break; // Capture that didn't get stopped, the last block is cut off.
+
+		const uint8* BlockEnd = Reader.Ptr + PayloadSize;
+		if (Keyframe) {
+			HadKeyframe = true;
+			PrevTime = 0;
+			Prev.Init(0, ColumnCount);
+		}
+		if (!HadKeyframe) {
+			Reader.Ptr = BlockEnd;
+			continue;
+		}
+
+		Times.SetNumUninitialized(RowCount);
+		for (uint32 Row = 0; Row < RowCount; Row++) {
+			PrevTime += Reader.ZigZag();
+			Times[Row] = PrevTime;
+		}
+
+		Values.SetNumUninitialized(RowCount * ColumnCount);
+		Valid.SetNumUninitialized(RowCount * ColumnCount);
+		for (uint32 Column = 0; Column < ColumnCount && !Reader.Failed; Column++) {
+			const uint8* Bitmap = Reader.Skip((RowCount + 7) / 8);
+			if (!Bitmap)
+				break;
+
+			for (uint32 Row = 0; Row < RowCount; Row++) {
+				int Index = Row * ColumnCount + Column;
+				Valid[Index] = (Bitmap[Row / 8] >> (Row & 7)) & 1;
+				if (!Valid[Index])
+					continue;
+
+				Prev[Column] = IsFloat[Column] ? Reader.XorFloat(Prev[Column]) : Prev[Column] + (uint64)Reader.ZigZag();
+				Values[Index] = Prev[Column];
+			}
+		}
+		if (Reader.Failed || Reader.Ptr != BlockEnd) {
+			Reader.Failed = true;
+			break;
+		}
+
+		for (uint32 Row = 0; Row < RowCount; Row++) {
+			Csv.Appendf("%.6f", Times[Row] / 1000000.0);
+			for (uint32 Column = 0; Column < ColumnCount; Column++) {
+				int Index = Row * ColumnCount + Column;
+				Csv << ',';
+				if (!Valid[Index])
+					continue;
+
+				if (IsFloat[Column]) {
+					double Value;
+					FMemory::Memcpy(&Value, &Values[Index], sizeof(Value));
+					Csv.Appendf("%.17g", Value);
+				} else
+					Csv.Appendf("%lld", (long long)Values[Index]);
+			}
+			Csv << '\n';
+		}
+	}
+
+	if (Reader.Failed) {
+		Error = FString::Printf(TEXT("Corrupt capture file at byte %d."), (int)(Reader.Ptr - Data.GetData()));
+		return false;
+	}
+	if (!FFileHelper::SaveArrayToFile(TArrayView<const uint8>((const uint8*)Csv.GetData(), Csv.Len()), *CsvPath)) {
+		Error = FString::Printf(TEXT("Couldn't write %s."), *CsvPath);
+		return false;
+	}
+	return true;
+}
+
+void ExportCaptureCommand(const TArray<FString>& Args) {
+	if (!Args.Num()) {
+		UE_LOG(LogTemp, Warning, TEXT("PropertyWatcher.Capture.ExportCsv: missing capture file."));
+		return;
+	}
+
+	FString CsvPath = Args.Num() > 1 ? Args[1] : FPaths::ChangeExtension(Args[0], TEXT("csv"));
+	FString Error;
+	if (ExportCaptureToCsv(Args[0], CsvPath, Error))
+		UE_LOG(LogTemp, Display, TEXT("PropertyWatcher capture exported to %s"), *CsvPath);
+	else
+		UE_LOG(LogTemp, Warning, TEXT("PropertyWatcher capture export failed: %s"), *Error);
+}
+
+static FAutoConsoleCommand ExportCaptureConsoleCommand(
+	TEXT("PropertyWatcher.Capture.ExportCsv"),
+	TEXT("Converts a watch capture file to csv. Arguments: <capture file> [csv file], the csv goes next to the capture by default."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ExportCaptureCommand));
+
+FString ConvertWatchedMembersToString(TArray<MemberPath>& WatchedMembers) {
+	TArray<FString> Strings;
+	for (auto It : WatchedMembers)
+		Strings.Push(It.PathString);
+
+	FString Result = FString::Join(Strings, TEXT(","));
+	return Result;
+}
+
+void LoadWatchedMembersFromString(FString Data, TArray<MemberPath>& WatchedMembers) {
+	WatchedMembers.Empty();
+
+	TArray<FString> Strings;
+	Data.ParseIntoArray(Strings, TEXT(","));
+	for (auto It : Strings) {
+		MemberPath Path = {};
+		Path.PathString = It;
+
+		WatchedMembers.Push(Path);
+	}
+}
+
+// -------------------------------------------------------------------------------------------
+
+FName PropertyItem::GetName() {
+	if (Type == PointerType::Property && Prop)
+		return Prop->GetFName();
+
+	if (Type == PointerType::Object && Ptr)
+		return ((UObject*)Ptr)->GetFName();
+
+	if (StructPtr && (Type == PointerType::Struct || Type == PointerType::Function))
+		return StructPtr->GetFName();
+		//return StructPtr->GetAuthoredName();
+
+	return NAME_None;
+}
+
+FAView PropertyItem::GetAuthoredName() {
+	if (!NameOverwrite.IsEmpty())
+		return NameOverwrite;
+	if (!CachedName.IsEmpty())
+		return CachedName;
+	return NameTable.Get(GetName());
+}
+
+//FString PropertyItem::GetDisplayName() {
+//	FString Result = GetAuthoredName();
+//	if (Type == PointerType::Property && CastField<FObjectProperty>(Prop) && Ptr)
+//		Result = FString::Printf(TEXT("%s (%s)"), *Result, *((UObject*)Ptr)->GetName());
+//
+//	return Result;
+//}
+
+bool PropertyItem::IsExpandable() {
+	if (!IsValid())
+		return false;
+
+	if (!Ptr || Type == PointerType::Function)
+		return false;
+
+	if (Type == PointerType::Object || Type == PointerType::Struct)
+		return true;
+
+	return TagHasFlag(GetTag(), TagFlag_Expandable);
+}
+
+FAView PropertyItem::GetPropertyType() {
+	FAView Result = "";
+	if (Type == PointerType::Property && Prop)
+		Result = DisplayTexts.Get(Prop).Type;
+
+	else if (Type == PointerType::Object)
+		Result = "";
+
+	else if (Type == PointerType::Struct)
+		Result = "";
+
+	return Result;
+};
+
+FAView PropertyItem::GetCPPType() {
+	if (Type == PointerType::Property && Prop) 
+		return DisplayTexts.Get(Prop).CppType;
+
+	if (Type == PointerType::Struct || Type == PointerType::Function)
+		return DisplayTexts.Get(StructPtr).CppType;
+
+	if (Type == PointerType::Object && Ptr) {
+		UClass* Class = ((UObject*)Ptr)->GetClass();
+		if (Class) 
+			return NameTable.Get(Class->GetFName());
+	}
+
+	return "";
+};
+
+int PropertyItem::GetSize() {
+	if (Prop) 
+		return Prop->GetSize();
+
+	else if (Type == PointerType::Object) {
+		UClass* Class = ((UObject*)Ptr)->GetClass();
+		if (Class) 
+			return Class->GetPropertiesSize();
+
+	} else if (Type == PointerType::Struct) 
+		return StructPtr->GetPropertiesSize();
+
+	return -1;
+};
+
+int PropertyItem::GetMembers(TArray<PropertyItem>* MemberArray) {
+	SCOPE_EVENT("PropertyWatcher::GetMembers");
+
+	if (!Ptr) return 0;
+
+	int Count = 0;
+
+	auto PushLayoutMembers = [this](StructLayout* Layout, TArray<PropertyItem>* OutArray) {
+		OutArray->Reserve(OutArray->Num() + Layout->Members.Num());
+		for (auto& Member : Layout->Members) {
+			PropertyItem MemberItem = MakePropertyItem(Layout->GetMemberPtr(Member, Ptr), Member.Prop);
+			MemberItem.CachedName = Member.Name;
+			MemberItem.Tag = Member.Tag;
+			OutArray->Push(MemberItem);
+		}
+		return Layout->Members.Num();
+	};
+
+	PropertyTag ItemTag = GetTag();
+	if (Type == PointerType::Object || TagHasFlag(ItemTag, TagFlag_Object)) {
+		UClass* Class = ((UObject*)Ptr)->GetClass();
+		if (!Class) return 0;
+
+		StructLayout* Layout = GetStructLayout(Class);
+		if (!MemberArray) return Layout->Members.Num();
+		return PushLayoutMembers(Layout, MemberArray);
+
+	} else if (TagHasFlag(ItemTag, TagFlag_ObjectPointer)) {
+		UObject* Obj = 0;
+		bool IsValid = GetObjFromObjPointerProp(*this, Obj);
+		if (!IsValid) return 0;
+		else return MakeObjectItem(Obj).GetMembers(MemberArray);
+
+	} else if (ItemTag == Tag_Array) {
+		FArrayProperty* ArrayProp = (FArrayProperty*)Prop;
+		FScriptArrayHelper ScriptArrayHelper(ArrayProp, Ptr);
+
+		if (!MemberArray) return ScriptArrayHelper.Num();
+		FProperty* MemberProp = ArrayProp->Inner;
+		PropertyTag MemberTag = GetPropertyTag(MemberProp);
+		bool MemberIsObject = TagHasFlag(MemberTag, TagFlag_Object);
+
+		MemberArray->Reserve(MemberArray->Num() + ScriptArrayHelper.Num());
+		for (int i = 0; i < ScriptArrayHelper.Num(); i++) {
+			void* MemberPtr = ScriptArrayHelper.GetRawPtr(i);
+			if (MemberIsObject)
+				MemberPtr = ((FObjectProperty*)MemberProp)->GetObjectPropertyValue(MemberPtr);
+
+			PropertyItem MemberItem = MakeArrayItem(MemberPtr, MemberProp, i);
+			MemberItem.Tag = MemberTag;
+			MemberArray->Push(MemberItem);
+		}
+
+	} else if (Type == PointerType::Struct || TagHasFlag(ItemTag, TagFlag_Struct)) {
+		if (!StructPtr && Prop)
+			StructPtr = ((FStructProperty*)Prop)->Struct;
+
+		if (StructPtr) {
+			StructLayout* Layout = GetStructLayout(StructPtr);
+			if (!MemberArray) return Layout->Members.Num();
+			return PushLayoutMembers(Layout, MemberArray);
+		}
+
+	} else if (ItemTag == Tag_Map) {
+		FScriptMapHelper Helper = FScriptMapHelper((FMapProperty*)Prop, Ptr);
+		if (!MemberArray) return Helper.Num();
+
+		auto KeyProp = Helper.GetKeyProperty();
+		auto ValueProp = Helper.GetValueProperty();
+		PropertyTag KeyTag = GetPropertyTag(KeyProp);
+		PropertyTag ValueTag = GetPropertyTag(ValueProp);
+		for (int i = 0; i < Helper.Num(); i++) {
+			uint8* KeyPtr = Helper.GetKeyPtr(i);
+			uint8* ValuePtr = Helper.GetValuePtr(i);
+			void* ValuePtr2 = ContainerToValuePointer(PointerType::Map, ValuePtr, ValueProp);
+
+			auto KeyItem = MakeArrayItem(KeyPtr, KeyProp, i);
+			auto ValueItem = MakeArrayItem(ValuePtr2, ValueProp, i);
+			KeyItem.Tag = KeyTag;
+			ValueItem.Tag = ValueTag;
+			TMem.Append(&KeyItem.NameOverwrite, " Key");
+			TMem.Append(&ValueItem.NameOverwrite, " Value");
+			MemberArray->Push(KeyItem);
+			MemberArray->Push(ValueItem);
+		}
+
+	} else if (ItemTag == Tag_Set) {
+		FScriptSetHelper Helper = FScriptSetHelper((FSetProperty*)Prop, Ptr);
+		if (!MemberArray) return Helper.Num();
+
+		FProperty* MemberProp = Helper.GetElementProperty();
+		PropertyTag MemberTag = GetPropertyTag(MemberProp);
+		for (int i = 0; i < Helper.Num(); i++) {
+			void* MemberPtr = Helper.Set->GetData(i, Helper.SetLayout);
+			MemberPtr = ContainerToValuePointer(PointerType::Array, MemberPtr, MemberProp);
+
+			PropertyItem MemberItem = MakeArrayItem(MemberPtr, MemberProp, i);
+			MemberItem.Tag = MemberTag;
+			MemberArray->Push(MemberItem);
+		}
+
+	} else if (ItemTag == Tag_Delegate) {
+		//DelegateProp->SignatureFunction
+		auto ScriptDelegate = (TScriptDelegate<FWeakObjectPtr>*)Ptr;
+		if (!MemberArray) return ScriptDelegate->IsBound() ? 1 : 0;
+		if (ScriptDelegate->IsBound()) {
+			UFunction* Function = ScriptDelegate->GetUObject()->FindFunction(ScriptDelegate->GetFunctionName());
+			if (Function)
+				MemberArray->Push(MakeFunctionItem(ScriptDelegate->GetUObject(), Function));
+		}
+
+	} else if (ItemTag == Tag_MulticastDelegate) {
+		// We would like to call GetAllObjects(), but can't because the invocation list can be invalid and so the function call would fail.
+		// And since there is no way to check if the invocation list is invalid we can't handle this property.
+
+		//auto ScriptDelegate = (TMulticastScriptDelegate<FWeakObjectPtr>*)Ptr;
+		//if (ScriptDelegate->IsBound()) {
+		//	auto BoundObjects = ScriptDelegate->GetAllObjects();
+		//	if (!MemberArray) return BoundObjects.Num();
+
+		//	for (auto Obj : BoundObjects)
+		//		MemberArray->Push(MakeObjectItem(Obj));
+		//} else
+		//	if (!MemberArray) return 0;
+	}
+
+	return Count;
+}
+
+int PropertyItem::GetMemberCount() {
+	if (CachedMemberCount != -1)
+		return CachedMemberCount;
+
+	CachedMemberCount = GetMembers(0);
+	return CachedMemberCount;
+}
+
+void StructLayout::Build(UStruct* _Struct) {
+	SCOPE_EVENT("PropertyWatcher::StructLayout::Build");
+	PROFILE_PHASE(Phase_ReflectionWalk);
+
+	Struct = _Struct;
+	Counters.ReflectionWalks++;
+
+	// Names are interned, so views into them stay valid after the layout cache gets cleared.
+	FName CurrentOwnerName = NAME_None;
+	for (FProperty* MemberProp : TFieldRange<FProperty>(Struct)) {
+		FName OwnerName = ((FField*)MemberProp)->Owner.GetFName();
+		if (!SectionStartIndexes.Num() || OwnerName != CurrentOwnerName) {
+			CurrentOwnerName = OwnerName;
+			SectionStartIndexes.Push(Members.Num());
+			SectionNames.Push(NameTable.Get(OwnerName));
+		}
+
+		MemberLayout Member = {};
+		Member.Prop = MemberProp;
+		Member.Offset = MemberProp->GetOffset_ForInternal();
+		Member.Tag = GetPropertyTag(MemberProp);
+		Member.Kind = TagHasFlag(Member.Tag, TagFlag_Object) ? MemberKind_Object : MemberKind_Value;
+		Member.SectionIndex = SectionStartIndexes.Num() - 1;
+		Member.Name = NameTable.Get(MemberProp->GetFName());
+		Members.Push(Member);
+	}
+	SectionStartIndexes.Push(Members.Num());
+}
+
+void StructLayout::BuildFunctions() {
+	SCOPE_EVENT("PropertyWatcher::StructLayout::BuildFunctions");
+	PROFILE_PHASE(Phase_ReflectionWalk);
+
+	FunctionsBuilt = true;
+	Counters.ReflectionWalks++;
+	UClass* Class = Cast<UClass>(Struct);
+	if (!Class)
+		return;
+
+	TArray<FName> FunctionNames;
+	UClass* TempClass = Class;
+	do {
+		FunctionNames.Reset();
+		GetClassFunctionList(TempClass, FunctionNames);
+		for (auto& Name : FunctionNames) {
+			UFunction* Function = Class->FindFunctionByName(Name);
+			if (!Function)
+				continue;
+			Functions.Push(Function);
+		}
+		TempClass = TempClass->GetSuperClass();
+
+	} while (TempClass->GetSuperClass());
+
+	FName CurrentOwnerName = NAME_None;
+	for (int i = 0; i < Functions.Num(); i++) {
+		FName OwnerName = Functions[i]->GetOuterUClass()->GetFName();
+		if (!FunctionSectionStartIndexes.Num() || OwnerName != CurrentOwnerName) {
+			CurrentOwnerName = OwnerName;
+			FunctionSectionNames.Push(NameTable.Get(OwnerName));
+			FunctionSectionStartIndexes.Push(i);
+		}
+	}
+	FunctionSectionStartIndexes.Push(Functions.Num());
+}
+
+StructLayout* GetStructLayout(UStruct* Struct) {
+	static bool DelegatesRegistered = false;
+	if (!DelegatesRegistered) {
+		DelegatesRegistered = true;
+		FCoreUObjectDelegates::ReloadCompleteDelegate.AddLambda([](EReloadCompleteReason) { ClearReflectionCaches(); });
+		FCoreUObjectDelegates::GetPostGarbageCollect().AddStatic(&PruneReflectionCaches);
+	}
+
+	TUniquePtr<StructLayout>& Layout = StructLayoutCache.FindOrAdd(Struct);
+	if (!Layout) {
+		Layout = MakeUnique<StructLayout>();
+		Layout->Build(Struct);
+		TrackReflectionKey(Struct, Struct);
+	}
+	return Layout.Get();
+}
+
+void ClearReflectionCaches() {
+	StructLayoutCache.Empty();
+	PropertyTagCache.Empty();
+	ReflectionCacheOwners.Empty();
+	DisplayTexts.Clear();
+	WatchPaths.InvalidateMembers();
+	Sampler.InvalidateBindings();
+	NodeCache.InvalidateChildren(); // Also rebuilds flattened rows, they can hold functions.
+}
+
+// Runs after every garbage collection, only what belonged to collected structs, properties and enums gets dropped.
+void PruneReflectionCaches() {
+	SCOPE_EVENT("PropertyWatcher::PruneReflectionCaches");
+
+	TSet<const void*> Collected;
+	for (auto It = ReflectionCacheOwners.CreateIterator(); It; ++It) {
+		if (!It->Value.IsValid()) {
+			Collected.Add(It->Key);
+			It.RemoveCurrent();
+		}
+	}
+
+	for (const void* Key : Collected) {
+		StructLayoutCache.Remove((UStruct*)Key);
+		PropertyTagCache.Remove((FProperty*)Key);
+		DisplayTexts.Remove(Key);
+	}
+	if (Collected.Num())
+		WatchPaths.InvalidateStructs(Collected);
+	NodeCache.InvalidateCollected();
+}
+
+FAView DisplayTextCache::Store(const TCHAR* Text, int Len) {
+	if (!Storage.IsInitialized)
+		Storage.Init(16 * 1024);
+	return Storage.CToA(Text, Len);
+}
+
+FieldTexts& DisplayTextCache::Get(FProperty* Prop) {
+	if (FieldTexts* Found = Properties.Find(Prop))
+		return *Found;
+
+	FieldTexts& Texts = Properties.Add(Prop);
+	TrackReflectionKey(Prop, Prop->GetOwnerUObject());
+	Texts.Type = NameTable.Get(Prop->GetClass()->GetFName());
+	Texts.CppType = Store(Prop->GetCPPType());
+	Texts.Class = NameTable.Get(((FField*)Prop)->Owner.GetFName());
+	Texts.Category = "";
+	Texts.Metadata = "";
+
+#if MetaData_Available
+	if (const TMap<FName, FString>* MetaData = Prop->GetMetaDataMap()) {
+		if (const FString* Value = MetaData->Find("Category"))
+			Texts.Category = Store(*Value);
+
+		TStringBuilder<256> Builder;
+		int i = -1;
+		for (auto& It : *MetaData) {
+			i++;
+			if (i != 0)
+				Builder.Append("\n\n");
+			Builder.Appendf(TEXT("%s:\n\t"), *It.Key.ToString());
+			Builder.Append(It.Value);
+		}
+		if (Builder.Len())
+			Texts.Metadata = Store(*Builder, Builder.Len());
+	}
+#endif
+
+	return Texts;
+}
+
+FieldTexts& DisplayTextCache::Get(UStruct* Struct) {
+	if (FieldTexts* Found = Structs.Find(Struct))
+		return *Found;
+
+	FieldTexts& Texts = Structs.Add(Struct);
+	TrackReflectionKey(Struct, Struct);
+	Texts = { "", "", "", "", "" };
+
+	// Do we really have to do this? Is there no engine function?
+	if (UFunction* Function = Cast<UFunction>(Struct)) {
+		FProperty* ReturnProp = Function->GetReturnProperty();
+		FString ts = ReturnProp ? ReturnProp->GetCPPType() : "void";
+
+		ts += TEXT(" (");
+		int i = 0;
+		for (FProperty* MemberProp : TFieldRange<FProperty>(Function)) {
+			if (MemberProp == ReturnProp) continue;
+			if (i == 1) ts += TEXT(", ");
+			ts += MemberProp->GetCPPType();
+			i++;
+		}
+		ts += TEXT(")");
+
+		Texts.CppType = Store(ts);
+		if (UClass* Class = Function->GetOuterUClass())
+			Texts.Class = NameTable.Get(Class->GetFName());
+
+	} else if (UScriptStruct* ScriptStruct = Cast<UScriptStruct>(Struct))
+		Texts.CppType = Store(ScriptStruct->GetStructCPPName());
+
+	return Texts;
+}
+
+FAView DisplayTextCache::GetEnumComboItems(UEnum* Enum) {
+	if (FAView* Found = EnumComboItems.Find(Enum))
+		return *Found;
+
+	// Store() adds the second terminator.
+	TStringBuilder<512> Builder;
+	for (int i = 0; i < Enum->NumEnums(); i++) {
+		Builder.Append(Enum->GetNameStringByIndex(i));
+		Builder.AppendChar('\0');
+	}
+	TrackReflectionKey(Enum, Enum);
+	return EnumComboItems.Add(Enum, Store(*Builder, Builder.Len()));
+}
+
+void DisplayTextCache::Remove(const void* Key) {
+	Properties.Remove((FProperty*)Key);
+	Structs.Remove((UStruct*)Key);
+	EnumComboItems.Remove((UEnum*)Key);
+}
+
+void DisplayTextCache::Clear() {
+	Properties.Empty();
+	Structs.Empty();
+	EnumComboItems.Empty();
+	Storage.ClearAll();
+	Storage.IsInitialized = false;
+}
+
+// -------------------------------------------------------------------------------------------
+
+uint64 MakeNodeID(uint64 ParentID, const void* ContainerPtr, const void* Prop, int Index) {
+	uint64 Data[4] = { ParentID, (uint64)(UPTRINT)ContainerPtr, (uint64)(UPTRINT)Prop, (uint64)Index };
+	uint64 Result = CityHash64((const char*)Data, sizeof(Data));
+	return Result ? Result : 1; // Zero means unset.
+}
+
+void TreeNodeCache::NewFrame() {
+	FrameIndex++;
+
+	// Flattened trees that didn't see the dropped changes do a full build.
+	if (ChangedNodes.Num() > 1024) {
+		ChangedNodesStart += ChangedNodes.Num();
+		ChangedNodes.Reset();
+	}
+
+	if (FrameIndex % PruneInterval)
+		return;
+
+	// Nodes that weren't drawn in a while drop their children, and if they have no state worth keeping they get removed.
+	for (auto It = Nodes.CreateIterator(); It; ++It) {
+		TreeNode& Node = *It.Value();
+		if (FrameIndex - Node.LastUsedFrame < (uint32)PruneInterval)
+			continue;
+
+		if (!Node.IsOpen && !Node.IsInlined) {
+			It.RemoveCurrent();
+			continue;
+		}
+
+		Node.Children.Empty();
+		Node.ChildNameData.Empty();
+		Node.ChildrenValid = false;
+	}
+}
+
+// Children hold properties that can be gone after a reload, open state is kept.
+void TreeNodeCache::InvalidateChildren() {
+	for (auto& It : Nodes) {
+		It.Value->Children.Empty();
+		It.Value->ChildNameData.Empty();
+		It.Value->ChildrenValid = false;
+	}
+	StructureVersion++;
+}
+
+// After garbage collection, only children whose properties went away with their struct. Their rows get rebuilt.
+void TreeNodeCache::InvalidateCollected() {
+	for (auto& It : Nodes) {
+		TreeNode& Node = *It.Value;
+		if (!Node.Children.Num() || Node.ChildrenOwner.IsValid())
+			continue;
+
+		Node.Children.Empty();
+		Node.ChildNameData.Empty();
+		Node.ChildrenValid = false;
+		MarkChanged(Node.ID);
+	}
+}
+
+TreeNode* TreeNodeCache::FindOrAdd(uint64 ID, bool DefaultOpen) {
+	TUniquePtr<TreeNode>& Node = Nodes.FindOrAdd(ID);
+	if (!Node) {
+		Node = MakeUnique<TreeNode>();
+		Node->ID = ID;
+		Node->IsOpen = DefaultOpen;
+	}
+	Node->LastUsedFrame = FrameIndex;
+	return Node.Get();
+}
+
+TArray<PropertyItem>& TreeNodeCache::GetChildren(TreeNode& Node, PropertyItem& Item) {
+	// Flattened trees can ask for the same children multiple times per frame.
+	if (Node.ChildrenValid && Node.ChildrenFrame == FrameIndex && Node.ContainerPtr == Item.Ptr)
+		return Node.Children;
+
+	UStruct* Struct = 0;
+	if (Item.Type == PointerType::Object || TagHasFlag(Item.GetTag(), TagFlag_Object))
+		Struct = ((UObject*)Item.Ptr)->GetClass();
+	else if (Item.Type == PointerType::Struct)
+		Struct = Item.StructPtr;
+	else if (TagHasFlag(Item.GetTag(), TagFlag_Struct))
+		Struct = ((FStructProperty*)Item.Prop)->Struct;
+
+	PropertyTag ItemTag = Item.GetTag();
+	bool PointersCanBeUpdated = Struct || ItemTag == Tag_Array;
+
+	bool NeedsRefresh = !Node.ChildrenValid || !PointersCanBeUpdated ||
+		Node.ContainerPtr != Item.Ptr ||
+		Node.ContainerStruct != Struct ||
+		Node.ContainerCount != Item.GetMemberCount() ||
+		FrameIndex - Node.RefreshFrame >= (uint32)RefreshInterval;
+
+	if (NeedsRefresh) {
+		RefreshChildren(Node, Item);
+		Node.ContainerStruct = Struct;
+		return Node.Children;
+	}
+
+	// Same container as last frame, only pointers of object members and array elements can have changed.
+	if (Struct) {
+		StructLayout* Layout = GetStructLayout(Struct);
+		for (int i = 0; i < Node.Children.Num(); i++) {
+			PropertyItem& Child = Node.Children[i];
+			Child.Ptr = Layout->GetMemberPtr(Layout->Members[i], Item.Ptr);
+			Child.CachedMemberCount = -1;
+		}
+
+	} else {
+		FArrayProperty* ArrayProp = (FArrayProperty*)Item.Prop;
+		FScriptArrayHelper ScriptArrayHelper(ArrayProp, Item.Ptr);
+		bool MemberIsObject = TagHasFlag(GetPropertyTag(ArrayProp->Inner), TagFlag_Object);
+		for (int i = 0; i < Node.Children.Num(); i++) {
+			PropertyItem& Child = Node.Children[i];
+			Child.Ptr = ScriptArrayHelper.GetRawPtr(i);
+			if (MemberIsObject)
+				Child.Ptr = ((FObjectProperty*)ArrayProp->Inner)->GetObjectPropertyValue(Child.Ptr);
+			Child.CachedMemberCount = -1;
+		}
+	}
+
+	Node.ChildrenFrame = FrameIndex;
+	return Node.Children;
+}
+
+void TreeNodeCache::RefreshChildren(TreeNode& Node, PropertyItem& Item) {
+	Node.Children.Reset();
+	Item.GetMembers(&Node.Children);
+
+	Node.ContainerPtr = Item.Ptr;
+	Node.ContainerCount = Item.GetMemberCount();
+	Node.ChildrenValid = true;
+	if (Node.Children.Num()) {
+		PropertyItem& First = Node.Children[0];
+		Node.ChildrenOwner = First.Prop ? First.Prop->GetOwnerUObject() : First.StructPtr;
+	}
+	Node.RefreshFrame = FrameIndex;
+	Node.ChildrenFrame = FrameIndex;
+
+	// Names that were made with TMem have to be copied since they wouldn't survive the frame.
+	Node.ChildNameData.Reset();
+	for (auto& Child : Node.Children)
+		if (!Child.NameOverwrite.IsEmpty())
+			Node.ChildNameData.Append(Child.NameOverwrite.GetData(), Child.NameOverwrite.Len() + 1);
+
+	int NameOffset = 0;
+	uint64 Signature = Node.Children.Num();
+	for (int i = 0; i < Node.Children.Num(); i++) {
+		PropertyItem& Child = Node.Children[i];
+		if (!Child.NameOverwrite.IsEmpty()) {
+			int Len = Child.NameOverwrite.Len();
+			Child.NameOverwrite = FAView(Node.ChildNameData.GetData() + NameOffset, Len);
+			NameOffset += Len + 1;
+		}
+		// Container pointer is left out so open state survives reallocations, like imgui's name based ids.
+		Child.NodeID = MakeNodeID(Node.ID, 0, Child.Prop, i);
+		Signature += Child.NodeID;
+	}
+
+	if (Signature != Node.ChildrenSignature) {
+		Node.ChildrenSignature = Signature;
+		MarkChanged(Node.ID);
+	}
+}
+
+void FlatTree::Update(TreeState& State, TArray<PropertyItem>& _Roots, TArray<FlatCategory>& Categories) {
+	SCOPE_EVENT("PropertyWatcher::FlatTree::Update");
+
+	Roots = &_Roots;
+
+	// Cheap running hash, there can be thousands of actor roots. Changes below the roots are handled per node.
+	uint64 NewSignature = NodeCache.StructureVersion;
+	auto Add = [&NewSignature](uint64 Value) { NewSignature = (NewSignature ^ Value) * 1099511628211ull; };
+	Add(State.EnableClassCategoriesOnObjectItems | (State.ListFunctionsOnObjectItems << 1));
+	for (auto& It : Categories) {
+		Add(It.ID);
+		Add(It.End - It.Start);
+	}
+	for (auto& It : _Roots)
+		Add(It.NodeID);
+
+	bool NeedsBuild = Dirty || NewSignature != Signature || ChangeCursor < NodeCache.ChangedNodesStart;
+	if (!NeedsBuild) {
+		RecheckRows();
+		NeedsBuild = !RebuildChangedRows(State);
+	}
+
+	if (NeedsBuild) {
+		Build(State, Categories);
+		Signature = NewSignature;
+		NameDataBuilt = NameData.Num();
+	}
+
+	// Children that got refreshed while building are already in the rows.
+	ChangeCursor = NodeCache.ChangedNodesStart + NodeCache.ChangedNodes.Num();
+}
+
+// Spread out version of a periodic rebuild, every row gets looked at once per refresh interval.
+// Getting the children refreshes them when they are due and changed child lists mark their node.
+void FlatTree::RecheckRows() {
+	int Budget = FMath::Min(Rows.Num(), FMath::Max(256, Rows.Num() / NodeCache.RefreshInterval + 1));
+	for (int i = 0; i < Budget; i++) {
+		if (RecheckRow >= Rows.Num())
+			RecheckRow = 0;
+		int RowIndex = RecheckRow++;
+		FlatRow& Row = Rows[RowIndex];
+
+		// Keeps the nodes of rows that are not drawn from getting pruned.
+		if (Row.Kind == FlatRow_Section)
+			NodeCache.FindOrAdd(Row.ID);
+		if (Row.Kind != FlatRow_Item)
+			continue;
+
+		PropertyItem* Item = ResolveItem(RowIndex);
+		if (!Item)
+			continue;
+
+		if (Item->CanBeOpened() != Row.CanBeOpened) {
+			NodeCache.MarkChanged(Row.ID);
+			continue;
+		}
+
+		if (Row.IsExpanded) {
+			int StackOffset = 0;
+			PropertyItem Container = GetContainerItem(*Item, StackOffset);
+			if (Container.Ptr)
+				NodeCache.GetChildren(*NodeCache.FindOrAdd(Container.NodeID), Container);
+		}
+	}
+}
+
+// Returns false when the whole tree has to be built.
+bool FlatTree::RebuildChangedRows(TreeState& State) {
+	int ChangeCount = NodeCache.ChangedNodesStart + NodeCache.ChangedNodes.Num() - ChangeCursor;
+	if (!ChangeCount)
+		return true;
+
+	// Section names of replaced rows stay around until the next full build.
+	if (ChangeCount > MaxChangesPerFrame || NameData.Num() > NameDataBuilt * 2 + 4096)
+		return false;
+
+	SCOPE_EVENT("PropertyWatcher::FlatTree::RebuildChangedRows");
+
+	uint64* ChangedIDs = NodeCache.ChangedNodes.GetData() + (ChangeCursor - NodeCache.ChangedNodesStart);
+
+	TArray<int, TInlineAllocator<16>> Targets;
+	for (int RowIndex = 0; RowIndex < Rows.Num(); RowIndex++) {
+		FlatRow& Row = Rows[RowIndex];
+		bool Changed = false;
+		for (int i = 0; i < ChangeCount; i++)
+			Changed |= ChangedIDs[i] == Row.ID;
+		if (!Changed)
+			continue;
+
+		// Sections are rows of their item. Inlined rows depend on the item that started the inlining.
+		int Target = Row.Kind == FlatRow_Item ? RowIndex : Row.Parent;
+		while (Target != -1 && Rows[Target].InInline)
+			Target = Rows[Target].Parent;
+		if (Target == -1)
+			return false;
+		Targets.AddUnique(Target);
+	}
+
+	// Targets below other targets get rebuilt with them.
+	Targets.Sort();
+	int KeptCount = 0, KeptEnd = -1;
+	for (int Target : Targets)
+		if (Target >= KeptEnd) {
+			Targets[KeptCount++] = Target;
+			KeptEnd = Rows[Target].SubtreeEnd;
+		}
+	Targets.SetNum(KeptCount, false);
+
+	FlatBuildContext Ctx = {};
+	Ctx.ClassSections = State.EnableClassCategoriesOnObjectItems;
+	Ctx.ListFunctions = State.ListFunctionsOnObjectItems;
+
+	// Back to front so the indexes of the remaining targets don't move.
+	for (int i = Targets.Num() - 1; i >= 0; i--)
+		if (!RebuildRows(Ctx, Targets[i]))
+			return false;
+
+	VisibleRows.Reset();
+	for (int RowIndex = 0; RowIndex < Rows.Num(); RowIndex++)
+		if (!Rows[RowIndex].IsHidden)
+			VisibleRows.Add(RowIndex);
+	return true;
+}
+
+// Replaces an item row and the rows below it, the rows after it get moved and their indexes fixed up.
+bool FlatTree::RebuildRows(FlatBuildContext& Ctx, int RowIndex) {
+	PropertyItem* ResolvedItem = ResolveItem(RowIndex);
+	if (!ResolvedItem)
+		return false;
+	PropertyItem Item = *ResolvedItem; // The row gets overwritten.
+
+	FlatRow& Row = Rows[RowIndex];
+	int Parent = Row.Parent, Index = Row.Index, StackIndex = Row.StackIndex, IndentLevel = Row.IndentLevel;
+	int OldEnd = Row.SubtreeEnd;
+
+	TArray<FlatRow> Tail(Rows.GetData() + OldEnd, Rows.Num() - OldEnd);
+	Rows.SetNum(RowIndex, false);
+	AddItemRows(Ctx, Item, Parent, Index, StackIndex, IndentLevel);
+	int Delta = Rows.Num() - OldEnd;
+
+	// Only ancestors end past the old subtree.
+	for (int i = 0; i < RowIndex; i++)
+		if (Rows[i].SubtreeEnd >= OldEnd)
+			Rows[i].SubtreeEnd += Delta;
+
+	for (auto& It : Tail) {
+		if (It.Parent >= OldEnd)
+			It.Parent += Delta;
+		if (It.SubtreeEnd >= OldEnd)
+			It.SubtreeEnd += Delta;
+	}
+	Rows.Append(MoveTemp(Tail));
+	return true;
+}
+
+void FlatTree::Build(TreeState& State, TArray<FlatCategory>& Categories) {
+	SCOPE_EVENT("PropertyWatcher::FlatTree::Build");
+
+	Rows.Reset();
+	VisibleRows.Reset();
+	NameData.Reset();
+	Dirty = false;
+	Truncated = false;
+
+	FlatBuildContext Ctx = {};
+	Ctx.ClassSections = State.EnableClassCategoriesOnObjectItems;
+	Ctx.ListFunctions = State.ListFunctionsOnObjectItems;
+
+	if (!Categories.Num()) {
+		for (int i = 0; i < Roots->Num(); i++)
+			AddItemRows(Ctx, (*Roots)[i], -1, i, 0, 0);
+		return;
+	}
+
+	for (auto& Category : Categories) {
+		bool IsOpen = true;
+		int IndentLevel = 0;
+		if (!Category.Name.IsEmpty()) {
+			int SectionRow = AddSectionRow(Ctx, Category.Name, Category.ID, true, -1, -1, 0, IsOpen);
+			Rows[SectionRow].MemberStart = Category.Start;
+			Rows[SectionRow].MemberEnd = Category.End;
+			IndentLevel = 1;
+		}
+
+		if (IsOpen)
+			for (int i = Category.Start; i < Category.End; i++)
+				AddItemRows(Ctx, (*Roots)[i], -1, i, 0, IndentLevel);
+	}
+}
+
+void FlatTree::AddItemRows(FlatBuildContext& Ctx, PropertyItem& Item, int Parent, int Index, int StackIndex, int IndentLevel) {
+	Counters.RowsVisited++;
+	if (Rows.Num() >= MaxRowCount) {
+		Truncated = true;
+		return;
+	}
+
+	bool ItemCanBeOpened = Item.CanBeOpened();
+
+	VisitedPropertyInfo Info;
+	Info.Set(Item);
+	bool ItemIsInlined = ItemCanBeOpened && Ctx.ForceInline && StackIndex <= Ctx.InlineStackIndexLimit && !IsInfiniteLooping(Ctx.VisitedStack, Info);
+
+	int RowIndex = Rows.AddDefaulted();
+	{
+		FlatRow& Row = Rows[RowIndex];
+		Row.Parent = Parent;
+		Row.Index = Index;
+		Row.ID = Item.NodeID;
+		Row.StackIndex = StackIndex;
+		Row.IndentLevel = IndentLevel;
+		Row.IsHidden = ItemIsInlined;
+		Row.InInline = Ctx.ForceInline;
+		Row.CanBeOpened = ItemCanBeOpened;
+		Row.SubtreeEnd = RowIndex + 1;
+	}
+	if (!ItemIsInlined)
+		VisibleRows.Add(RowIndex);
+
+	if (!ItemCanBeOpened)
+		return;
+
+	TreeNode* Node = NodeCache.FindOrAdd(Item.NodeID);
+	if (!ItemIsInlined && !Node->IsOpen)
+		return;
+	Rows[RowIndex].IsExpanded = true;
+
+	// Same as TreeNodeSetInline/EndTreeNode in immediate drawing.
+	bool StartInline = !ItemIsInlined && !Ctx.ForceInline && Node->IsInlined && Node->InlinedStackDepth;
+	if (StartInline) {
+		Ctx.ForceInline = true;
+		Ctx.InlineStackIndexLimit = StackIndex + Node->InlinedStackDepth;
+		Ctx.VisitedStack.Reset();
+	}
+
+	bool PushVisitedStack = Ctx.ForceInline;
+	if (PushVisitedStack)
+		Ctx.VisitedStack.Push(Info);
+
+	// Inlined items don't indent, their children take their place.
+	AddMemberRows(Ctx, Item, RowIndex, StackIndex, ItemIsInlined ? IndentLevel : IndentLevel + 1);
+
+	if (PushVisitedStack)
+		Ctx.VisitedStack.Pop(false);
+	if (StartInline)
+		Ctx.ForceInline = false;
+
+	Rows[RowIndex].SubtreeEnd = Rows.Num();
+}
+
+void FlatTree::AddMemberRows(FlatBuildContext& Ctx, PropertyItem& Item, int ItemRow, int StackIndex, int IndentLevel) {
+	int StackOffset = 0;
+	PropertyItem Container = GetContainerItem(Item, StackOffset);
+	if (!Container.Ptr)
+		return;
+	StackIndex += StackOffset;
+
+	bool ItemIsObject = TagHasFlag(Container.GetTag(), TagFlag_Object) || Container.Type == PointerType::Object;
+
+	// Members.
+	{
+		TreeNode* Node = NodeCache.FindOrAdd(Container.NodeID);
+		TArray<PropertyItem>& Members = NodeCache.GetChildren(*Node, Container);
+
+		SectionHelper SectionHelper;
+		if (Ctx.ClassSections && ItemIsObject) {
+			if (UClass* Class = ((UObject*)Container.Ptr)->GetClass())
+				SectionHelper.InitFromLayout(*GetStructLayout(Class));
+		}
+
+		if (!SectionHelper.Enabled) {
+			for (int i = 0; i < Members.Num(); i++)
+				AddItemRows(Ctx, Members[i], ItemRow, i, StackIndex + 1, IndentLevel);
+
+		} else {
+			for (int SectionIndex = 0; SectionIndex < SectionHelper.GetSectionCount(); SectionIndex++) {
+				int MemberStartIndex, MemberEndIndex;
+				FAView SectionName = SectionHelper.GetSectionInfo(SectionIndex, MemberStartIndex, MemberEndIndex);
+				MemberEndIndex = FMath::Min(MemberEndIndex, Members.Num());
+
+				bool IsOpen;
+				uint64 SectionID = MakeNodeID(Container.NodeID, 0, (void*)NodeKey_Section, SectionIndex);
+				int SectionRow = AddSectionRow(Ctx, SectionName, SectionID, SectionIndex == 0, ItemRow, StackIndex, IndentLevel, IsOpen);
+				Rows[SectionRow].MemberStart = MemberStartIndex;
+				Rows[SectionRow].MemberEnd = MemberEndIndex;
+
+				if (IsOpen)
+					for (int MemberIndex = MemberStartIndex; MemberIndex < MemberEndIndex; MemberIndex++)
+						AddItemRows(Ctx, Members[MemberIndex], ItemRow, MemberIndex, StackIndex + 1, IndentLevel);
+			}
+		}
+	}
+
+	// Functions.
+	if (Ctx.ListFunctions && ItemIsObject) {
+		StructLayout* FunctionLayout = GetFunctionLayout((UObject*)Container.Ptr);
+		if (!FunctionLayout || !FunctionLayout->Functions.Num())
+			return;
+		TArray<UFunction*>& Functions = FunctionLayout->Functions;
+
+		bool IsOpen;
+		uint64 FunctionSectionID = MakeNodeID(Container.NodeID, 0, (void*)NodeKey_Functions, 0);
+		int FunctionSectionRow = AddSectionRow(Ctx, "Functions", FunctionSectionID, false, ItemRow, StackIndex, IndentLevel, IsOpen);
+		Rows[FunctionSectionRow].MemberEnd = 0; // Nothing to force toggle.
+		if (!IsOpen)
+			return;
+
+		// Function section pushes the tree, unlike the class sections.
+		int FunctionIndentLevel = Rows[FunctionSectionRow].IsHidden ? IndentLevel : IndentLevel + 1;
+
+		auto AddFunctionRow = [&](UFunction* Function) {
+			int RowIndex = Rows.AddDefaulted();
+			FlatRow& Row = Rows[RowIndex];
+			Row.Kind = FlatRow_Function;
+			Row.Function = Function;
+			Row.Parent = ItemRow;
+			Row.ID = MakeNodeID(FunctionSectionID, 0, Function, 0);
+			Row.StackIndex = StackIndex + 1;
+			Row.IndentLevel = FunctionIndentLevel;
+			VisibleRows.Add(RowIndex);
+		};
+
+		SectionHelper SectionHelper;
+		if (Ctx.ClassSections)
+			SectionHelper.InitFromFunctions(*FunctionLayout);
+
+		if (!SectionHelper.Enabled) {
+			for (auto It : Functions)
+				AddFunctionRow(It);
+
+		} else {
+			for (int SectionIndex = 0; SectionIndex < SectionHelper.GetSectionCount(); SectionIndex++) {
+				int MemberStartIndex, MemberEndIndex;
+				FAView SectionName = SectionHelper.GetSectionInfo(SectionIndex, MemberStartIndex, MemberEndIndex);
+
+				bool SectionIsOpen;
+				uint64 SectionID = MakeNodeID(FunctionSectionID, 0, (void*)NodeKey_Section, SectionIndex);
+				int SectionRow = AddSectionRow(Ctx, SectionName, SectionID, SectionIndex == 0, ItemRow, StackIndex, FunctionIndentLevel, SectionIsOpen);
+				Rows[SectionRow].MemberEnd = 0;
+
+				if (SectionIsOpen)
+					for (int MemberIndex = MemberStartIndex; MemberIndex < MemberEndIndex; MemberIndex++)
+						AddFunctionRow(Functions[MemberIndex]);
+			}
+		}
+	}
+}
+
+int FlatTree::AddSectionRow(FlatBuildContext& Ctx, FAView Name, uint64 ID, bool DefaultOpen, int Parent, int StackIndex, int IndentLevel, bool& IsOpen) {
+	int RowIndex = Rows.AddDefaulted();
+	FlatRow& Row = Rows[RowIndex];
+	Row.Kind = FlatRow_Section;
+	Row.Parent = Parent;
+	Row.ID = ID;
+	Row.StackIndex = StackIndex;
+	Row.IndentLevel = IndentLevel;
+
+	// Section names can come from TMem or the layout cache, so they get copied.
+	Row.NameOffset = NameData.Num();
+	Row.NameLen = Name.Len();
+	NameData.Append(Name.GetData(), Name.Len());
+	NameData.Add(0);
+
+	// Sections inside of inlined items get inlined as well.
+	Row.IsHidden = Ctx.ForceInline && StackIndex <= Ctx.InlineStackIndexLimit;
+	if (!Row.IsHidden)
+		VisibleRows.Add(RowIndex);
+
+	IsOpen = Row.IsHidden || NodeCache.FindOrAdd(ID, DefaultOpen)->IsOpen;
+	return RowIndex;
+}
+
+PropertyItem* FlatTree::ResolveItem(int RowIndex) {
+	FlatRow& Row = Rows[RowIndex];
+	if (Row.ResolvedFrame == NodeCache.FrameIndex)
+		return Row.IsResolved ? &Row.Item : 0;
+
+	Row.ResolvedFrame = NodeCache.FrameIndex;
+	Row.IsResolved = false;
+
+	if (Row.Kind == FlatRow_Section)
+		return 0;
+
+	if (Row.Parent == -1) {
+		if (!Roots || !Roots->IsValidIndex(Row.Index) || (*Roots)[Row.Index].NodeID != Row.ID) {
+			Dirty = true;
+			return 0;
+		}
+		Row.Item = (*Roots)[Row.Index];
+
+	} else {
+		PropertyItem* ParentItem = ResolveItem(Row.Parent);
+		if (!ParentItem || !ParentItem->Ptr)
+			return 0;
+
+		int StackOffset = 0;
+		PropertyItem Container = GetContainerItem(*ParentItem, StackOffset);
+		if (!Container.Ptr)
+			return 0;
+
+		if (Row.Kind == FlatRow_Function) {
+			Row.Item = MakeFunctionItem(Container.Ptr, Row.Function);
+
+		} else {
+			TArray<PropertyItem>& Members = NodeCache.GetChildren(*NodeCache.FindOrAdd(Container.NodeID), Container);
+			if (!Members.IsValidIndex(Row.Index) || Members[Row.Index].NodeID != Row.ID) {
+				Dirty = true;
+				return 0;
+			}
+			Row.Item = Members[Row.Index];
+		}
+	}
+
+	Row.IsResolved = true;
+	return &Row.Item;
+}
+
+void DeepSearchState::Request(const char* SearchString, TArray<FAView> _Columns, bool _ClassSections) {
+	Clear();
+
+	Query.Append(SearchString, FCStringAnsi::Strlen(SearchString) + 1);
+	Parser.ParseExpression(FAView(Query.GetData(), Query.Num() - 1), _Columns);
+	Columns = _Columns;
+	ClassSections = _ClassSections;
+	StartRequested = true;
+}
+
+void DeepSearchState::Start(FString _TabName, TArray<PropertyItem>& Roots, TArray<FlatCategory>& Categories) {
+	SCOPE_EVENT("PropertyWatcher::DeepSearch::Start");
+
+	StartRequested = false;
+	if (!Parser.Commands.Num())
+		return;
+
+	TabName = _TabName;
+	IsRunning = true;
+
+	// Watches are mostly members, the index only takes objects as roots.
+	if (DeepSearchIndex.Enabled && TabName != "Watch") {
+		// The query runs on a task thread once there is an index for this tab, Step() picks up the results.
+		UsesIndex = true;
+		if (!DeepSearchIndex.HasIndex(TabName, ClassSections, MaxDepth) && !DeepSearchIndex.IsBuilding(TabName, ClassSections, MaxDepth))
+			DeepSearchIndex.Build(TabName, Roots, Categories, ClassSections, MaxDepth);
+		return;
+	}
+
+	// Roots are only valid this frame, so structs get searched right away and objects get queued.
+	TMem.PushMarker();
+	FString Path;
+	TArray<uint64> OpenNodeIDs;
+	if (!Categories.Num()) {
+		for (auto& Root : Roots)
+			VisitItem(Root, 0, Path, OpenNodeIDs);
+
+	} else {
+		for (auto& Category : Categories) {
+			if (!Category.Name.IsEmpty())
+				OpenNodeIDs.Push(Category.ID);
+
+			for (int i = Category.Start; i < Category.End; i++)
+				VisitItem(Roots[i], 0, Path, OpenNodeIDs);
+
+			if (!Category.Name.IsEmpty())
+				OpenNodeIDs.Pop(false);
+		}
+	}
+	TMem.PopMarker();
+}
+
+void DeepSearchState::Stop() {
+	if (UsesIndex)
+		DeepSearchIndex.PendingResults.Reset();
+
+	IsRunning = false;
+	UsesIndex = false;
+	Queue.Empty();
+	QueueIndex = 0;
+	VisitedObjects.Empty();
+}
+
+void DeepSearchState::Clear() {
+	Stop();
+	Query.Empty();
+	Parser.Commands.Empty();
+	Results.Empty();
+	CurrentResult = -1;
+	ScrollTargetID = 0;
+	StartRequested = false;
+}
+
+void DeepSearchState::Step() {
+	if (!IsRunning)
+		return;
+
+	SCOPE_EVENT("PropertyWatcher::DeepSearch::Step");
+
+	if (UsesIndex) {
+		if (DeepSearchIndex.IsQuerying()) {
+			if (DeepSearchIndex.PendingResults.IsReady()) {
+				Results = DeepSearchIndex.PendingResults.Consume();
+				Stop();
+			}
+
+		} else if (DeepSearchIndex.HasIndex(TabName, ClassSections, MaxDepth))
+			DeepSearchIndex.Query(Query, Columns, MaxResults);
+
+		else if (!DeepSearchIndex.IsBuilding(TabName, ClassSections, MaxDepth))
+			Stop(); // Build got replaced by one for another tab.
+
+		return;
+	}
+
+	double EndTime = FPlatformTime::Seconds() + BudgetMs / 1000.0;
+	while (QueueIndex < Queue.Num() && Results.Num() < MaxResults) {
+		// Queue can grow while we work on the item.
+		DeepSearchWork Work = MoveTemp(Queue[QueueIndex++]);
+
+		if (UObject* Obj = Work.Object.Get()) {
+			TMem.PushMarker();
+			PropertyItem Container = MakeObjectItem(Obj);
+			Container.NodeID = Work.NodeID;
+			VisitMembers(Container, Work.Depth, Work.Path, Work.OpenNodeIDs);
+			TMem.PopMarker();
+		}
+
+		if (FPlatformTime::Seconds() >= EndTime)
+			break;
+	}
+
+	if (QueueIndex >= Queue.Num() || Results.Num() >= MaxResults) {
+		Stop();
+
+	} else if (QueueIndex > 1024 && QueueIndex * 2 > Queue.Num()) {
+		Queue.RemoveAt(0, QueueIndex, false);
+		QueueIndex = 0;
+	}
+}
+
+void DeepSearchState::Goto(int ResultIndex) {
+	if (!Results.IsValidIndex(ResultIndex))
+		return;
+
+	CurrentResult = ResultIndex;
+	DeepSearchResult& Result = Results[ResultIndex];
+
+	// Only the path to the result gets opened.
+	for (uint64 ID : Result.OpenNodeIDs) {
+		TreeNode* Node = NodeCache.FindOrAdd(ID);
+		if (!Node->IsOpen) {
+			Node->IsOpen = true;
+			Node->ChildrenValid = false;
+		}
+	}
+	NodeCache.StructureVersion++;
+
+	ScrollTargetID = Result.RowID;
+	SelectTab = true;
+}
+
+void DeepSearchState::VisitItem(PropertyItem& Item, int Depth, FString& Path, TArray<uint64>& OpenNodeIDs) {
+	if (Results.Num() >= MaxResults)
+		return;
+
+	TMem.PushMarker();
+	defer{ TMem.PopMarker(); };
+
+	int PathLen = Path.Len();
+	defer{ Path.LeftInline(PathLen, false); };
+	{
+		FAView Name = Item.GetAuthoredName();
+		if (PathLen)
+			Path.AppendChar('.');
+		Path.AppendChars(Name.GetData(), Name.Len());
+	}
+
+	if (TestItem(Item)) {
+		DeepSearchResult& Result = Results.AddDefaulted_GetRef();
+		Result.Path = Path;
+		Result.OpenNodeIDs = OpenNodeIDs;
+		Result.RowID = Item.NodeID;
+	}
+
+	if (Depth >= MaxDepth || !Item.CanBeOpened())
+		return;
+
+	int StackOffset = 0;
+	PropertyItem Container = GetContainerItem(Item, StackOffset);
+	if (!Container.Ptr)
+		return;
+
+	OpenNodeIDs.Push(Item.NodeID);
+
+	bool ContainerIsObject = Container.Type == PointerType::Object || TagHasFlag(Container.GetTag(), TagFlag_Object);
+	if (ContainerIsObject) {
+		// Objects get their own work item, every object is only searched once.
+		UObject* Obj = (UObject*)Container.Ptr;
+		bool AlreadyVisited = false;
+		VisitedObjects.Add(FObjectKey(Obj), &AlreadyVisited);
+		if (!AlreadyVisited)
+			Queue.Add({ Obj, Item.NodeID, Depth, Path, OpenNodeIDs });
+
+	} else
+		VisitMembers(Container, Depth, Path, OpenNodeIDs);
+
+	OpenNodeIDs.Pop(false);
+}
+
+void DeepSearchState::VisitMembers(PropertyItem& Container, int Depth, FString& Path, TArray<uint64>& OpenNodeIDs) {
+	TArray<PropertyItem> Members;
+	Container.GetMembers(&Members);
+
+	// Class sections are nodes as well.
+	StructLayout* Layout = 0;
+	bool ContainerIsObject = Container.Type == PointerType::Object || TagHasFlag(Container.GetTag(), TagFlag_Object);
+	if (ClassSections && ContainerIsObject) {
+		Layout = GetStructLayout(((UObject*)Container.Ptr)->GetClass());
+		if (Layout->SectionNames.Num() < 2)
+			Layout = 0;
+	}
+
+	for (int i = 0; i < Members.Num(); i++) {
+		PropertyItem& Member = Members[i];
+		Member.NodeID = MakeNodeID(Container.NodeID, 0, Member.Prop, i); // Same as TreeNodeCache::RefreshChildren.
+
+		bool InSection = Layout && Layout->Members.IsValidIndex(i);
+		if (InSection)
+			OpenNodeIDs.Push(MakeNodeID(Container.NodeID, 0, (void*)NodeKey_Section, Layout->Members[i].SectionIndex));
+
+		VisitItem(Member, Depth + 1, Path, OpenNodeIDs);
+
+		if (InSection)
+			OpenNodeIDs.Pop(false);
+	}
+}
+
+bool DeepSearchState::TestItem(PropertyItem& Item) {
+	CachedColumnText ColumnTexts;
+	ColumnTexts.Add(ColumnID_Name, Item.GetAuthoredName());
+	if (Item.NameOverwrite.IsEmpty() && Item.Type == PointerType::Property)
+		ColumnTexts.Name = Item.GetName();
+
+	for (auto& Command : Parser.Commands)
+		if (Command.Type == SimpleSearchParser::Command_Test && !ColumnTexts.Get(Command.Tst.ColumnID))
+			ColumnTexts.Add(Command.Tst.ColumnID, GetColumnCellText(Item, Command.Tst.ColumnID));
+
+	return Parser.ApplyTests(ColumnTexts);
+}
+
+bool SearchIndexer::NeedsRefresh(const FString& TabName) {
+	return Enabled && Index && Index->TabName == TabName && !IsBuilding() && FPlatformTime::Seconds() - Index->StartTime >= RefreshInterval;
+}
+
+void SearchIndexer::Build(FString TabName, TArray<PropertyItem>& Roots, TArray<FlatCategory>& Categories, bool ClassSections, int MaxDepth) {
+	SCOPE_EVENT("PropertyWatcher::SearchIndexer::Build");
+
+	GetTagInfo(Tag_None); // Makes sure the tag table is initialized before the worker uses it.
+
+	// Only objects can be captured as roots, struct roots point to memory we can't keep track of.
+	TArray<SearchIndexRoot> IndexRoots;
+	auto AddRoots = [&Roots, &IndexRoots](int Start, int End, uint64 CategoryID) {
+		for (int i = Start; i < End; i++) {
+			PropertyItem& Item = Roots[i];
+			if (Item.Type == PointerType::Object && Item.Ptr)
+				IndexRoots.Add({ (UObject*)Item.Ptr, FString(Item.GetAuthoredName()), Item.NodeID, CategoryID });
+		}
+	};
+
+	if (!Categories.Num())
+		AddRoots(0, Roots.Num(), 0);
+	else
+		for (auto& Category : Categories)
+			AddRoots(Category.Start, Category.End, Category.Name.IsEmpty() ? 0 : Category.ID);
+
+	PendingIndex = MakeShared<SearchIndex, ESPMode::ThreadSafe>();
+	PendingIndex->TabName = TabName;
+	PendingIndex->ClassSections = ClassSections;
+	PendingIndex->MaxDepth = MaxDepth;
+	PendingIndex->StartTime = FPlatformTime::Seconds();
+
+	// A build that is still running gets dropped when it finishes.
+	PendingBuild = Async(EAsyncExecution::ThreadPool, [Index = PendingIndex, IndexRoots = MoveTemp(IndexRoots), Max = MaxEntries]() mutable {
+		BuildIndex(Index, MoveTemp(IndexRoots), Max);
+	});
+}
+
+void SearchIndexer::Query(TArray<char>& QueryString, TArray<FAView>& Columns, int MaxResults) {
+	PendingResults = Async(EAsyncExecution::ThreadPool, [Index = Index, QueryString, Columns, MaxResults]() {
+		return QueryIndex(Index, QueryString, Columns, MaxResults);
+	});
+}
+
+void SearchIndexer::Update() {
+	if (IsBuilding() && PendingBuild.IsReady()) {
+		Index = PendingIndex;
+		PendingIndex.Reset();
+		PendingBuild.Reset();
+	}
+}
+
+void SearchIndexer::Clear() {
+	// Running tasks hold their own references.
+	Index.Reset();
+	PendingIndex.Reset();
+	PendingBuild.Reset();
+	PendingResults.Reset();
+}
+
+void SearchIndexer::BuildIndex(SearchIndexPtr Index, TArray<SearchIndexRoot> Roots, int MaxEntries) {
+	SCOPE_EVENT("PropertyWatcher::SearchIndexer::BuildIndex");
+
+	SearchIndexBuilder Builder;
+	Builder.Index = Index.Get();
+	Builder.MaxEntries = MaxEntries;
+	Builder.Run(Roots);
+
+	Index->ObjectCount = Builder.VisitedObjects.Num();
+	Index->BuildMs = (FPlatformTime::Seconds() - Index->StartTime) * 1000.0;
+}
+
+TArray<DeepSearchResult> SearchIndexer::QueryIndex(SearchIndexPtr Index, TArray<char> QueryString, TArray<FAView> Columns, int MaxResults) {
+	SCOPE_EVENT("PropertyWatcher::SearchIndexer::QueryIndex");
+
+	SimpleSearchParser Parser;
+	Parser.ParseExpression(FAView(QueryString.GetData(), QueryString.Num() - 1), Columns);
+
+	TArray<DeepSearchResult> Results;
+	TArray<int> Chain;
+	for (int i = 0; i < Index->Entries.Num() && Results.Num() < MaxResults; i++) {
+		const SearchIndexEntry& Entry = Index->Entries[i];
+
+		CachedColumnText ColumnTexts;
+		for (auto& Command : Parser.Commands)
+			if (Command.Type == SimpleSearchParser::Command_Test)
+				ColumnTexts.Add(Command.Tst.ColumnID, Index->GetText(Entry, Command.Tst.ColumnID));
+
+		if (!Parser.ApplyTests(ColumnTexts))
+			continue;
+
+		Chain.Reset();
+		for (int EntryIndex = i; EntryIndex != -1; EntryIndex = Index->Entries[EntryIndex].Parent)
+			Chain.Push(EntryIndex);
+
+		// Same path and open nodes that DeepSearchState::VisitItem collects.
+		DeepSearchResult& Result = Results.AddDefaulted_GetRef();
+		for (int j = Chain.Num() - 1; j >= 0; j--) {
+			const SearchIndexEntry& Link = Index->Entries[Chain[j]];
+			FAView Name = Index->GetText(Link, ColumnID_Name);
+			if (Result.Path.Len())
+				Result.Path.AppendChar('.');
+			Result.Path.AppendChars(Name.GetData(), Name.Len());
+
+			if (Link.OpenNodeID)
+				Result.OpenNodeIDs.Push(Link.OpenNodeID);
+			if (j != 0)
+				Result.OpenNodeIDs.Push(Link.NodeID);
+		}
+		Result.RowID = Entry.NodeID;
+	}
+
+	return Results;
+}
+
+void SearchIndexBuilder::Run(TArray<SearchIndexRoot>& Roots) {
+	Index->TextData.Push('\0'); // Offset 0 is the empty string for columns without text.
+
+	int RootIndex = 0;
+	int QueueIndex = 0;
+	while ((RootIndex < Roots.Num() || QueueIndex < Queue.Num()) && Index->Entries.Num() < MaxEntries) {
+		// The guard gets released every few ms so garbage collection doesn't have to wait for the whole build.
+		// Objects that got collected in between are skipped through their weak pointers.
+		FGCScopeGuard GCGuard;
+		double EndTime = FPlatformTime::Seconds() + 0.005;
+
+		while (RootIndex < Roots.Num() && FPlatformTime::Seconds() < EndTime)
+			AddRoot(Roots[RootIndex++]);
+
+		while (QueueIndex < Queue.Num() && FPlatformTime::Seconds() < EndTime) {
+			// Queue can grow while we work on the item.
+			Work Item = Queue[QueueIndex++];
+			if (UObject* Obj = Item.Object.Get())
+				AddMembers(Obj->GetClass(), Obj, true, Item.Entry, Item.Depth);
+		}
+	}
+}
+
+void SearchIndexBuilder::AddRoot(SearchIndexRoot& Root) {
+	UObject* Obj = Root.Object.Get();
+	if (!Obj)
+		return;
+
+	UClass* Class = Obj->GetClass();
+	int EntryIndex = AddEntry(-1, Root.NodeID, Root.CategoryID);
+	int* Texts = Index->Entries[EntryIndex].TextOffsets;
+	Texts[ColumnID_Name]    = AddText(Root.Name);
+	Texts[ColumnID_Cpptype] = AddText(Class->GetName());
+	Texts[ColumnID_Address] = AddTextf("0x%" PRIXPTR "\n", (uintptr_t)Obj);
+	Texts[ColumnID_Size]    = AddTextf("%d B", Class->GetPropertiesSize());
+
+	bool AlreadyVisited = false;
+	VisitedObjects.Add(FObjectKey(Obj), &AlreadyVisited);
+	if (!AlreadyVisited)
+		Queue.Add({ Obj, EntryIndex, 0 });
+}
+
+void SearchIndexBuilder::AddMembers(UStruct* Struct, void* Container, bool IsObject, int Parent, int Depth) {
+	uint64 ParentID = Index->Entries[Parent].NodeID;
+	TArray<int>* Sections = IsObject && Index->ClassSections ? &GetSectionIndexes(Struct) : 0;
+
+	// Member order and ids have to be the same as in PropertyItem::GetMembers, otherwise the results can't be opened.
+	int MemberIndex = 0;
+	for (FProperty* Prop : TFieldRange<FProperty>(Struct)) {
+		if (Index->Entries.Num() >= MaxEntries)
+			return;
+
+		int i = MemberIndex++;
+		uint64 NodeID = MakeNodeID(ParentID, 0, Prop, i);
+		uint64 SectionID = Sections && Sections->Num() ? MakeNodeID(ParentID, 0, (void*)NodeKey_Section, (*Sections)[i]) : 0;
+
+		PropertyTag Tag = ResolvePropertyTag(Prop); // PropertyTagCache is game thread only.
+		void* ValuePtr = Prop->ContainerPtrToValuePtr<void>(Container);
+		bool IsObjectProp = TagHasFlag(Tag, TagFlag_Object);
+		UObject* Obj = IsObjectProp ? ((FObjectProperty*)Prop)->GetObjectPropertyValue(ValuePtr) : 0;
+
+		int EntryIndex = AddEntry(Parent, NodeID, SectionID);
+		PropertyTexts& PropTexts = GetPropertyTexts(Prop);
+		int* Texts = Index->Entries[EntryIndex].TextOffsets;
+		Texts[ColumnID_Name]     = PropTexts.Name;
+		Texts[ColumnID_Metadata] = PropTexts.Metadata;
+		Texts[ColumnID_Type]     = PropTexts.Type;
+		Texts[ColumnID_Cpptype]  = PropTexts.Cpptype;
+		Texts[ColumnID_Class]    = PropTexts.Class;
+		Texts[ColumnID_Category] = PropTexts.Category;
+		Texts[ColumnID_Size]     = PropTexts.Size;
+		Texts[ColumnID_Address]  = AddTextf("0x%" PRIXPTR "\n", IsObjectProp ? (uintptr_t)Obj : (uintptr_t)ValuePtr);
+		Texts[ColumnID_Value]    = AddValueText(Prop, Tag, ValuePtr);
+
+		// Same rule as DeepSearchState::VisitItem, an entry at MaxDepth is listed but not opened.
+		int MemberDepth = Depth + 1;
+		if (MemberDepth >= Index->MaxDepth || Prop->ArrayDim != 1 || !TagHasFlag(Tag, TagFlag_Expandable))
+			continue;
+
+		if (Obj) {
+			bool AlreadyVisited = false;
+			VisitedObjects.Add(FObjectKey(Obj), &AlreadyVisited);
+			if (!AlreadyVisited)
+				Queue.Add({ Obj, EntryIndex, MemberDepth });
+
+		} else if (TagHasFlag(Tag, TagFlag_Struct))
+			AddMembers(((FStructProperty*)Prop)->Struct, ValuePtr, false, EntryIndex, MemberDepth);
+	}
+}
+
+int SearchIndexBuilder::AddEntry(int Parent, uint64 NodeID, uint64 OpenNodeID) {
+	SearchIndexEntry& Entry = Index->Entries.AddZeroed_GetRef();
+	Entry.Parent = Parent;
+	Entry.NodeID = NodeID;
+	Entry.OpenNodeID = OpenNodeID;
+	return Index->Entries.Num() - 1;
+}
+
+int SearchIndexBuilder::AddText(const FString& Text) {
+	if (Text.IsEmpty())
+		return 0;
+
+	int Offset = Index->TextData.Num();
+	auto Converted = StringCast<ANSICHAR>(*Text, Text.Len());
+	Index->TextData.Append(Converted.Get(), Converted.Length());
+	Index->TextData.Push('\0');
+	return Offset;
+}
+
+int SearchIndexBuilder::AddTextf(const char* Fmt, ...) {
+	ANSICHAR Buffer[64];
+	int ResultSize;
+	GET_VARARGS_RESULT_ANSI(Buffer, UE_ARRAY_COUNT(Buffer), UE_ARRAY_COUNT(Buffer) - 1, Fmt, Fmt, ResultSize);
+	if (ResultSize <= 0)
+		return 0;
+
+	int Offset = Index->TextData.Num();
+	Index->TextData.Append(Buffer, ResultSize);
+	Index->TextData.Push('\0');
+	return Offset;
+}
+
+int SearchIndexBuilder::AddValueText(FProperty* Prop, PropertyTag Tag, void* ValuePtr) {
+	// Only plain values, the game thread might be writing to them but we can't read out of bounds.
+	switch (Tag) {
+	case Tag_Bool:   return AddTextf("%s", ((FBoolProperty*)Prop)->GetPropertyValue(ValuePtr) ? "true" : "false");
+	case Tag_Int8:   return AddTextf(NumericTypeInfo<int8>::Format,   *(int8*)ValuePtr);
+	case Tag_Byte:
+	case Tag_Enum:   return AddTextf(NumericTypeInfo<uint8>::Format,  *(uint8*)ValuePtr);
+	case Tag_Int16:  return AddTextf(NumericTypeInfo<int16>::Format,  *(int16*)ValuePtr);
+	case Tag_UInt16: return AddTextf(NumericTypeInfo<uint16>::Format, *(uint16*)ValuePtr);
+	case Tag_Int:    return AddTextf(NumericTypeInfo<int32>::Format,  *(int32*)ValuePtr);
+	case Tag_UInt32: return AddTextf(NumericTypeInfo<uint32>::Format, *(uint32*)ValuePtr);
+	case Tag_Int64:  return AddTextf(NumericTypeInfo<int64>::Format,  *(int64*)ValuePtr);
+	case Tag_UInt64: return AddTextf(NumericTypeInfo<uint64>::Format, *(uint64*)ValuePtr);
+	case Tag_Float:  return AddTextf(NumericTypeInfo<float>::Format,  (double)*(float*)ValuePtr);
+	case Tag_Double: return AddTextf(NumericTypeInfo<double>::Format, *(double*)ValuePtr);
+	case Tag_Name:   return AddText(((FName*)ValuePtr)->ToString());
 	}
+	return 0;
+}
 
-	// Draw leaf properties.
-	if (NodeState.IsOpen) {
-		bool PushAddressesStack = State.ForceToggleNodeOpenClose || State.ForceInlineChildItems;
-		if (PushAddressesStack)
-			State.VisitedPropertiesStack.Push(NodeState.ItemInfo);
-		TMem.PushMarker();
+SearchIndexBuilder::PropertyTexts& SearchIndexBuilder::GetPropertyTexts(FProperty* Prop) {
+	if (PropertyTexts* Found = PropertyTextCache.Find(Prop))
+		return *Found;
 
-		DrawItemChildren(State, Item, CurrentMemberPath, StackIndex);
-		
-		TMem.PopMarker();
-		if (PushAddressesStack)
-			State.VisitedPropertiesStack.Pop(false);
-	}
+	// Same strings as GetColumnCellText.
+	PropertyTexts Texts = {};
+	Texts.Name    = AddText(Prop->GetName());
+	Texts.Type    = AddText(Prop->GetClass()->GetName());
+	Texts.Cpptype = AddText(Prop->GetCPPType());
+	Texts.Class   = AddText(((FField*)Prop)->Owner.GetFName().ToString());
+	Texts.Size    = AddTextf("%d B", Prop->GetSize());
 
-	if (ItemCanBeOpened)
-		CurrentMemberPath.Pop(false);
+#if MetaData_Available
+	if (const TMap<FName, FString>* MetaData = Prop->GetMetaDataMap()) {
+		TStringBuilder<256> Builder;
+		int i = 0;
+		for (auto& It : *MetaData) {
+			if (i++ != 0)
+				Builder.Append("\n\n");
+			Builder.Appendf(TEXT("%s:\n\t"), *It.Key.ToString());
+			Builder.Append(It.Value);
+		}
+		Texts.Metadata = AddText(FString(Builder.Len(), *Builder));
 
-	EndTreeNode(NodeState, State);
+		if (const FString* Category = MetaData->Find("Category"))
+			Texts.Category = AddText(*Category);
+	}
+#endif
 
-	if (IsTopWatchItem)
-		ImGui::PopID();
+	return PropertyTextCache.Add(Prop, Texts);
 }
 
-void DrawItemChildren(TreeState& State, PropertyItem& Item, TInlineComponentArray<FAView>& CurrentMemberPath, int StackIndex) {
-	check(Item.Ptr); // Do we need this check here? Can't remember.
-
-	if (Item.Prop &&
-		(Item.Prop->IsA(FWeakObjectProperty::StaticClass()) ||
-			Item.Prop->IsA(FLazyObjectProperty::StaticClass()) ||
-			Item.Prop->IsA(FSoftObjectProperty::StaticClass()))) {
-		UObject* Obj = 0;
-		bool IsValid = GetObjFromObjPointerProp(Item, Obj);
-		if (IsValid) {
-			return DrawItemChildren(State, MakeObjectItem(Obj), CurrentMemberPath, StackIndex + 1);
+TArray<int>& SearchIndexBuilder::GetSectionIndexes(UStruct* Struct) {
+	if (TArray<int>* Found = SectionIndexCache.Find(Struct))
+		return *Found;
+
+	// Same sections as StructLayout::Build, classes with a single section don't get any.
+	TArray<int> Indexes;
+	FName CurrentOwnerName = NAME_None;
+	int SectionIndex = -1;
+	for (FProperty* MemberProp : TFieldRange<FProperty>(Struct)) {
+		FName OwnerName = ((FField*)MemberProp)->Owner.GetFName();
+		if (SectionIndex == -1 || OwnerName != CurrentOwnerName) {
+			CurrentOwnerName = OwnerName;
+			SectionIndex++;
 		}
+		Indexes.Push(SectionIndex);
 	}
 
-	bool ItemIsObjectProp = Item.Prop && Item.Prop->IsA(FObjectProperty::StaticClass());
-	bool ItemIsObject = ItemIsObjectProp || Item.Type == PointerType::Object;
+	if (SectionIndex < 1)
+		Indexes.Empty();
 
-	// Members.
-	{
-		TArray<PropertyItem> Members;
-		Item.GetMembers(&Members);
+	return SectionIndexCache.Add(Struct, MoveTemp(Indexes));
+}
 
-		SectionHelper SectionHelper;
-		if (State.EnableClassCategoriesOnObjectItems && ItemIsObject) {
-			for (auto& Member : Members)
-				SectionHelper.Add(((FField*)(Member).Prop)->Owner.GetFName());
+void MemorySnapshot::Capture(UObject* Root) {
+	SCOPE_EVENT("PropertyWatcher::MemorySnapshot::Capture");
 
-			SectionHelper.Init();
-		}
+	double StartTime = FPlatformTime::Seconds();
 
-		if (!SectionHelper.Enabled) {
-			for (auto It : Members)
-				DrawItemRow(State, It, CurrentMemberPath, StackIndex + 1);
+	// Root and everything it owns, e.g. the components of an actor.
+	TArray<UObject*> Subobjects;
+	GetObjectsWithOuter(Root, Subobjects, true);
 
-		} else {
-			for (int SectionIndex = 0; SectionIndex < SectionHelper.GetSectionCount(); SectionIndex++) {
-				int MemberStartIndex, MemberEndIndex;
-				auto CurrentSectionName = SectionHelper.GetSectionInfo(SectionIndex, MemberStartIndex, MemberEndIndex);
+	TArray<UObject*> CaptureObjects = { Root };
+	CaptureObjects.Append(Subobjects);
 
-				TreeNodeState NodeState = {};
-				NodeState.OverrideNoTreePush = true;
-				BeginSection(CurrentSectionName, NodeState, State, StackIndex, SectionIndex == 0 ? ImGuiTreeNodeFlags_DefaultOpen : 0);
+	// The game thread waits for the workers, so the memory can't change while it gets copied.
+	Objects.SetNum(CaptureObjects.Num());
+	ParallelFor(CaptureObjects.Num(), [this, &CaptureObjects](int i) {
+		Objects[i].Capture(CaptureObjects[i]);
+	});
 
-				if (NodeState.IsOpen)
-					for (int MemberIndex = MemberStartIndex; MemberIndex < MemberEndIndex; MemberIndex++)
-						DrawItemRow(State, Members[MemberIndex], CurrentMemberPath, StackIndex + 1);
+	CaptureMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+}
 
-				EndSection(NodeState, State);
-			}
-		}
+int MemorySnapshot::GetDataSize() {
+	int Size = 0;
+	for (auto& Obj : Objects)
+		Size += Obj.Data.Num() + Obj.Nodes.Num() * sizeof(SnapshotNode);
+	return Size;
+}
+
+void ObjectSnapshot::Capture(UObject* Obj) {
+	UClass* ObjClass = Obj->GetClass();
+	Object = Obj;
+	Class = ObjClass;
+	Name = Obj->GetName();
+	ObjectSize = ObjClass->GetPropertiesSize();
+
+	Data.Append((uint8*)Obj, ObjectSize);
+	CaptureMembers(ObjClass, 0, -1);
+}
+
+void ObjectSnapshot::CaptureMembers(UStruct* Struct, int BaseOffset, int Parent) {
+	for (FProperty* Prop : TFieldRange<FProperty>(Struct)) {
+		int NodeIndex = AddNode(Prop, Parent, BaseOffset + Prop->GetOffset_ForInternal(), Prop->GetSize(), -1);
+		CaptureValue(NodeIndex);
+		Nodes[NodeIndex].SubtreeEnd = Nodes.Num();
 	}
+}
 
-	// Functions.
-	if (State.ListFunctionsOnObjectItems && Item.Ptr && ItemIsObject) {
-		TArray<UFunction*> Functions = GetObjectFunctionList((UObject*)Item.Ptr);
+void ObjectSnapshot::CaptureValue(int NodeIndex) {
+	// Nodes and Data grow in here, so no references into them.
+	FProperty* Prop = Nodes[NodeIndex].Prop;
+	int Offset = Nodes[NodeIndex].DataOffset;
 
-		if (Functions.Num()) {
-			TreeNodeState FunctionSection = {};
-			BeginSection("Functions", FunctionSection, State, StackIndex, 0);
+	// Static arrays get compared as one value.
+	if (Prop->ArrayDim != 1)
+		return;
 
-			if (FunctionSection.IsOpen) {
-				SectionHelper SectionHelper;
-				if (State.EnableClassCategoriesOnObjectItems) {
-					for (auto& Function : Functions)
-						SectionHelper.Add(Function->GetOuterUClass()->GetFName());
+	// Copied containers still point to the live memory, which can't change during the capture.
+	auto SetContainer = [this, NodeIndex](SnapshotNodeKind Kind, int ContentOffset, int ContentSize, int Count) {
+		SnapshotNode& Node = Nodes[NodeIndex];
+		Node.Kind = Kind;
+		Node.DataOffset = ContentOffset;
+		Node.Size = ContentSize;
+		Node.Count = Count;
+		MarkOutOfLine(NodeIndex);
+	};
 
-					SectionHelper.Init();
-				}
+	if (FStructProperty* StructProp = CastField<FStructProperty>(Prop)) {
+		Nodes[NodeIndex].Kind = SnapshotNode_Struct;
+		CaptureMembers(StructProp->Struct, Offset, NodeIndex);
 
-				if (!SectionHelper.Enabled) {
-					for (auto It : Functions)
-						DrawItemRow(State, MakeFunctionItem(Item.Ptr, It), CurrentMemberPath, StackIndex + 1);
+	} else if (CastField<FStrProperty>(Prop)) {
+		// String points into Data, which the append can move.
+		FString& String = *(FString*)(Data.GetData() + Offset);
+		const TCHAR* Chars = *String;
+		int Len = String.Len();
+		int Bytes = Len * sizeof(TCHAR);
 
-				} else {
-					for (int SectionIndex = 0; SectionIndex < SectionHelper.GetSectionCount(); SectionIndex++) {
-						int MemberStartIndex, MemberEndIndex;
-						auto CurrentSectionName = SectionHelper.GetSectionInfo(SectionIndex, MemberStartIndex, MemberEndIndex);
+		int ContentOffset = Data.Num();
+		Data.Append((const uint8*)Chars, Bytes);
+		SetContainer(SnapshotNode_String, ContentOffset, Bytes, Len);
 
-						TreeNodeState NodeState = {};
-						NodeState.OverrideNoTreePush = true;
-						BeginSection(CurrentSectionName, NodeState, State, StackIndex, SectionIndex == 0 ? ImGuiTreeNodeFlags_DefaultOpen : 0);
+	} else if (FArrayProperty* ArrayProp = CastField<FArrayProperty>(Prop)) {
+		FScriptArrayHelper Helper(ArrayProp, Data.GetData() + Offset);
+		int Num = FMath::Min(Helper.Num(), MaxContainerElements);
+		int ElementSize = ArrayProp->Inner->GetSize();
+		const uint8* Elements = Num ? Helper.GetRawPtr(0) : 0;
+
+		int ContentOffset = Data.Num();
+		Data.Append(Elements, Num * ElementSize);
+		SetContainer(SnapshotNode_Container, ContentOffset, Num * ElementSize, Num);
+
+		for (int i = 0; i < Num; i++) {
+			int Child = AddNode(ArrayProp->Inner, NodeIndex, ContentOffset + i * ElementSize, ElementSize, i);
+			CaptureValue(Child);
+			Nodes[Child].SubtreeEnd = Nodes.Num();
+		}
 
-						if (NodeState.IsOpen)
-							for (int MemberIndex = MemberStartIndex; MemberIndex < MemberEndIndex; MemberIndex++)
-								DrawItemRow(State, MakeFunctionItem(Item.Ptr, Functions[MemberIndex]), CurrentMemberPath, StackIndex + 1);
+	} else if (FSetProperty* SetProp = CastField<FSetProperty>(Prop)) {
+		int Num = FMath::Min(FScriptSetHelper(SetProp, Data.GetData() + Offset).Num(), MaxContainerElements);
+		int ElementSize = SetProp->ElementProp->GetSize();
+
+		// Space first, the helper points into Data. Elements are sparse, only valid ones get copied.
+		int ContentOffset = Data.Num();
+		Data.AddUninitialized(Num * ElementSize);
+		FScriptSetHelper Helper(SetProp, Data.GetData() + Offset);
+		for (int i = 0, n = 0; n < Num; i++)
+			if (Helper.IsValidIndex(i))
+				FMemory::Memcpy(Data.GetData() + ContentOffset + (n++) * ElementSize, Helper.GetElementPtr(i), ElementSize);
+		SetContainer(SnapshotNode_Container, ContentOffset, Num * ElementSize, Num);
+
+		for (int i = 0; i < Num; i++) {
+			int Child = AddNode(SetProp->ElementProp, NodeIndex, ContentOffset + i * ElementSize, ElementSize, i);
+			CaptureValue(Child);
+			Nodes[Child].SubtreeEnd = Nodes.Num();
+		}
 
-						EndSection(NodeState, State);
-					}
-				}
+	} else if (FMapProperty* MapProp = CastField<FMapProperty>(Prop)) {
+		int Num = FMath::Min(FScriptMapHelper(MapProp, Data.GetData() + Offset).Num(), MaxContainerElements);
+		int KeySize = MapProp->KeyProp->GetSize();
+		int ValueSize = MapProp->ValueProp->GetSize();
+		int PairSize = KeySize + ValueSize;
+
+		// Pairs get stored as key bytes followed by value bytes.
+		int ContentOffset = Data.Num();
+		Data.AddUninitialized(Num * PairSize);
+		FScriptMapHelper Helper(MapProp, Data.GetData() + Offset);
+		for (int i = 0, n = 0; n < Num; i++)
+			if (Helper.IsValidIndex(i)) {
+				uint8* Pair = Data.GetData() + ContentOffset + (n++) * PairSize;
+				FMemory::Memcpy(Pair, Helper.GetKeyPtr(i), KeySize);
+				FMemory::Memcpy(Pair + KeySize, Helper.GetValuePtr(i), ValueSize);
 			}
+		SetContainer(SnapshotNode_Container, ContentOffset, Num * PairSize, Num);
 
-			EndSection(FunctionSection, State);
+		for (int i = 0; i < Num; i++) {
+			int PairOffset = ContentOffset + i * PairSize;
+			int Child = AddNode(MapProp, NodeIndex, PairOffset, PairSize, i);
+			Nodes[Child].Kind = SnapshotNode_Struct;
+
+			int Key = AddNode(MapProp->KeyProp, Child, PairOffset, KeySize, -1);
+			CaptureValue(Key);
+			Nodes[Key].SubtreeEnd = Nodes.Num();
+
+			int Value = AddNode(MapProp->ValueProp, Child, PairOffset + KeySize, ValueSize, -1);
+			CaptureValue(Value);
+			Nodes[Value].SubtreeEnd = Nodes.Num();
+
+			Nodes[Child].SubtreeEnd = Nodes.Num();
 		}
 	}
 }
 
-bool ItemHasMetaData(PropertyItem& Item) {
-	if (!Item.Prop)
-		return false;
+int ObjectSnapshot::AddNode(FProperty* Prop, int Parent, int DataOffset, int Size, int Index) {
+	SnapshotNode& Node = Nodes.AddZeroed_GetRef();
+	Node.Prop = Prop;
+	Node.Parent = Parent;
+	Node.DataOffset = DataOffset;
+	Node.Size = Size;
+	Node.Index = Index;
+	Node.SubtreeEnd = Nodes.Num();
+	return Nodes.Num() - 1;
+}
 
-	bool Result = false;
-#if MetaData_Available
-	if (const TMap<FName, FString>* MetaData = Item.Prop->GetMetaDataMap())
-		Result = (bool)MetaData->Num();
-#endif
+void ObjectSnapshot::MarkOutOfLine(int NodeIndex) {
+	for (int i = NodeIndex; i != -1 && !Nodes[i].HasOutOfLineData; i = Nodes[i].Parent)
+		Nodes[i].HasOutOfLineData = true;
+}
 
-	return Result;
+FString ObjectSnapshot::GetNodePath(int NodeIndex) {
+	// Same format as watch paths, container elements are their index.
+	TArray<FString> Names;
+	for (int i = NodeIndex; i != -1; i = Nodes[i].Parent)
+		Names.Push(Nodes[i].Index != -1 ? FString::FromInt(Nodes[i].Index) : Nodes[i].Prop->GetName());
+
+	FString Path = Name;
+	for (int i = Names.Num() - 1; i >= 0; i--)
+		Path += TEXT(".") + Names[i];
+	return Path;
 }
 
-FAView GetColumnCellText(PropertyItem& Item, int ColumnID, TreeState* State, TInlineComponentArray<FAView>* CurrentMemberPath, int* StackIndex) {
-	FAView Result = "";
-	if (ColumnID == ColumnID_Name) {
-		if (CurrentMemberPath && StackIndex) {
-			bool TopLevelWatchListItem = State->CurrentWatchItemIndex != -1 && (*StackIndex) == 0;
-			bool PathIsEditable = TopLevelWatchListItem && State->PathStringPtr;
+FString ObjectSnapshot::FormatNodeValue(int NodeIndex) {
+	SnapshotNode& Node = Nodes[NodeIndex];
+	const uint8* Ptr = Data.GetData() + Node.DataOffset;
+
+	if (Node.Kind == SnapshotNode_Container)
+		return FString::Printf(TEXT("{%d}"), Node.Count);
+	if (Node.Kind == SnapshotNode_String)
+		return FString(Node.Count, (const TCHAR*)Ptr);
+	if (Node.Kind == SnapshotNode_Struct)
+		return "";
+
+	FProperty* Prop = Node.Prop;
+	if (Prop->ArrayDim == 1) {
+		if (FBoolProperty* BoolProp = CastField<FBoolProperty>(Prop))
+			return BoolProp->GetPropertyValue(Ptr) ? "true" : "false";
+		if (FNumericProperty* NumericProp = CastField<FNumericProperty>(Prop))
+			return NumericProp->GetNumericPropertyValueToString(Ptr);
+		if (FEnumProperty* EnumProp = CastField<FEnumProperty>(Prop))
+			return EnumProp->GetUnderlyingProperty()->GetNumericPropertyValueToString(Ptr);
+		if (CastField<FNameProperty>(Prop))
+			return ((FName*)Ptr)->ToString();
+		if (CastField<FObjectProperty>(Prop))
+			return FString::Printf(TEXT("0x%llX"), (uint64)*(UPTRINT*)Ptr); // Object might be gone already.
+	}
 
-			if (!PathIsEditable) {
-				if (State->ForceInlineChildItems && State->InlineStackIndexLimit) {
-					TMemBuilder(Builder);
-					for (int i = State->InlineMemberPathIndexOffset; i < CurrentMemberPath->Num(); i++)
-						Builder.Appendf("%s.", (*CurrentMemberPath)[i].GetData());
-					Builder.Append(Item.GetAuthoredName());
-					Result = *Builder;
+	// Memory we can't interpret from a copy, e.g. FText or delegates.
+	return FString::Printf(TEXT("<%d B>"), Node.Size);
+}
 
-				} else
-					Result = Item.GetAuthoredName();
-			}
-		}
+void SnapshotDiffer::Diff(MemorySnapshot& A, MemorySnapshot& B) {
+	SCOPE_EVENT("PropertyWatcher::SnapshotDiffer::Diff");
 
-	} else if (ColumnID == ColumnID_Value) {
-		Result = GetValueStringFromItem(Item);
+	TMap<TWeakObjectPtr<UObject>, int> BObjects;
+	for (int i = 0; i < B.Objects.Num(); i++)
+		BObjects.Add(B.Objects[i].Object, i);
 
-	} else if (ColumnID == ColumnID_Metadata && Item.Prop) {
-#if MetaData_Available
-		if (const TMap<FName, FString>* MetaData = Item.Prop->GetMetaDataMap()) {
-			TArray<FName> Keys;
-			MetaData->GenerateKeyArray(Keys);
-			TStringBuilder<256> Builder;
-
-			int i = -1;
-			for (auto Key : Keys) {
-				i++;
-				if (i != 0)
-					Builder.Append("\n\n");
-				Builder.Appendf(TEXT("%s:\n\t"), *Key.ToString());
-				Builder.Append(*MetaData->Find(Key));
-			}
-			Result = TMem.CToA(*Builder, Builder.Len());
+	TBitArray<> Matched(false, B.Objects.Num());
+	for (auto& ObjA : A.Objects) {
+		int* BIndex = BObjects.Find(ObjA.Object);
+		if (!BIndex) {
+			Changes.Add({ ObjA.Name, "captured", "missing" });
+			continue;
 		}
-#endif
 
-	} else if (ColumnID == ColumnID_Type) {
-		Result = Item.GetPropertyType();
+		Matched[*BIndex] = true;
+		DiffObjects(ObjA, B.Objects[*BIndex]);
+	}
 
-	} else if (ColumnID == ColumnID_Cpptype) {
-		Result = Item.GetCPPType();
+	for (int i = 0; i < B.Objects.Num(); i++)
+		if (!Matched[i])
+			Changes.Add({ B.Objects[i].Name, "missing", "captured" });
+}
 
-	} else if (ColumnID == ColumnID_Class) {
-		if (Item.Prop) {
-			FFieldVariant Owner = ((FField*)Item.Prop)->Owner;
-			Result = TMem.NToA(Owner.GetFName());
+void SnapshotDiffer::DiffObjects(ObjectSnapshot& A, ObjectSnapshot& B) {
+	if (!A.Class.IsValid() || A.Class != B.Class) {
+		Changes.Add({ A.Name, "class changed", "" });
+		return;
+	}
 
-		} else if (Item.Type == PointerType::Function) {
-			UClass* Class = ((UFunction*)Item.StructPtr)->GetOuterUClass();
-			if (Class)
-				Result = TMem.NToA(Class->GetFName());
-		}
+	if (A.Data.Num() == B.Data.Num() && SnapshotBlockEquals(A.Data.GetData(), B.Data.GetData(), A.Data.Num()))
+		return;
 
-	} else if (ColumnID == ColumnID_Category) {
-		Result = GetItemMetadataCategory(Item);
+	// Nodes in the object memory only get compared when one of their blocks changed.
+	int BlockCount = FMath::DivideAndRoundUp(A.ObjectSize, BlockSize);
+	ChangedBlocks.Init(false, BlockCount);
+	for (int i = 0; i < BlockCount; i++) {
+		int Offset = i * BlockSize;
+		int Size = FMath::Min(BlockSize, A.ObjectSize - Offset);
+		ChangedBlocks[i] = !SnapshotBlockEquals(A.Data.GetData() + Offset, B.Data.GetData() + Offset, Size);
+	}
 
-	} else if (ColumnID == ColumnID_Address) {
-		Result = TMem.Printf("0x%" PRIXPTR "\n", (uintptr_t)Item.Ptr);
+	DiffChildren(A, 0, A.Nodes.Num(), B, 0, B.Nodes.Num(), true);
+}
 
-	} else if (ColumnID == ColumnID_Size) {
-		int Size = Item.GetSize();
-		if (Size != -1)
-			Result = TMem.Printf("%d B", Size);
+void SnapshotDiffer::DiffChildren(ObjectSnapshot& A, int AIndex, int AEnd, ObjectSnapshot& B, int BIndex, int BEnd, bool UseBlocks) {
+	while (AIndex < AEnd && BIndex < BEnd) {
+		DiffNode(A, AIndex, B, BIndex, UseBlocks);
+		AIndex = A.Nodes[AIndex].SubtreeEnd;
+		BIndex = B.Nodes[BIndex].SubtreeEnd;
 	}
-
-	return Result;
 }
 
-FAView GetValueStringFromItem(PropertyItem& Item) {
-	// Maybe we could just serialize the property to string?
-	// Since we don't handle that many types for now we can just do it by hand.
-	FAView Result;
+void SnapshotDiffer::DiffNode(ObjectSnapshot& A, int AIndex, ObjectSnapshot& B, int BIndex, bool UseBlocks) {
+	SnapshotNode& NodeA = A.Nodes[AIndex];
+	SnapshotNode& NodeB = B.Nodes[BIndex];
+	if (UseBlocks && !NodeA.HasOutOfLineData && !AnyBlockChanged(NodeA.DataOffset, NodeA.Size))
+		return;
 
-	if (!Item.Ptr)
-		Result = "Null";
+	const uint8* PtrA = A.Data.GetData() + NodeA.DataOffset;
+	const uint8* PtrB = B.Data.GetData() + NodeB.DataOffset;
 
-	else if (!Item.Prop)
-		Result = "";
+	switch (NodeA.Kind) {
+	case SnapshotNode_Value:
+	case SnapshotNode_String: {
+		bool Equal;
+		if (FBoolProperty* BoolProp = CastField<FBoolProperty>(NodeA.Prop))
+			Equal = BoolProp->GetPropertyValue(PtrA) == BoolProp->GetPropertyValue(PtrB); // Bitfields share bytes.
+		else
+			Equal = NodeA.Size == NodeB.Size && SnapshotBlockEquals(PtrA, PtrB, NodeA.Size);
 
-	else if (FNumericProperty* NumericProp = CastField<FNumericProperty>(Item.Prop))
-		Result = TMem.SToA(NumericProp->GetNumericPropertyValueToString(Item.Ptr));
+		if (!Equal)
+			AddChange(A, AIndex, B, BIndex);
+	} break;
 
-	else if (FBoolProperty* BoolProp = CastField<FBoolProperty>(Item.Prop))
-		Result = ((bool*)(Item.Ptr)) ? "true" : "false";
+	case SnapshotNode_Struct:
+		DiffChildren(A, AIndex + 1, NodeA.SubtreeEnd, B, BIndex + 1, NodeB.SubtreeEnd, UseBlocks);
+		break;
 
-	else if (Item.Prop->IsA(FStrProperty::StaticClass()))
-		Result = TMem.SToA(*(FString*)Item.Ptr);
+	case SnapshotNode_Container: {
+		if (NodeA.Count != NodeB.Count)
+			AddChange(A, AIndex, B, BIndex);
 
-	else if (Item.Prop->IsA(FNameProperty::StaticClass()))
-		Result = TMem.NToA(*((FName*)Item.Ptr));
+		// Contents are outside of the object memory.
+		DiffChildren(A, AIndex + 1, NodeA.SubtreeEnd, B, BIndex + 1, NodeB.SubtreeEnd, false);
+	} break;
+	}
+}
 
-	else if (Item.Prop->IsA(FTextProperty::StaticClass()))
-		Result = TMem.SToA((FString&)((FText*)Item.Ptr)->ToString());
+void SnapshotDiffer::AddChange(ObjectSnapshot& A, int AIndex, ObjectSnapshot& B, int BIndex) {
+	Changes.Add({ A.GetNodePath(AIndex), A.FormatNodeValue(AIndex), B.FormatNodeValue(BIndex) });
+}
 
-	return Result;
+bool SnapshotDiffer::AnyBlockChanged(int Offset, int Size) {
+	if (Size <= 0)
+		return false;
+
+	int Last = FMath::Min((Offset + Size - 1) / BlockSize, ChangedBlocks.Num() - 1);
+	for (int i = Offset / BlockSize; i <= Last; i++)
+		if (ChangedBlocks[i])
+			return true;
+	return false;
 }
 
-void DrawPropertyValue(PropertyItem& Item) {
-	static TArray<char> StringBuffer;
-	static int IntStep = 1;
-	static int IntStepFast8 = 10;
-	static int IntStepFast = 100;
-	static int64 Int64Step = 1;
-	static int64 Int64StepFast = 100;
-	//static float FloatStepFast = 1;
-	//static double DoubleStepFast = 100;
-
-	bool DragEnabled = ImGui::IsKeyDown(ImGuiMod_Alt);
-
-	if (Item.Ptr == 0) {
-		ImGui::Text("<Null>");
+bool SnapshotBlockEquals(const uint8* A, const uint8* B, int Size) {
+	// Xor/or over 64 byte blocks without branches, compilers turn the inner loop into SIMD.
+	int i = 0;
+	for (; i + 64 <= Size; i += 64) {
+		uint64 Diff = 0;
+		for (int j = 0; j < 64; j += 8)
+			Diff |= FPlatformMemory::ReadUnaligned<uint64>(A + i + j) ^ FPlatformMemory::ReadUnaligned<uint64>(B + i + j);
+		if (Diff)
+			return false;
+	}
 
-	} else if (Item.Prop == 0) {
-		ImGui::Text("{%d}", Item.GetMemberCount());
+	for (; i < Size; i++)
+		if (A[i] != B[i])
+			return false;
+	return true;
+}
 
-	} else if (FClassProperty* ClassProp = CastField<FClassProperty>(Item.Prop)) {
-		UClass* Class = (UClass*)Item.Ptr;
-		ImGui::Text(ImGui_StoA(*Class->GetAuthoredName()));
-
-	} else if (FClassPtrProperty* ClassPtrProp = CastField<FClassPtrProperty>(Item.Prop)) {
-		ImGui::Text("<Not Implemented>");
-
-	} else if (FSoftClassProperty* SoftClassProp = CastField<FSoftClassProperty>(Item.Prop)) {
-		FSoftObjectPtr* SoftClass = (FSoftObjectPtr*)Item.Ptr;
-		if (SoftClass->IsStale())
-			ImGui::Text("<Stale>");
-		else if (SoftClass->IsPending())
-			ImGui::Text("<Pending>");
-		else if (!SoftClass->IsValid())
-			ImGui::Text("<Null>");
-		else {
-			FString Path = SoftClass->ToSoftObjectPath().ToString();
-			if (Path.Len())
-				ImGuiAddon::InputString("##SoftClassProp", Path, StringBuffer);
-		}
-
-	} else if (FWeakObjectProperty* WeakObjProp = CastField<FWeakObjectProperty>(Item.Prop)) {
-		TWeakObjectPtr<UObject>* WeakPtr = (TWeakObjectPtr<UObject>*)Item.Ptr;
-		if (WeakPtr->IsStale())
-			ImGui::Text("<Stale>");
-		if (!WeakPtr->IsValid())
-			ImGui::Text("<Null>");
-		else {
-			auto NewItem = MakeObjectItem(WeakPtr->Get());
-			DrawPropertyValue(NewItem);
-		}
-
-	} else if (FLazyObjectProperty* LayzObjProp = CastField<FLazyObjectProperty>(Item.Prop)) {
-		TLazyObjectPtr<UObject>* LazyPtr = (TLazyObjectPtr<UObject>*)Item.Ptr;
-		if (LazyPtr->IsStale())
-			ImGui::Text("<Stale>");
-		if (!LazyPtr->IsValid())
-			ImGui::Text("<Null>");
-		else {
-			auto NewItem = MakeObjectItem(LazyPtr->Get());
-			DrawPropertyValue(NewItem);
-		}
-		ImGui::SameLine();
-		ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
-		FString ID = LazyPtr->GetUniqueID().ToString();
-		ImGuiAddon::InputString("##LazyObjectProp", ID, StringBuffer);
-
-	} else if (FSoftObjectProperty* SoftObjProp = CastField<FSoftObjectProperty>(Item.Prop)) {
-		TSoftObjectPtr<UObject>* SoftObjPtr = (TSoftObjectPtr<UObject>*)Item.Ptr;
-		if (SoftObjPtr->IsPending())
-			ImGui::Text("<Pending>");
-		else if (!SoftObjPtr->IsValid())
-			ImGui::Text("<Null>");
-		else {
-			FString Path = SoftObjPtr->ToSoftObjectPath().ToString();
-			if (Path.Len())
-				ImGuiAddon::InputString("##SoftObjProp", Path, StringBuffer);
-		}
-
-	} else if (Item.Type == PointerType::Function) {
-		if (ImGui::Button("Call Function")) {
-			UObject* Obj = (UObject*)Item.Ptr;
-			UFunction* Function = (UFunction*)Item.StructPtr;
-			static char buf[256];
-			Obj->ProcessEvent(Function, buf);
-		}
-
-	} else if (Item.Type == PointerType::Object ||
-		Item.Prop->IsA(FObjectProperty::StaticClass())) {
-		int MemberCount = Item.GetMemberCount();
-		if (MemberCount)
-			ImGui::Text("{%d}", MemberCount);
-		else
-			ImGui::Text("{}");
+void SnapshotState::Capture(UObject* Root) {
+	TUniquePtr<MemorySnapshot>& Snapshot = Snapshots.Add_GetRef(MakeUnique<MemorySnapshot>());
+	Snapshot->Name = FString::Printf(TEXT("%s (%s)"), *Root->GetName(), *FDateTime::Now().ToString(TEXT("%H:%M:%S")));
+	Snapshot->Capture(Root);
 
-	} else if (CastField<FByteProperty>(Item.Prop) && CastField<FByteProperty>(Item.Prop)->IsEnum()) {
-		FByteProperty* ByteProp = CastField<FByteProperty>(Item.Prop);
-		if (ByteProp->Enum) {
-			UEnum* Enum = ByteProp->Enum;
-			int Count = Enum->NumEnums();
+	if (SelectedA == -1)
+		SelectedA = Snapshots.Num() - 1;
+}
 
-			StringBuffer.Empty();
-			for (int i = 0; i < Count; i++) {
-				FString Name = Enum->GetNameStringByIndex(i);
-				StringBuffer.Append(ImGui_StoA(*Name), Name.Len());
-				StringBuffer.Push('\0');
-			}
-			StringBuffer.Push('\0');
-			uint8* Value = (uint8*)Item.Ptr;
-			int TempInt = *Value;
-			if (ImGui::Combo("##Enum", &TempInt, StringBuffer.GetData(), Count))
-				*Value = TempInt;
-		}
+void SnapshotState::Diff() {
+	Changes.Reset();
+	if (!Snapshots.IsValidIndex(SelectedA))
+		return;
 
-	} else if (FBoolProperty* BoolProp = CastField<FBoolProperty>(Item.Prop)) {
-		bool TempBool = BoolProp->GetPropertyValue(Item.Ptr);
-		ImGui::Checkbox("", &TempBool);
-		BoolProp->SetPropertyValue(Item.Ptr, TempBool);
+	double StartTime = FPlatformTime::Seconds();
 
-	} else if (Item.Prop->IsA(FInt8Property::StaticClass())) {
-		ImGui::InputScalar("##FInt8Property", ImGuiDataType_S8, Item.Ptr, &IntStep, &IntStepFast8);
+	MemorySnapshot& A = *Snapshots[SelectedA];
+	MemorySnapshot Live;
+	MemorySnapshot* B = Snapshots.IsValidIndex(SelectedB) ? Snapshots[SelectedB].Get() : 0;
+	if (!B) {
+		// Live memory gets captured from the same root.
+		UObject* Root = A.Objects.Num() ? A.Objects[0].Object.Get() : 0;
+		if (!Root) {
+			DiffInfo = "Snapshot object doesn't exist anymore.";
+			return;
+		}
+		Live.Capture(Root);
+		B = &Live;
+	}
 
-	} else if (Item.Prop->IsA(FByteProperty::StaticClass())) {
-		ImGui::InputScalar("##FByteProperty", ImGuiDataType_U8, Item.Ptr, &IntStep, &IntStepFast8);
+	SnapshotDiffer Differ = { Changes };
+	Differ.Diff(A, *B);
 
-	} else if (Item.Prop->IsA(FInt16Property::StaticClass())) {
-		ImGui::InputScalar("##FInt16Property", ImGuiDataType_S16, Item.Ptr, &IntStep, &IntStepFast);
+	DiffInfo = FString::Printf(TEXT("%d changes, %.2f ms"), Changes.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
 
-	} else if (Item.Prop->IsA(FUInt16Property::StaticClass())) {
-		ImGui::InputScalar("##FUInt16Property", ImGuiDataType_U16, Item.Ptr, &IntStep, &IntStepFast);
+void JsonWriter::BeginValue() {
+	if (AfterKey) {
+		AfterKey = false;
+		return;
+	}
+	if (Depth > 0) {
+		if (HasElements[Depth])
+			Out.Push(',');
+		HasElements[Depth] = true;
+		NewLine();
+	}
+}
 
-	} else if (Item.Prop->IsA(FIntProperty::StaticClass())) {
-		ImGui::InputScalar("##FIntProperty", ImGuiDataType_S32, Item.Ptr, &IntStep, &IntStepFast);
+void JsonWriter::NewLine() {
+	Out.Push('\n');
+	for (int i = 0; i < Depth; i++)
+		Out.Push('\t');
+}
 
-	} else if (Item.Prop->IsA(FUInt32Property::StaticClass())) {
-		ImGui::InputScalar("##FUInt32Property", ImGuiDataType_U32, Item.Ptr, &IntStep, &IntStepFast);
+int JsonWriter::BeginContainer(ANSICHAR c) {
+	// Containers that were open when the last chunk stopped get entered again without writing anything.
+	if (IsResuming()) {
+		Depth++;
+		Objects[Depth] = NextObject;
+		NextObject = 0;
+		int Start = Path[Depth];
+		if (Depth == ResumeDepth)
+			ResumeDepth = 0;
+		return Start;
+	}
 
-	} else if (Item.Prop->IsA(FInt64Property::StaticClass())) {
-		ImGui::InputScalar("##FInt64Property", ImGuiDataType_S64, Item.Ptr, &Int64Step, &Int64StepFast);
+	BeginValue();
+	Out.Push(c);
+	Depth = FMath::Min(Depth + 1, MaxDepth);
+	HasElements[Depth] = false;
+	Objects[Depth] = NextObject;
+	NextObject = 0;
+	return 0;
+}
 
-	} else if (Item.Prop->IsA(FUInt64Property::StaticClass())) {
-		ImGui::InputScalar("##FUInt64Property", ImGuiDataType_U64, Item.Ptr, &Int64Step, &Int64StepFast);
+void JsonWriter::EndContainer(ANSICHAR c) {
+	// The element the last chunk stopped in is gone.
+	if (IsResuming()) {
+		Fail();
+		return;
+	}
 
-	} else if (Item.Prop->IsA(FFloatProperty::StaticClass())) {
-		//ImGui::IsItemHovered
-		//if(!DragEnabled)
-		ImGui::InputFloat("##FFloatProperty", (float*)Item.Ptr);
-		//else 
-			//ImGui::DragFloat("##FFloatProperty", (float*)Item.Ptr, 1.0f);
+	bool Empty = !HasElements[Depth];
+	Depth--;
+	if (!Empty)
+		NewLine();
+	Out.Push(c);
+}
 
-	} else if (Item.Prop->IsA(FDoubleProperty::StaticClass())) {
-		ImGui::InputDouble("##FDoubleProperty", (double*)Item.Ptr);
+// Called before every element of a container that can be chunked, false stops the container.
+bool JsonWriter::BeginElement(int Index) {
+	if (IsFull()) {
+		Truncated = true;
+		return false;
+	}
+	if (Out.Num() >= ChunkEnd && !IsResuming()) {
+		Path[Depth] = Index;
+		ResumeDepth = Depth;
+		Paused = true;
+		return false;
+	}
+	return true;
+}
 
-	} else if (Item.Prop->IsA(FStrProperty::StaticClass())) {
-		ImGuiAddon::InputString("##StringProp", *(FString*)Item.Ptr, StringBuffer);
+// True when the chunk stopped somewhere inside of the element, the container has to be left open.
+bool JsonWriter::EndElement(int Level, int Index) {
+	if (!Paused)
+		return false;
+	Path[Level] = Index;
+	return true;
+}
 
-	} else if (Item.Prop->IsA(FNameProperty::StaticClass())) {
-		FString Str = ((FName*)Item.Ptr)->ToString();
-		if (ImGuiAddon::InputString("##NameProp", Str, StringBuffer)) (*((FName*)Item.Ptr)) = FName(Str);
+bool JsonWriter::IsBeingWritten(UObject* Obj) {
+	for (int i = 0; i <= Depth; i++)
+		if (Objects[i] == Obj)
+			return true;
+	return false;
+}
 
-	} else if (Item.Prop->IsA(FTextProperty::StaticClass())) {
-		FString Str = ((FText*)Item.Ptr)->ToString();
-		if (ImGuiAddon::InputString("##TextProp", Str, StringBuffer)) (*((FText*)Item.Ptr)) = FText::FromString(Str);
+void JsonWriter::Key(FAView Name) {
+	String(Name);
+	Out.Push(':');
+	Out.Push(' ');
+	AfterKey = true;
+}
 
-	} else if (FArrayProperty* ArrayProp = CastField<FArrayProperty>(Item.Prop)) {
-		FProperty* CurrentProp = ArrayProp->Inner;
-		FScriptArrayHelper ScriptArrayHelper(ArrayProp, Item.Ptr);
-		ImGui::Text("%s [%d]", ImGui_StoA(*CurrentProp->GetCPPType()), ScriptArrayHelper.Num());
+void JsonWriter::String(FAView Utf8) {
+	BeginValue();
+	Out.Push('"');
+	for (ANSICHAR c : Utf8) {
+		switch (c) {
+			case '"':  Out.Append("\\\"", 2); break;
+			case '\\': Out.Append("\\\\", 2); break;
+			case '\n': Out.Append("\\n", 2); break;
+			case '\r': Out.Append("\\r", 2); break;
+			case '\t': Out.Append("\\t", 2); break;
+			default: {
+				if ((uint8)c < 0x20) {
+					ANSICHAR Buffer[8];
+					FCStringAnsi::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), "\\u%04x", (int)c);
+					Out.Append(Buffer, 6);
+				} else
+					Out.Push(c);
+			}
+		}
+	}
+	Out.Push('"');
+}
 
-	} else if (FMapProperty* MapProp = CastField<FMapProperty>(Item.Prop)) {
-		FScriptMapHelper Helper = FScriptMapHelper(MapProp, Item.Ptr);
-		ImGui::Text("<%s, %s> (%d)", ImGui_StoA(*MapProp->KeyProp->GetCPPType()), ImGui_StoA(*MapProp->ValueProp->GetCPPType()), Helper.Num());
+void JsonWriter::String(const FString& Text) {
+	FTCHARToUTF8 Converted(*Text, Text.Len());
+	String(FAView(Converted.Get(), Converted.Length()));
+}
 
-	} else if (FSetProperty* SetProp = CastField<FSetProperty>(Item.Prop)) {
-		FScriptSetHelper Helper = FScriptSetHelper(SetProp, Item.Ptr);
-		ImGui::Text("<%s> {%d}", ImGui_StoA(*Helper.GetElementProperty()->GetCPPType()), Helper.Num());
+void JsonWriter::Rawf(const char* Fmt, ...) {
+	BeginValue();
+	ANSICHAR Buffer[64];
+	int ResultSize;
+	GET_VARARGS_RESULT_ANSI(Buffer, UE_ARRAY_COUNT(Buffer), UE_ARRAY_COUNT(Buffer) - 1, Fmt, Fmt, ResultSize);
+	if (ResultSize > 0)
+		Out.Append(Buffer, ResultSize);
+}
 
-	} else if (FMulticastDelegateProperty* MultiDelegateProp = CastField<FMulticastDelegateProperty>(Item.Prop)) {
-		auto ScriptDelegate = (TMulticastScriptDelegate<FWeakObjectPtr>*)Item.Ptr;
-		//MultiDelegateProp->SignatureFunction->
-		//ScriptDelegate->ProcessMulticastDelegate(asdf);
-		//auto BoundObjects = ScriptDelegate->GetAllObjects();
-		//if (!MemberArray) return BoundObjects.Num();
+void JsonWriter::RawValue(FAView Json) {
+	BeginValue();
+	Out.Append(Json.GetData(), Json.Len());
+}
 
-		//for (auto Obj : BoundObjects)
-		//	MemberArray->Push(MakeObjectItem(Obj));
+void WriteJsonMembers(JsonWriter& Writer, UStruct* Struct, void* Container, UObject* Root, int Depth) {
+	StructLayout* Layout = GetStructLayout(Struct);
+	int Start = Writer.BeginObject();
+	int Level = Writer.Depth;
+	for (int i = Start; i < Layout->Members.Num() && Writer.BeginElement(i); i++) {
+		MemberLayout& Member = Layout->Members[i];
+		void* Ptr = (uint8*)Container + Member.Offset;
+
+		// Key of the element the last chunk stopped in is already written.
+		if (!Writer.IsResuming())
+			Writer.Key(Member.Name);
+		if (Member.Prop->ArrayDim != 1)
+			WriteJsonStaticArray(Writer, Member.Prop, Ptr, Root, Depth + 1);
+		else
+			WriteJsonValue(Writer, Member.Prop, Ptr, Root, Depth + 1);
 
-		ImGui::BeginDisabled(); defer{ ImGui::EndDisabled(); };
-		if (ImGui::Button("Broadcast")) {
-			// @Todo
-		}
+		if (Writer.EndElement(Level, i))
+			return;
+	}
+	if (!Writer.Paused)
+		Writer.EndObject();
+}
 
-	} else if (FDelegateProperty* DelegateProp = CastField<FDelegateProperty>(Item.Prop)) {
-		auto ScriptDelegate = (TScriptDelegate<FWeakObjectPtr>*)Item.Ptr;
-		FString Text;
-		if (ScriptDelegate->IsBound()) Text = ScriptDelegate->GetFunctionName().ToString();
-		else                           Text = "<No Function Bound>";
-		ImGui::Text(ImGui_StoA(*Text));
+void WriteJsonStaticArray(JsonWriter& Writer, FProperty* Prop, void* Ptr, UObject* Root, int Depth) {
+	int ElementSize = Prop->GetSize() / Prop->ArrayDim;
+	int Start = Writer.BeginArray();
+	int Level = Writer.Depth;
+	for (int i = Start; i < Prop->ArrayDim && Writer.BeginElement(i); i++) {
+		WriteJsonValue(Writer, Prop, (uint8*)Ptr + i * ElementSize, Root, Depth + 1);
+		if (Writer.EndElement(Level, i))
+			return;
+	}
+	if (!Writer.Paused)
+		Writer.EndArray();
+}
 
-	} else if (FMulticastInlineDelegateProperty* MultiInlineDelegateProp = CastField<FMulticastInlineDelegateProperty>(Item.Prop)) {
-		ImGui::Text("<NotImplemented>"); // @Todo
+// Pairs of [key, value], keys are not always strings. Chunks don't stop between key and value.
+void WriteJsonMapPair(JsonWriter& Writer, FMapProperty* MapProp, FScriptMapHelper& Helper, int Index, UObject* Root, int Depth) {
+	int Start = Writer.BeginArray();
+	int Level = Writer.Depth;
+	for (int Part = Start; Part < 2; Part++) {
+		if (Part == 0)
+			WriteJsonValue(Writer, MapProp->KeyProp, Helper.GetKeyPtr(Index), Root, Depth + 1);
+		else
+			WriteJsonValue(Writer, MapProp->ValueProp, Helper.GetValuePtr(Index), Root, Depth + 1);
+		if (Writer.EndElement(Level, Part))
+			return;
+	}
+	Writer.EndArray();
+}
 
-	} else if (FMulticastSparseDelegateProperty* MultiSparseDelegateProp = CastField<FMulticastSparseDelegateProperty>(Item.Prop)) {
-		ImGui::Text("<NotImplemented>"); // @Todo
+void WriteJsonValue(JsonWriter& Writer, FProperty* Prop, void* Ptr, UObject* Root, int Depth) {
+	if (Depth >= JsonWriter::MaxDepth - 1 || Writer.Depth >= JsonWriter::MaxDepth - 1 || Writer.IsFull()) {
+		Writer.Truncated = true;
+		Writer.Rawf("null");
+		return;
+	}
 
-	} else if (FStructProperty* StructProp = CastField<FStructProperty>(Item.Prop)) {
-		FString Extended;
-		FString StructType = StructProp->GetCPPType(&Extended, 0);
+	if (FBoolProperty* BoolProp = CastField<FBoolProperty>(Prop)) {
+		Writer.Rawf(BoolProp->GetPropertyValue(Ptr) ? "true" : "false");
 
-		if (StructType == "FVector") {
-			ImGui::InputScalarN("##FVector", ImGuiDataType_Double, &((FVector*)Item.Ptr)->X, 3);
+	} else if (FEnumProperty* EnumProp = CastField<FEnumProperty>(Prop)) {
+		int64 Value = EnumProp->GetUnderlyingProperty()->GetSignedIntPropertyValue(Ptr);
+		Writer.String(EnumProp->GetEnum()->GetNameStringByValue(Value));
 
-		} else if (StructType == "FRotator") {
-			ImGui::InputScalarN("##FVector", ImGuiDataType_Double, &((FRotator*)Item.Ptr)->Pitch, 3);
+	} else if (Prop->IsA<FByteProperty>() && ((FByteProperty*)Prop)->Enum) {
+		Writer.String(((FByteProperty*)Prop)->Enum->GetNameStringByValue(*(uint8*)Ptr));
 
-		} else if (StructType == "FVector2D") {
-			ImGui::InputScalarN("##FVector2D", ImGuiDataType_Double, &((FVector2D*)Item.Ptr)->X, 2);
+	} else if (FNumericProperty* NumProp = CastField<FNumericProperty>(Prop)) {
+		if (NumProp->IsFloatingPoint()) {
+			double Value = NumProp->GetFloatingPointPropertyValue(Ptr);
+			if (!FMath::IsFinite(Value))
+				Writer.Rawf("null");
+			else
+				Writer.Rawf(Prop->IsA<FFloatProperty>() ? "%.9g" : "%.17g", Value);
+		} else if (Prop->IsA<FUInt64Property>())
+			Writer.Rawf("%llu", (unsigned long long)NumProp->GetUnsignedIntPropertyValue(Ptr));
+		else
+			Writer.Rawf("%lld", (long long)NumProp->GetSignedIntPropertyValue(Ptr));
 
-		} else if (StructType == "FIntVector") {
-			ImGui::InputInt3("##FIntVector", &((FIntVector*)Item.Ptr)->X);
+	} else if (Prop->IsA<FStrProperty>()) {
+		Writer.String(*(FString*)Ptr);
 
-		} else if (StructType == "FIntPoint") {
-			ImGui::InputInt2("##FIntPoint", &((FIntPoint*)Item.Ptr)->X);
+	} else if (Prop->IsA<FNameProperty>()) {
+		Writer.String(((FName*)Ptr)->ToString());
 
-		} else if (StructType == "FTimespan") {
-			FString s = ((FTimespan*)Item.Ptr)->ToString();
-			if (ImGuiAddon::InputString("##FTimespan", s, StringBuffer))
-				FTimespan::Parse(s, *((FTimespan*)Item.Ptr));
+	} else if (Prop->IsA<FTextProperty>()) {
+		Writer.String(((FText*)Ptr)->ToString());
 
-		} else if (StructType == "FDateTime") {
-			FString s = ((FDateTime*)Item.Ptr)->ToString();
-			if (ImGuiAddon::InputString("##FDateTime", s, StringBuffer))
-				FDateTime::Parse(s, *((FDateTime*)Item.Ptr));
+	} else if (FStructProperty* StructProp = CastField<FStructProperty>(Prop)) {
+		WriteJsonMembers(Writer, StructProp->Struct, Ptr, Root, Depth);
 
-		} else if (StructType == "FLinearColor") {
-			FLinearColor* lCol = (FLinearColor*)Item.Ptr;
-			FColor sCol = lCol->ToFColor(true);
-			float c[4] = { sCol.R / 255.0f, sCol.G / 255.0f, sCol.B / 255.0f, sCol.A / 255.0f };
-			if (ImGui::ColorEdit4("##FLinearColor", c, ImGuiColorEditFlags_AlphaPreview)) {
-				sCol = FColor(c[0] * 255, c[1] * 255, c[2] * 255, c[3] * 255);
-				*lCol = FLinearColor::FromSRGBColor(sCol);
-			}
+	} else if (FArrayProperty* ArrayProp = CastField<FArrayProperty>(Prop)) {
+		FScriptArrayHelper Helper(ArrayProp, Ptr);
+		int Start = Writer.BeginArray();
+		int Level = Writer.Depth;
+		for (int i = Start; i < Helper.Num() && Writer.BeginElement(i); i++) {
+			WriteJsonValue(Writer, ArrayProp->Inner, Helper.GetRawPtr(i), Root, Depth + 1);
+			if (Writer.EndElement(Level, i))
+				return;
+		}
+		if (!Writer.Paused)
+			Writer.EndArray();
 
-		} else if (StructType == "FColor") {
-			FColor* sCol = (FColor*)Item.Ptr;
-			float c[4] = { sCol->R / 255.0f, sCol->G / 255.0f, sCol->B / 255.0f, sCol->A / 255.0f };
-			if (ImGui::ColorEdit4("##FColor", c, ImGuiColorEditFlags_AlphaPreview))
-				*sCol = FColor(c[0] * 255, c[1] * 255, c[2] * 255, c[3] * 255);
+	} else if (FSetProperty* SetProp = CastField<FSetProperty>(Prop)) {
+		FScriptSetHelper Helper(SetProp, Ptr);
+		int Start = Writer.BeginArray();
+		int Level = Writer.Depth;
+		for (int i = Start; i < Helper.GetMaxIndex(); i++) {
+			if (!Helper.IsValidIndex(i))
+				continue;
+			if (!Writer.BeginElement(i))
+				break;
+			WriteJsonValue(Writer, SetProp->ElementProp, Helper.GetElementPtr(i), Root, Depth + 1);
+			if (Writer.EndElement(Level, i))
+				return;
+		}
+		if (!Writer.Paused)
+			Writer.EndArray();
 
-		} else {
-			ImGui::Text("{%d}", Item.GetMemberCount());
+	} else if (FMapProperty* MapProp = CastField<FMapProperty>(Prop)) {
+		FScriptMapHelper Helper(MapProp, Ptr);
+		int Start = Writer.BeginArray();
+		int Level = Writer.Depth;
+		for (int i = Start; i < Helper.GetMaxIndex(); i++) {
+			if (!Helper.IsValidIndex(i))
+				continue;
+			if (!Writer.BeginElement(i))
+				break;
+			WriteJsonMapPair(Writer, MapProp, Helper, i, Root, Depth + 1);
+			if (Writer.EndElement(Level, i))
+				return;
 		}
-	} else {
-		ImGui::Text("<UnknownType>");
-	}
+		if (!Writer.Paused)
+			Writer.EndArray();
+
+	} else if (FObjectProperty* ObjectProp = CastField<FObjectProperty>(Prop)) {
+		// Subobjects of the copied object get written inline, everything else is a reference.
+		// Subobjects that are already open further up get written as references, so cycles end.
+		UObject* Obj = ObjectProp->GetObjectPropertyValue(Ptr);
+		if (!Obj)
+			Writer.Rawf("null");
+		else if (Root && Obj->IsIn(Root) && !Writer.IsBeingWritten(Obj)) {
+			Writer.NextObject = Obj;
+			WriteJsonMembers(Writer, Obj->GetClass(), Obj, Root, Depth);
+		} else
+			Writer.String(Obj->GetPathName());
+
+	} else
+		Writer.Rawf("null");
+}
+
+ANSICHAR JsonReader::Peek() {
+	while (Pos < Text.Len() && FChar::IsWhitespace(Text[Pos]))
+		Pos++;
+	return Pos < Text.Len() ? Text[Pos] : 0;
+}
+
+bool JsonReader::Consume(ANSICHAR c) {
+	if (Peek() != c)
+		return false;
+	Pos++;
+	return true;
+}
+
+bool JsonReader::Expect(ANSICHAR c) {
+	if (Consume(c))
+		return true;
+	return Fail(*FString::Printf(TEXT("Expected '%c'"), (TCHAR)c));
 }
 
-bool MemberPath::UpdateItemFromPath(TArray<PropertyItem>& Items) {
-	// Name is the "path" to the member. You can traverse through objects, structs and arrays.
-	// E.g.: objectMember.<arrayIndex>.structMember.float/int/bool member
+bool JsonReader::Enter() {
+	if (++Depth > MaxDepth)
+		return Fail(TEXT("Nested too deep"));
+	return true;
+}
+
+bool JsonReader::ReadHex(uint32& Value) {
+	if (Pos + 4 > Text.Len())
+		return Fail(TEXT("Bad escape"));
+	Value = 0;
+	for (int i = 0; i < 4; i++) {
+		ANSICHAR c = Text[Pos++];
+		if (!FChar::IsHexDigit(c))
+			return Fail(TEXT("Bad escape"));
+		Value = Value * 16 + FParse::HexDigit(c);
+	}
+	return true;
+}
 
-	TArray<FString> MemberArray;
-	PathString.ParseIntoArray(MemberArray, TEXT("."));
+bool JsonReader::ReadString(FString& Out) {
+	if (!Expect('"'))
+		return false;
 
-	if (MemberArray.IsEmpty()) return false;
+	TArray<ANSICHAR, TInlineAllocator<256>> Utf8;
+	while (true) {
+		if (Pos >= Text.Len())
+			return Fail(TEXT("Unterminated string"));
 
-	bool SearchFailed = false;
+		ANSICHAR c = Text[Pos++];
+		if (c == '"')
+			break;
+		if (c != '\\') {
+			Utf8.Push(c);
+			continue;
+		}
 
-	// Find first name in items.
-	PropertyItem CurrentItem;
-	{
-		bool Found = false;
-		for (auto& It : Items)
-			if (FString(It.GetAuthoredName()) == MemberArray[0]) { //@Fix
-				CurrentItem = It;
-				Found = true;
-			}
+		if (Pos >= Text.Len())
+			return Fail(TEXT("Unterminated string"));
+		c = Text[Pos++];
+		switch (c) {
+			case 'n': Utf8.Push('\n'); break;
+			case 'r': Utf8.Push('\r'); break;
+			case 't': Utf8.Push('\t'); break;
+			case 'b': Utf8.Push('\b'); break;
+			case 'f': Utf8.Push('\f'); break;
+			case 'u': {
+				uint32 CodePoint;
+				if (!ReadHex(CodePoint))
+					return false;
+
+				// Characters outside of the basic multilingual plane come as a pair of utf16 surrogates.
+				if (CodePoint >= 0xD800 && CodePoint <= 0xDFFF) {
+					uint32 Low = 0;
+					bool IsPair = CodePoint <= 0xDBFF && Text.RightChop(Pos).StartsWith("\\u");
+					if (IsPair) {
+						Pos += 2;
+						if (!ReadHex(Low))
+							return false;
+						IsPair = Low >= 0xDC00 && Low <= 0xDFFF;
+						if (!IsPair)
+							Pos -= 6; // Gets read as its own escape.
+					}
+					CodePoint = IsPair ? 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00) : 0xFFFD;
+				}
 
-		if (!Found) SearchFailed = true;
-		MemberArray.RemoveAt(0);
+				if (CodePoint < 0x80)
+					Utf8.Push((ANSICHAR)CodePoint);
+				else if (CodePoint < 0x800) {
+					Utf8.Push((ANSICHAR)(0xC0 | (CodePoint >> 6)));
+					Utf8.Push((ANSICHAR)(0x80 | (CodePoint & 0x3F)));
+				} else if (CodePoint < 0x10000) {
+					Utf8.Push((ANSICHAR)(0xE0 | (CodePoint >> 12)));
+					Utf8.Push((ANSICHAR)(0x80 | ((CodePoint >> 6) & 0x3F)));
+					Utf8.Push((ANSICHAR)(0x80 | (CodePoint & 0x3F)));
+				} else {
+					Utf8.Push((ANSICHAR)(0xF0 | (CodePoint >> 18)));
+					Utf8.Push((ANSICHAR)(0x80 | ((CodePoint >> 12) & 0x3F)));
+					Utf8.Push((ANSICHAR)(0x80 | ((CodePoint >> 6) & 0x3F)));
+					Utf8.Push((ANSICHAR)(0x80 | (CodePoint & 0x3F)));
+				}
+			} break;
+			default: Utf8.Push(c); // Quote, backslash, slash.
+		}
 	}
 
-	if (!SearchFailed)
-		for (auto& MemberName : MemberArray) {
-			//if (!CurrentItem->IsValid()) return false;
-
-			// (Membername=Value)
-			bool SearchByMemberValue = false;
-			//FString MemberNameToTest;
-			//FString MemberValueToTest;
-			//if (MemberName[0] == '(' && MemberName[MemberName.Len()-1] == ')') {
-			//	SearchByMemberValue = true;
+	FUTF8ToTCHAR Converted(Utf8.GetData(), Utf8.Num());
+	Out = FString(Converted.Length(), Converted.Get());
+	return true;
+}
 
-			//	MemberName.RemoveAt(0);
-			//	MemberName.RemoveAt(MemberName.Len() - 1);
+bool JsonReader::ReadNumber(double& Number, int64& Integer) {
+	Peek();
+	int Start = Pos;
+	bool IsInteger = true;
+	while (Pos < Text.Len()) {
+		ANSICHAR c = Text[Pos];
+		if (c == '.' || c == 'e' || c == 'E')
+			IsInteger = false;
+		else if (!FChar::IsDigit(c) && c != '-' && c != '+')
+			break;
+		Pos++;
+	}
+	if (Pos == Start || Pos - Start > 63)
+		return Fail(TEXT("Expected number"));
 
-			//	bool Result = MemberName.Split("=", &MemberNameToTest, &MemberValueToTest);
-			//	if(!Result) { SearchFailed = true; break; }
-			//}
+	ANSICHAR Buffer[64];
+	FMemory::Memcpy(Buffer, Text.GetData() + Start, Pos - Start);
+	Buffer[Pos - Start] = '\0';
 
-			TArray<PropertyItem> Members;
-			CurrentItem.GetMembers(&Members);
-			bool Found = false;
-			for (auto MemberItem : Members) {
-				FString ItemName = FString(MemberItem.GetAuthoredName()); //@Fix
+	Number = FCStringAnsi::Atod(Buffer);
+	Integer = IsInteger ? FCStringAnsi::Atoi64(Buffer) : (int64)Number;
+	return true;
+}
 
-				if (SearchByMemberValue) {
-					//if (ItemName == MemberNameToTest) {
-					//	MemberItem.
-					//}
+bool JsonReader::ReadBool(bool& Value) {
+	Peek();
+	FAView Rest = Text.RightChop(Pos);
+	if (Rest.StartsWith("true")) {
+		Pos += 4;
+		Value = true;
+		return true;
+	}
+	if (Rest.StartsWith("false")) {
+		Pos += 5;
+		Value = false;
+		return true;
+	}
+	return Fail(TEXT("Expected bool"));
+}
 
-				} else {
-					if (ItemName == MemberName) {
-						CurrentItem = MemberItem;
-						Found = true;
-						break;
-					}
-				}
-			}
-			if (!Found) {
-				SearchFailed = true;
-				break;
+bool JsonReader::SkipValue() {
+	ANSICHAR c = Peek();
+	if (c == '{' || c == '[') {
+		if (!Enter())
+			return false;
+		defer{ Leave(); };
+		Pos++;
+		ANSICHAR End = c == '{' ? '}' : ']';
+		if (Consume(End))
+			return true;
+		do {
+			if (c == '{') {
+				FString Key;
+				if (!ReadString(Key) || !Expect(':'))
+					return false;
 			}
-		}
+			if (!SkipValue())
+				return false;
+		} while (Consume(','));
+		return Expect(End);
+	}
 
+	if (c == '"') {
+		FString Dummy;
+		return ReadString(Dummy);
+	}
 
-	if (!SearchFailed)
-		CachedItem = CurrentItem;
-	else
-		CachedItem = {};
+	if (c == 'n') {
+		if (!Text.RightChop(Pos).StartsWith("null"))
+			return Fail(TEXT("Expected null"));
+		Pos += 4;
+		return true;
+	}
 
-	// Have to set this either way, because we want to see the path in the watch window.
-	CachedItem.NameOverwrite = TMem.SToA(PathString);
+	if (c == 't' || c == 'f') {
+		bool Dummy;
+		return ReadBool(Dummy);
+	}
 
-	return !SearchFailed;
+	double Number;
+	int64 Integer;
+	return ReadNumber(Number, Integer);
 }
 
-FString ConvertWatchedMembersToString(TArray<MemberPath>& WatchedMembers) {
-	TArray<FString> Strings;
-	for (auto It : WatchedMembers)
-		Strings.Push(It.PathString);
+bool JsonReader::Fail(const TCHAR* Message) {
+	if (Error.IsEmpty())
+		Error = FString::Printf(TEXT("%s at offset %d."), Message, Pos);
+	return false;
+}
 
-	FString Result = FString::Join(Strings, TEXT(","));
+bool PastePlan::Compile(FAView Json, PropertyItem& Item, FString& Error) {
+	Steps.Reset();
+	Strings.Reset();
+
+	JsonReader Reader = { Json };
+	bool Result;
+	if (UObject* Obj = GetItemObject(Item)) {
+		Target = Obj;
+		Result = CompileMembers(Reader, Obj->GetClass(), Obj, 0, 0, -1);
+	} else if (Item.Type == PointerType::Struct && Item.Ptr && Item.StructPtr) {
+		Target = Item.Ptr;
+		Result = CompileMembers(Reader, Item.StructPtr, Item.Ptr, 0, 0, -1);
+	} else if (Item.Type != PointerType::Function && Item.Ptr && Item.Prop) {
+		Target = Item.Ptr;
+		Result = CompileValue(Reader, Item.Prop, Item.Ptr, 0, -1);
+	} else
+		Result = Reader.Fail(TEXT("Item can't be pasted to"));
+
+	if (Result && Reader.Peek() != 0)
+		Result = Reader.Fail(TEXT("Unexpected data"));
+	if (Result && !Steps.Num())
+		Result = Reader.Fail(TEXT("Nothing to paste"));
+
+	Error = Reader.Error;
 	return Result;
 }
 
-void LoadWatchedMembersFromString(FString Data, TArray<MemberPath>& WatchedMembers) {
-	WatchedMembers.Empty();
+// Memory is only used to find inline subobjects, it's null inside of arrays because they get resized.
+bool PastePlan::CompileMembers(JsonReader& Reader, UStruct* Struct, void* Memory, FProperty* Prop, int Offset, int Index) {
+	int StepIndex = AddStep(PasteStep_Members, Prop, Offset, Index);
+	if (!Reader.Expect('{'))
+		return false;
 
-	TArray<FString> Strings;
-	Data.ParseIntoArray(Strings, TEXT(","));
-	for (auto It : Strings) {
-		MemberPath Path = {};
-		Path.PathString = It;
+	if (!Reader.Consume('}')) {
+		do {
+			FString Key;
+			if (!Reader.ReadString(Key) || !Reader.Expect(':'))
+				return false;
 
-		WatchedMembers.Push(Path);
+			// Keys come from any clipboard text, only names that already exist are looked up so none get added.
+			FName KeyName(*Key, FNAME_Find);
+			FProperty* Member = KeyName.IsNone() ? 0 : Struct->FindPropertyByName(KeyName);
+			bool Result;
+			if (Member && Member->ArrayDim != 1) {
+				int MemberOffset = Member->GetOffset_ForInternal();
+				Result = CompileStaticArray(Reader, Member, Memory ? (uint8*)Memory + MemberOffset : 0, MemberOffset);
+			} else if (Member) {
+				int MemberOffset = Member->GetOffset_ForInternal();
+				Result = CompileValue(Reader, Member, Memory ? (uint8*)Memory + MemberOffset : 0, MemberOffset, -1);
+			} else
+				Result = Reader.SkipValue();
+			if (!Result)
+				return false;
+		} while (Reader.Consume(','));
+
+		if (!Reader.Expect('}'))
+			return false;
 	}
-}
 
-// -------------------------------------------------------------------------------------------
+	Steps[StepIndex].ChildEnd = Steps.Num();
+	return true;
+}
 
-FName PropertyItem::GetName() {
-	if (Type == PointerType::Property && Prop)
-		return Prop->GetFName();
+// Elements past the size of the static array are ignored, missing ones are left as they are.
+bool PastePlan::CompileStaticArray(JsonReader& Reader, FProperty* Prop, void* Memory, int Offset) {
+	int StepIndex = AddStep(PasteStep_Members, Prop, Offset, -1);
+	if (!Reader.Expect('['))
+		return false;
 
-	if (Type == PointerType::Object && Ptr)
-		return ((UObject*)Ptr)->GetFName();
+	int ElementSize = Prop->GetSize() / Prop->ArrayDim;
+	if (!Reader.Consume(']')) {
+		int Count = 0;
+		do {
+			bool Result;
+			if (Count < Prop->ArrayDim)
+				Result = CompileValue(Reader, Prop, Memory ? (uint8*)Memory + Count * ElementSize : 0, Count * ElementSize, -1);
+			else
+				Result = Reader.SkipValue();
+			if (!Result)
+				return false;
+			Count++;
+		} while (Reader.Consume(','));
 
-	if (StructPtr && (Type == PointerType::Struct || Type == PointerType::Function))
-		return StructPtr->GetFName();
-		//return StructPtr->GetAuthoredName();
+		if (!Reader.Expect(']'))
+			return false;
+	}
 
-	return NAME_None;
+	Steps[StepIndex].ChildEnd = Steps.Num();
+	return true;
 }
 
-FAView PropertyItem::GetAuthoredName() {
-	return !NameOverwrite.IsEmpty() ? NameOverwrite : TMem.NToA(GetName());
-}
+bool PastePlan::CompileValue(JsonReader& Reader, FProperty* Prop, void* Memory, int Offset, int Index) {
+	if (!Reader.Enter())
+		return false;
+	defer{ Reader.Leave(); };
 
-//FString PropertyItem::GetDisplayName() {
-//	FString Result = GetAuthoredName();
-//	if (Type == PointerType::Property && CastField<FObjectProperty>(Prop) && Ptr)
-//		Result = FString::Printf(TEXT("%s (%s)"), *Result, *((UObject*)Ptr)->GetName());
-//
-//	return Result;
-//}
+	// Values that couldn't be written are null.
+	if (Reader.Peek() == 'n')
+		return Reader.SkipValue();
 
-bool PropertyItem::IsExpandable() {
-	if (!IsValid())
-		return false;
+	if (FStructProperty* StructProp = CastField<FStructProperty>(Prop))
+		return CompileMembers(Reader, StructProp->Struct, Memory, Prop, Offset, Index);
 
-	if (!Ptr || Type == PointerType::Function)
-		return false;
+	if (FArrayProperty* ArrayProp = CastField<FArrayProperty>(Prop)) {
+		int StepIndex = AddStep(PasteStep_Array, Prop, Offset, Index);
+		if (!Reader.Expect('['))
+			return false;
 
-	if (Type == PointerType::Object || Type == PointerType::Struct)
+		int Count = 0;
+		if (!Reader.Consume(']')) {
+			do {
+				if (!CompileValue(Reader, ArrayProp->Inner, 0, 0, Count++))
+					return false;
+			} while (Reader.Consume(','));
+
+			if (!Reader.Expect(']'))
+				return false;
+		}
+
+		Steps[StepIndex].Count = Count;
+		Steps[StepIndex].ChildEnd = Steps.Num();
 		return true;
+	}
 
-	if (Prop->IsA(FArrayProperty::StaticClass()) ||
-		Prop->IsA(FMapProperty::StaticClass()) ||
-		Prop->IsA(FSetProperty::StaticClass()) ||
-		Prop->IsA(FObjectProperty::StaticClass()) ||
-		Prop->IsA(FWeakObjectProperty::StaticClass()) ||
-		Prop->IsA(FLazyObjectProperty::StaticClass()) ||
-		Prop->IsA(FSoftObjectProperty::StaticClass()))
+	if (FObjectProperty* ObjectProp = CastField<FObjectProperty>(Prop)) {
+		// References are not pasted, only values of inline subobjects.
+		UObject* Obj = Memory ? ObjectProp->GetObjectPropertyValue(Memory) : 0;
+		if (!Obj || Reader.Peek() != '{')
+			return Reader.SkipValue();
+
+		int StepIndex = AddStep(PasteStep_Object, Prop, Offset, Index);
+		Steps[StepIndex].Class = Obj->GetClass();
+		if (!CompileMembers(Reader, Obj->GetClass(), Obj, 0, 0, -1))
+			return false;
+		Steps[StepIndex].ChildEnd = Steps.Num();
 		return true;
+	}
 
-	if (Prop->IsA(FStructProperty::StaticClass())) {
-		FStructProperty* StructProp = CastField<FStructProperty>(Prop);
+	if (CastField<FBoolProperty>(Prop)) {
+		bool Value;
+		if (!Reader.ReadBool(Value))
+			return false;
+		Steps[AddStep(PasteStep_Bool, Prop, Offset, Index)].Integer = Value;
+		return true;
+	}
 
-		// @Todo: These shouldn't be hardcoded.
-		static TSet<FName> TypeSetX = {
-			"Vector", "Rotator", "Vector2D", "IntVector2", "IntVector", "Timespan", "DateTime" 
-		};
-		
-		FName StructType = StructProp->Struct->GetFName();
-		bool Inlined = TypeSetX.Contains(StructType);
-		return !Inlined;
+	UEnum* Enum = 0;
+	if (FEnumProperty* EnumProp = CastField<FEnumProperty>(Prop))
+		Enum = EnumProp->GetEnum();
+	else if (FByteProperty* ByteProp = CastField<FByteProperty>(Prop))
+		Enum = ByteProp->Enum;
+
+	if (Enum && Reader.Peek() == '"') {
+		FString Name;
+		if (!Reader.ReadString(Name))
+			return false;
+		int64 Value = Enum->GetValueByNameString(Name);
+		if (Value == INDEX_NONE)
+			return Reader.Fail(*FString::Printf(TEXT("Unknown enum value \"%s\""), *Name));
+		Steps[AddStep(PasteStep_Integer, Prop, Offset, Index)].Integer = Value;
+		return true;
 	}
 
-	if (Prop->IsA(FDelegateProperty::StaticClass()))
+	if (Prop->IsA<FEnumProperty>() || Prop->IsA<FNumericProperty>()) {
+		double Number;
+		int64 Integer;
+		if (!Reader.ReadNumber(Number, Integer))
+			return false;
+
+		bool IsFloat = Prop->IsA<FNumericProperty>() && CastField<FNumericProperty>(Prop)->IsFloatingPoint();
+		PasteStep& Step = Steps[AddStep(IsFloat ? PasteStep_Number : PasteStep_Integer, Prop, Offset, Index)];
+		Step.Number = Number;
+		Step.Integer = Integer;
 		return true;
+	}
 
-	if (Prop->IsA(FMulticastDelegateProperty::StaticClass()))
+	if (Prop->IsA<FStrProperty>() || Prop->IsA<FNameProperty>() || Prop->IsA<FTextProperty>()) {
+		FString Value;
+		if (!Reader.ReadString(Value))
+			return false;
+		Steps[AddStep(PasteStep_String, Prop, Offset, Index)].StringIndex = Strings.Add(MoveTemp(Value));
 		return true;
+	}
 
-	return false;
+	// Sets, maps, delegates, soft pointers and so on are not pasted.
+	return Reader.SkipValue();
 }
 
-FAView PropertyItem::GetPropertyType() {
-	FAView Result = "";
-	if (Type == PointerType::Property && Prop)
-		Result = TMem.NToA(Prop->GetClass()->GetFName());
-
-	else if (Type == PointerType::Object)
-		Result = "";
-
-	else if (Type == PointerType::Struct)
-		Result = "";
+int PastePlan::AddStep(PasteStepKind Kind, FProperty* Prop, int Offset, int Index) {
+	PasteStep Step = {};
+	Step.Kind = Kind;
+	Step.Prop = Prop;
+	Step.Offset = Offset;
+	Step.Index = Index;
+	Step.ChildEnd = Steps.Num() + 1;
+	return Steps.Add(Step);
+}
 
-	return Result;
-};
+void PastePlan::ApplyStep(int StepIndex, void* Base) {
+	PasteStep& Step = Steps[StepIndex];
+	void* Ptr = (uint8*)Base + Step.Offset;
+
+	switch (Step.Kind) {
+		case PasteStep_Members: {
+			for (int i = StepIndex + 1; i < Step.ChildEnd; i = Steps[i].ChildEnd)
+				ApplyStep(i, Ptr);
+		} break;
+
+		case PasteStep_Object: {
+			UObject* Obj = ((FObjectProperty*)Step.Prop)->GetObjectPropertyValue(Ptr);
+			if (Obj && Obj->GetClass() == Step.Class)
+				ApplyStep(StepIndex + 1, Obj);
+		} break;
+
+		case PasteStep_Array: {
+			FScriptArrayHelper Helper((FArrayProperty*)Step.Prop, Ptr);
+			Helper.Resize(Step.Count);
+			for (int i = StepIndex + 1; i < Step.ChildEnd; i = Steps[i].ChildEnd)
+				ApplyStep(i, Helper.GetRawPtr(Steps[i].Index));
+		} break;
+
+		case PasteStep_Bool: {
+			((FBoolProperty*)Step.Prop)->SetPropertyValue(Ptr, Step.Integer != 0);
+		} break;
+
+		case PasteStep_Integer: {
+			if (FEnumProperty* EnumProp = CastField<FEnumProperty>(Step.Prop))
+				EnumProp->GetUnderlyingProperty()->SetIntPropertyValue(Ptr, Step.Integer);
+			else
+				((FNumericProperty*)Step.Prop)->SetIntPropertyValue(Ptr, Step.Integer);
+		} break;
+
+		case PasteStep_Number: {
+			((FNumericProperty*)Step.Prop)->SetFloatingPointPropertyValue(Ptr, Step.Number);
+		} break;
+
+		case PasteStep_String: {
+			FString& Value = Strings[Step.StringIndex];
+			if (Step.Prop->IsA<FStrProperty>())
+				*(FString*)Ptr = Value;
+			else if (Step.Prop->IsA<FNameProperty>())
+				*(FName*)Ptr = FName(*Value);
+			else
+				*(FText*)Ptr = FText::FromString(Value);
+		} break;
+	}
+}
 
-FAView PropertyItem::GetCPPType() {
-	if (Type == PointerType::Property && Prop) 
-		return TMem.SToA(Prop->GetCPPType());
+void JsonState::StartExport(PropertyItem& Item, FString PresetName) {
+	SCOPE_EVENT("PropertyWatcher::JsonExport");
 
-	if (Type == PointerType::Struct)           
-		return TMem.SToA(((UScriptStruct*)StructPtr)->GetStructCPPName());
+	Scratch.Reset();
+	Export = MakeUnique<JsonWriter>(JsonWriter{ Scratch });
+	ExportRoot = GetItemObject(Item);
+	ExportPreset = PresetName;
+	ExportTypeKey = GetItemTypeKey(Item);
+	ExportStatus.Empty();
 
-	if (Type == PointerType::Object && Ptr) {
-		UClass* Class = ((UObject*)Ptr)->GetClass();
-		if (Class) 
-			return TMem.NToA(Class->GetFName());
+	if (ExportRoot.IsValid()) {
+		UpdateExport();
+		return;
 	}
 
-	// Do we really have to do this? Is there no engine function?
-	if (Type == PointerType::Function) {
-		UFunction* Function = (UFunction*)StructPtr;
+	// Memory of other items can be gone in the next frame.
+	if (Item.Type == PointerType::Struct && Item.Ptr && Item.StructPtr)
+		WriteJsonMembers(*Export, Item.StructPtr, Item.Ptr, 0, 0);
+	else if (Item.Type != PointerType::Function && Item.Ptr && Item.Prop)
+		WriteJsonValue(*Export, Item.Prop, Item.Ptr, 0, 0);
+	else
+		Export->Rawf("null");
+	FinishExport();
+}
 
-		FProperty* ReturnProp = Function->GetReturnProperty();
-		FString ts = ReturnProp ? ReturnProp->GetCPPType() : "void";
+// Writes the next chunk, called every frame while an export is running.
+void JsonState::UpdateExport() {
+	if (!Export)
+		return;
 
-		ts += TEXT(" (");
-		int i = 0;
-		for (FProperty* MemberProp : TFieldRange<FProperty>(Function)) {
-			if (MemberProp == ReturnProp) continue;
-			if (i == 1) ts += TEXT(", ");
-			ts += MemberProp->GetCPPType();
-			i++;
-		}
-		ts += TEXT(")");
+	SCOPE_EVENT("PropertyWatcher::JsonExportChunk");
 
-		return TMem.SToA(ts);
+	UObject* Root = ExportRoot.Get();
+	if (!Root) {
+		CancelExport(TEXT("Json export stopped, the object is gone."));
+		return;
 	}
 
-	return "";
-};
+	Export->Depth = 0;
+	Export->Paused = false;
+	Export->ChunkEnd = Scratch.Num() + ExportChunkSize;
+	Export->NextObject = Root;
+	WriteJsonMembers(*Export, Root->GetClass(), Root, Root, 0);
 
-int PropertyItem::GetSize() {
-	if (Prop) 
-		return Prop->GetSize();
+	if (Export->Failed)
+		CancelExport(TEXT("Json export stopped, the object changed while it was written."));
+	else if (Export->Paused)
+		ExportStatus = FString::Printf(TEXT("Writing json, %d KB..."), Scratch.Num() / 1024);
+	else
+		FinishExport();
+}
 
-	else if (Type == PointerType::Object) {
-		UClass* Class = ((UObject*)Ptr)->GetClass();
-		if (Class) 
-			return Class->GetPropertiesSize();
+void JsonState::FinishExport() {
+	if (Export->Truncated) {
+		ExportStatus = FString::Printf(TEXT("Json got cut off at the %d MB or %d levels limit, the values past it are null or missing."), JsonWriter::MaxSize / (1024 * 1024), JsonWriter::MaxDepth);
+		UE_LOG(LogTemp, Warning, TEXT("PropertyWatcher: %s"), *ExportStatus);
+	} else
+		ExportStatus.Empty();
+	Export.Reset();
+
+	if (ExportPreset.IsEmpty()) {
+		Scratch.Push('\0');
+		ImGui::SetClipboardText(Scratch.GetData());
+	} else {
+		JsonPreset* Preset = Presets.FindByPredicate([&](JsonPreset& It) { return It.Name == ExportPreset && It.TypeKey == ExportTypeKey; });
+		if (!Preset)
+			Preset = &Presets.Add_GetRef({ ExportPreset, ExportTypeKey });
+		Preset->Json = Scratch;
+		SavePresets();
+	}
 
-	} else if (Type == PointerType::Struct) 
-		return StructPtr->GetPropertiesSize();
+	// Don't hold on to the memory of a big export.
+	if (Scratch.Max() > JsonWriter::MaxSize / 16)
+		Scratch.Empty();
+	else
+		Scratch.Reset();
+}
 
-	return -1;
-};
+void JsonState::CancelExport(FString Reason) {
+	ExportStatus = Reason;
+	Export.Reset();
+	Scratch.Empty();
+}
 
-int PropertyItem::GetMembers(TArray<PropertyItem>* MemberArray) {
-	if (!Ptr) return 0;
+bool JsonState::Paste(PropertyItem& Item, FAView Json, FString& Error) {
+	SCOPE_EVENT("PropertyWatcher::JsonPaste");
 
-	int Count = 0;
+	PastePlan Plan;
+	if (!Plan.Compile(Json, Item, Error))
+		return false;
+	PendingWrites.Add(MoveTemp(Plan));
+	return true;
+}
 
-	if (Type == PointerType::Object || CastField<FObjectProperty>(Prop)) {
-		UClass* Class = ((UObject*)Ptr)->GetClass();
-		if (!Class) return 0;
-		for (FProperty* MemberProp : TFieldRange<FProperty>(Class)) {
-			if (!MemberArray) { Count++; continue; }
+void JsonState::SavePreset(FString Name, PropertyItem& Item) {
+	StartExport(Item, Name);
+}
 
-			void* MemberPtr = ContainerToValuePointer(PointerType::Object, Ptr, MemberProp);
-			MemberArray->Push(MakePropertyItem(MemberPtr, MemberProp));
-		}
+bool JsonState::ApplyPreset(int PresetIndex, PropertyItem& Item, FString& Error) {
+	JsonPreset& Preset = Presets[PresetIndex];
+	return Paste(Item, FAView(Preset.Json.GetData(), Preset.Json.Num()), Error);
+}
 
-	} else if (Prop &&
-		(Prop->IsA(FWeakObjectProperty::StaticClass()) ||
-			Prop->IsA(FLazyObjectProperty::StaticClass()) ||
-			Prop->IsA(FSoftObjectProperty::StaticClass()))) {
-		UObject* Obj = 0;
-		bool IsValid = GetObjFromObjPointerProp(*this, Obj);
-		if (!IsValid) return 0;
-		else return MakeObjectItem(Obj).GetMembers(MemberArray);
+// Called at the end of the frame, so nothing is iterating over the memory that gets written to.
+void JsonState::ApplyPendingWrites() {
+	if (!PendingWrites.Num())
+		return;
 
-	} else if (FArrayProperty* ArrayProp = CastField<FArrayProperty>(Prop)) {
-		FScriptArrayHelper ScriptArrayHelper(ArrayProp, Ptr);
+	SCOPE_EVENT("PropertyWatcher::ApplyPendingWrites");
+	for (PastePlan& Plan : PendingWrites)
+		Plan.Apply();
+	PendingWrites.Reset();
+}
 
-		if (!MemberArray) return ScriptArrayHelper.Num();
-		FProperty* MemberProp = ArrayProp->Inner;
-		for (int i = 0; i < ScriptArrayHelper.Num(); i++) {
-			void* MemberPtr = ContainerToValuePointer(PointerType::Array, ScriptArrayHelper.GetRawPtr(i), MemberProp);
-			MemberArray->Push(MakeArrayItem(MemberPtr, MemberProp, i));
-		}
+FString JsonState::GetPresetsFilePath() {
+	return FPaths::ProjectSavedDir() / TEXT("PropertyWatcherPresets.json");
+}
 
-	} else if (Type == PointerType::Struct || CastField<FStructProperty>(Prop)) {
-		if (!StructPtr)
-			if (FStructProperty* StructProp = CastField<FStructProperty>(Prop))
-				StructPtr = StructProp->Struct;
+void JsonState::LoadPresets() {
+	PresetsLoaded = true;
 
-		if (StructPtr) {
-			for (FProperty* MemberProp : TFieldRange<FProperty>(StructPtr)) {
-				if (!MemberArray) { Count++; continue; }
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *GetPresetsFilePath(), FILEREAD_Silent))
+		return;
 
-				void* MemberPtr = ContainerToValuePointer(PointerType::Object, Ptr, MemberProp);
-				MemberArray->Push(MakePropertyItem(MemberPtr, MemberProp));
-			}
-		}
+	JsonReader Reader = { FAView((ANSICHAR*)Data.GetData(), Data.Num()) };
+	if (!Reader.Expect('[') || Reader.Consume(']'))
+		return;
 
-	} else if (FMapProperty* MapProp = CastField<FMapProperty>(Prop)) {
-		FScriptMapHelper Helper = FScriptMapHelper(MapProp, Ptr);
-		if (!MemberArray) return Helper.Num();
+	do {
+		JsonPreset Preset;
+		if (!Reader.Expect('{'))
+			return;
+		do {
+			FString Key;
+			if (!Reader.ReadString(Key) || !Reader.Expect(':'))
+				return;
 
-		auto KeyProp = Helper.GetKeyProperty();
-		auto ValueProp = Helper.GetValueProperty();
-		for (int i = 0; i < Helper.Num(); i++) {
-			uint8* KeyPtr = Helper.GetKeyPtr(i);
-			uint8* ValuePtr = Helper.GetValuePtr(i);
-			void* ValuePtr2 = ContainerToValuePointer(PointerType::Map, ValuePtr, ValueProp);
+			bool Result;
+			if (Key == TEXT("name"))
+				Result = Reader.ReadString(Preset.Name);
+			else if (Key == TEXT("type"))
+				Result = Reader.ReadString(Preset.TypeKey);
+			else if (Key == TEXT("value")) {
+				Reader.Peek();
+				int Start = Reader.Pos;
+				Result = Reader.SkipValue();
+				Preset.Json.Append(Reader.Text.GetData() + Start, Reader.Pos - Start);
+			} else
+				Result = Reader.SkipValue();
+			if (!Result)
+				return;
+		} while (Reader.Consume(','));
+		if (!Reader.Expect('}'))
+			return;
 
-			auto KeyItem = MakeArrayItem(KeyPtr, KeyProp, i);
-			auto ValueItem = MakeArrayItem(ValuePtr2, ValueProp, i);
-			TMem.Append(&KeyItem.NameOverwrite, " Key");
-			TMem.Append(&ValueItem.NameOverwrite, " Value");
-			MemberArray->Push(KeyItem);
-			MemberArray->Push(ValueItem);
-		}
+		Presets.Add(MoveTemp(Preset));
+	} while (Reader.Consume(','));
+}
 
-	} else if (FSetProperty* SetProp = CastField<FSetProperty>(Prop)) {
-		FScriptSetHelper Helper = FScriptSetHelper(SetProp, Ptr);
-		if (!MemberArray) return Helper.Num();
+void JsonState::SavePresets() {
+	TArray<ANSICHAR> Data;
+	JsonWriter Writer = { Data };
+	Writer.BeginArray();
+	for (JsonPreset& Preset : Presets) {
+		Writer.BeginObject();
+		Writer.Key("name");
+		Writer.String(Preset.Name);
+		Writer.Key("type");
+		Writer.String(Preset.TypeKey);
+		Writer.Key("value");
+		Writer.RawValue(FAView(Preset.Json.GetData(), Preset.Json.Num()));
+		Writer.EndObject();
+	}
+	Writer.EndArray();
 
-		FProperty* MemberProp = Helper.GetElementProperty();
-		for (int i = 0; i < Helper.Num(); i++) {
-			void* MemberPtr = Helper.Set->GetData(i, Helper.SetLayout);
-			MemberPtr = ContainerToValuePointer(PointerType::Array, MemberPtr, MemberProp);
-			MemberArray->Push(MakeArrayItem(MemberPtr, MemberProp, i));
-		}
+	FFileHelper::SaveArrayToFile(TArrayView<const uint8>((uint8*)Data.GetData(), Data.Num()), *GetPresetsFilePath());
+}
 
-	} else if (FDelegateProperty* DelegateProp = CastField<FDelegateProperty>(Prop)) {
-		//DelegateProp->SignatureFunction
-		auto ScriptDelegate = (TScriptDelegate<FWeakObjectPtr>*)Ptr;
-		if (!MemberArray) return ScriptDelegate->IsBound() ? 1 : 0;
-		if (ScriptDelegate->IsBound()) {
-			UFunction* Function = ScriptDelegate->GetUObject()->FindFunction(ScriptDelegate->GetFunctionName());
-			if (Function)
-				MemberArray->Push(MakeFunctionItem(ScriptDelegate->GetUObject(), Function));
-		}
+FString GetItemTypeKey(PropertyItem& Item) {
+	if (UObject* Obj = GetItemObject(Item))
+		return Obj->GetClass()->GetPathName();
+	if (Item.Type == PointerType::Struct && Item.StructPtr)
+		return Item.StructPtr->GetPathName();
+	if (FStructProperty* StructProp = CastField<FStructProperty>(Item.Prop))
+		return StructProp->Struct->GetPathName();
+	if (Item.Prop)
+		return Item.Prop->GetCPPType();
+	return "";
+}
 
-	} else if (FMulticastDelegateProperty* c = CastField<FMulticastDelegateProperty>(Prop)) {
-		// We would like to call GetAllObjects(), but can't because the invocation list can be invalid and so the function call would fail.
-		// And since there is no way to check if the invocation list is invalid we can't handle this property.
+void DrawJsonPopupControls(PropertyItem& Item) {
+	static FString Error;
+	static char PresetName[64];
 
-		//auto ScriptDelegate = (TMulticastScriptDelegate<FWeakObjectPtr>*)Ptr;
-		//if (ScriptDelegate->IsBound()) {
-		//	auto BoundObjects = ScriptDelegate->GetAllObjects();
-		//	if (!MemberArray) return BoundObjects.Num();
+	if (!JsonIO.PresetsLoaded)
+		JsonIO.LoadPresets();
 
-		//	for (auto Obj : BoundObjects)
-		//		MemberArray->Push(MakeObjectItem(Obj));
-		//} else
-		//	if (!MemberArray) return 0;
+	ImGui::BeginDisabled(JsonIO.Export.IsValid());
+	if (ImGui::Button("Copy json")) {
+		JsonIO.Copy(Item);
+		if (!JsonIO.Export && JsonIO.ExportStatus.IsEmpty())
+			ImGui::CloseCurrentPopup();
+	}
+	ImGui::EndDisabled();
+	ImGuiAddon::QuickTooltip("Copies the values of the item and its subobjects to the clipboard. Big objects take a few frames.");
+
+	ImGui::SameLine();
+	if (ImGui::Button("Paste json")) {
+		const char* Clipboard = ImGui::GetClipboardText();
+		if (JsonIO.Paste(Item, Clipboard ? FAView(Clipboard) : FAView(), Error)) {
+			Error.Empty();
+			ImGui::CloseCurrentPopup();
+		}
 	}
 
-	return Count;
-}
+	ImGui::SetNextItemWidth(ImGui::GetFontSize() * 10);
+	ImGui::InputTextWithHint("##PresetName", "Preset name", PresetName, IM_ARRAYSIZE(PresetName));
+	ImGui::SameLine();
+	ImGui::BeginDisabled(!PresetName[0] || JsonIO.Export.IsValid());
+	if (ImGui::Button("Save preset")) {
+		JsonIO.SavePreset(ANSI_TO_TCHAR(PresetName), Item);
+		PresetName[0] = '\0';
+	}
+	ImGui::EndDisabled();
+
+	FString TypeKey = GetItemTypeKey(Item);
+	for (int i = 0; i < JsonIO.Presets.Num(); i++) {
+		if (JsonIO.Presets[i].TypeKey != TypeKey)
+			continue;
+
+		ImGui::PushID(i); defer{ ImGui::PopID(); };
+		if (ImGui::SmallButton("x")) {
+			JsonIO.Presets.RemoveAt(i--);
+			JsonIO.SavePresets();
+			continue;
+		}
+		ImGui::SameLine();
+		if (ImGui::Selectable(ImGui_StoA(*JsonIO.Presets[i].Name))) {
+			if (JsonIO.ApplyPreset(i, Item, Error)) {
+				Error.Empty();
+				ImGui::CloseCurrentPopup();
+			}
+		}
+	}
 
-int PropertyItem::GetMemberCount() {
-	if (CachedMemberCount != -1)
-		return CachedMemberCount;
+	if (!Error.IsEmpty())
+		ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), ImGui_StoA(*Error));
 
-	CachedMemberCount = GetMembers(0);
-	return CachedMemberCount;
+	if (JsonIO.Export) {
+		ImGui::TextUnformatted(ImGui_StoA(*JsonIO.ExportStatus));
+		ImGui::SameLine();
+		if (ImGui::SmallButton("Cancel"))
+			JsonIO.CancelExport("");
+	} else if (!JsonIO.ExportStatus.IsEmpty())
+		ImGui::TextColored(ImVec4(1, 0.7f, 0.3f, 1), ImGui_StoA(*JsonIO.ExportStatus));
 }
 
 void* ContainerToValuePointer(PointerType Type, void* ContainerPtr, FProperty* MemberProp) {
@@ -1914,11 +6772,13 @@ bool BeginTreeNode(const char* NameID, const char* DisplayName, TreeNodeState& N
 		bool NodeStateChanged = false;
 
 		if (NodeState.HasBranches) {
+			TreeNode* Node = NodeState.Node;
+			if (Node)
+				ImGui::SetNextItemOpen(Node->IsOpen);
+
 			// If force open mode is active we change the state of the node if needed.
 			if (State.ForceToggleNodeOpenClose) {
-				auto StateStorage = ImGui::GetStateStorage();
-				auto ID = ImGui::GetID(NameID);
-				bool IsOpen = (bool)StateStorage->GetInt(ID);
+				bool IsOpen = Node ? Node->IsOpen : (bool)ImGui::GetStateStorage()->GetInt(ImGui::GetID(NameID));
 
 				// Tree node state should change.
 				if (State.ForceToggleNodeMode != IsOpen) {
@@ -1949,6 +6809,13 @@ bool BeginTreeNode(const char* NameID, const char* DisplayName, TreeNodeState& N
 			const char* DisplayText = IsNameNodeVisible ? DisplayName : "";
 			NodeState.IsOpen = ImGui::TreeNodeEx(NameID, Flags, DisplayText);
 
+			if (Node && NodeState.IsOpen != Node->IsOpen) {
+				if (NodeState.IsOpen)
+					Node->ChildrenValid = false;
+				Node->IsOpen = NodeState.IsOpen;
+				NodeCache.MarkChanged(Node->ID);
+			}
+
 			{
 				NodeState.ActivatedForceToggleNodeOpenClose = false;
 
@@ -2039,9 +6906,7 @@ void EndSection(TreeNodeState& NodeState, TreeState& State) {
 	EndTreeNode(NodeState, State);
 }
 
-TArray<FName> GetClassFunctionList(UClass* Class) {
-	TArray<FName> FunctionNames;
-
+void GetClassFunctionList(UClass* Class, TArray<FName>& FunctionNames) {
 #if WITH_EDITOR
 	Class->GenerateFunctionList(FunctionNames);
 #else
@@ -2057,153 +6922,73 @@ TArray<FName> GetClassFunctionList(UClass* Class) {
 		int Offset = offsetof(UClass, Interfaces) - offsetof(TempStruct, Interfaces);
 		auto FuncMap = (TMap<FName, UFunction*>*)(((char*)Class) + Offset);
 		if (FuncMap)
-			FuncMap->GenerateKeyArray(FunctionNames);
+			for (auto& It : *FuncMap)
+				FunctionNames.Add(It.Key);
 	}
 #endif
-
-	return FunctionNames;
 }
 
-TArray<UFunction*> GetObjectFunctionList(UObject* Obj) {
-	TArray<UFunction*> Functions;
-
+StructLayout* GetFunctionLayout(UObject* Obj) {
 	UClass* Class = Obj->GetClass();
 	if (!Class)
-		return Functions;
-
-	UClass* TempClass = Class;
-	do {
-		TArray<FName> FunctionNames = GetClassFunctionList(TempClass);
-		for (auto& Name : FunctionNames) {
-			UFunction* Function = Class->FindFunctionByName(Name);
-			if (!Function)
-				continue;
-			Functions.Push(Function);
-		}
-		TempClass = TempClass->GetSuperClass();
+		return 0;
 
-	} while (TempClass->GetSuperClass());
-
-	return Functions;
+	StructLayout* Layout = GetStructLayout(Class);
+	if (!Layout->FunctionsBuilt)
+		Layout->BuildFunctions();
+	return Layout;
 }
 
 FAView GetItemMetadataCategory(PropertyItem& Item) {
-	FAView Category = "";
-#if WITH_EDITORONLY_DATA											
-	if (Item.Prop) {
-		if (const TMap<FName, FString>* MetaData = Item.Prop->GetMetaDataMap()) {
-			if (const FString* Value = MetaData->Find("Category"))
-				Category = TMem.SToA(*((FString*)Value));
-		}
-	}
-#endif
-	return Category;
+	return Item.Prop ? DisplayTexts.Get(Item.Prop).Category : "";
 }
 
 bool GetItemColor(PropertyItem& Item, ImVec4& Color) {
-	FLinearColor lColor = {};
-	lColor.R = -1;
-
-	// Copied from GraphEditorSettings.cpp
-	static FLinearColor DefaultPinTypeColor(0.750000f, 0.6f, 0.4f, 1.0f);              // light brown
-	static FLinearColor ExecutionPinTypeColor(1.0f, 1.0f, 1.0f, 1.0f);                 // white
-	static FLinearColor BooleanPinTypeColor(0.300000f, 0.0f, 0.0f, 1.0f);              // maroon
-	static FLinearColor BytePinTypeColor(0.0f, 0.160000f, 0.131270f, 1.0f);            // dark green
-	static FLinearColor ClassPinTypeColor(0.1f, 0.0f, 0.5f, 1.0f);                     // deep purple (violet
-	static FLinearColor IntPinTypeColor(0.013575f, 0.770000f, 0.429609f, 1.0f);        // green-blue
-	static FLinearColor Int64PinTypeColor(0.413575f, 0.770000f, 0.429609f, 1.0f);
-	static FLinearColor FloatPinTypeColor(0.357667f, 1.0f, 0.060000f, 1.0f);           // bright green
-	static FLinearColor DoublePinTypeColor(0.039216f, 0.666667f, 0.0f, 1.0f);          // darker green
-	static FLinearColor RealPinTypeColor(0.039216f, 0.666667f, 0.0f, 1.0f);            // darker green
-	static FLinearColor NamePinTypeColor(0.607717f, 0.224984f, 1.0f, 1.0f);            // lilac
-	static FLinearColor DelegatePinTypeColor(1.0f, 0.04f, 0.04f, 1.0f);                // bright red
-	static FLinearColor ObjectPinTypeColor(0.0f, 0.4f, 0.910000f, 1.0f);               // sharp blue
-	static FLinearColor SoftObjectPinTypeColor(0.3f, 1.0f, 1.0f, 1.0f);
-	static FLinearColor SoftClassPinTypeColor(1.0f, 0.3f, 1.0f, 1.0f);
-	static FLinearColor InterfacePinTypeColor(0.8784f, 1.0f, 0.4f, 1.0f);              // pale green
-	static FLinearColor StringPinTypeColor(1.0f, 0.0f, 0.660537f, 1.0f);               // bright pink
-	static FLinearColor TextPinTypeColor(0.8f, 0.2f, 0.4f, 1.0f);                      // salmon (light pink
-	static FLinearColor StructPinTypeColor(0.0f, 0.1f, 0.6f, 1.0f);                    // deep blue
-	static FLinearColor WildcardPinTypeColor(0.220000f, 0.195800f, 0.195800f, 1.0f);   // dark gray
-	static FLinearColor VectorPinTypeColor(1.0f, 0.591255f, 0.016512f, 1.0f);          // yellow
-	static FLinearColor RotatorPinTypeColor(0.353393f, 0.454175f, 1.0f, 1.0f);         // periwinkle
-	static FLinearColor TransformPinTypeColor(1.0f, 0.172585f, 0.0f, 1.0f);            // orange
-	static FLinearColor IndexPinTypeColor(0.013575f, 0.770000f, 0.429609f, 1.0f);      // green-blue
-
 	if (!Item.Prop)
 		return false;
 
-	if (Item.Prop->IsA(FBoolProperty::StaticClass()))      lColor = BooleanPinTypeColor;
-	else if (Item.Prop->IsA(FByteProperty::StaticClass()))      lColor = BytePinTypeColor;
-	else if (Item.Prop->IsA(FClassProperty::StaticClass()))     lColor = ClassPinTypeColor;
-	else if (Item.Prop->IsA(FIntProperty::StaticClass()))       lColor = IntPinTypeColor;
-	else if (Item.Prop->IsA(FInt64Property::StaticClass()))     lColor = Int64PinTypeColor;
-	else if (Item.Prop->IsA(FFloatProperty::StaticClass()))     lColor = FloatPinTypeColor;
-	else if (Item.Prop->IsA(FDoubleProperty::StaticClass()))    lColor = DoublePinTypeColor;
-	//else if (Item.Prop->IsA(FRealproperty::StaticClass()))    lColor = ;
-	else if (Item.Prop->IsA(FNameProperty::StaticClass()))      lColor = NamePinTypeColor;
-	else if (Item.Prop->IsA(FDelegateProperty::StaticClass()))  lColor = DelegatePinTypeColor;
-	else if (Item.Prop->IsA(FObjectProperty::StaticClass()))    lColor = ObjectPinTypeColor;
-	else if (Item.Prop->IsA(FSoftClassProperty::StaticClass())) lColor = SoftClassPinTypeColor;
-	else if (Item.Prop->IsA(FInterfaceProperty::StaticClass())) lColor = InterfacePinTypeColor;
-	else if (Item.Prop->IsA(FStrProperty::StaticClass()))       lColor = StringPinTypeColor;
-	else if (Item.Prop->IsA(FTextProperty::StaticClass()))      lColor = TextPinTypeColor;
-
-	else if (FStructProperty* StructProp = CastField<FStructProperty>(Item.Prop)) {
-		FString Extended;
-		FString StructType = StructProp->GetCPPType(&Extended, 0);
-		if (StructType == "FVector")    lColor = VectorPinTypeColor;
-		else if (StructType == "FRotator")   lColor = RotatorPinTypeColor;
-		else if (StructType == "FTransform") lColor = TransformPinTypeColor;
-		else                                 lColor = StructPinTypeColor;
-	}
-
-	bool ColorGotSet = lColor.R != -1;
-	if (ColorGotSet) {
-		FColor c = lColor.ToFColor(true);
-		Color = { c.R / 255.0f, c.G / 255.0f, c.B / 255.0f, c.A / 255.0f };
-		return true;
-	}
-
-	return false;
+	const PropertyTagInfo& Info = GetTagInfo(Item.GetTag());
+	if (Info.HasColor)
+		Color = Info.Color;
+	return Info.HasColor;
 }
 
 bool GetObjFromObjPointerProp(PropertyItem& Item, UObject*& Object) {
-	if (Item.Prop &&
-		(Item.Prop->IsA(FWeakObjectProperty::StaticClass()) ||
-			Item.Prop->IsA(FLazyObjectProperty::StaticClass()) ||
-			Item.Prop->IsA(FSoftObjectProperty::StaticClass()))) {
-		bool IsValid = false;
-		UObject* Obj = 0;
-		if (Item.Prop->IsA(FWeakObjectProperty::StaticClass())) {
-			IsValid = ((TWeakObjectPtr<UObject>*)Item.Ptr)->IsValid();
-			Obj = ((TWeakObjectPtr<UObject>*)Item.Ptr)->Get();
+	if (!Item.Prop)
+		return false;
 
-		} else if (Item.Prop->IsA(FLazyObjectProperty::StaticClass())) {
+	bool IsValid = false;
+	switch (Item.GetTag()) {
+		case Tag_WeakObject: {
+			IsValid = ((TWeakObjectPtr<UObject>*)Item.Ptr)->IsValid();
+			Object = ((TWeakObjectPtr<UObject>*)Item.Ptr)->Get();
+		} break;
+		case Tag_LazyObject: {
 			IsValid = ((TLazyObjectPtr<UObject>*)Item.Ptr)->IsValid();
-			Obj = ((TLazyObjectPtr<UObject>*)Item.Ptr)->Get();
-
-		} else if (Item.Prop->IsA(FSoftObjectProperty::StaticClass())) {
+			Object = ((TLazyObjectPtr<UObject>*)Item.Ptr)->Get();
+		} break;
+		case Tag_SoftObject:
+		case Tag_SoftClass: {
 			IsValid = ((TSoftObjectPtr<UObject>*)Item.Ptr)->IsValid();
-			Obj = ((TSoftObjectPtr<UObject>*)Item.Ptr)->Get();
-		}
-		Object = Obj;
-		return IsValid;
+			Object = ((TSoftObjectPtr<UObject>*)Item.Ptr)->Get();
+		} break;
+		default: Object = 0;
 	}
 
-	return false;
+	return IsValid;
 }
 
 // -------------------------------------------------------------------------------------------
 
-void SimpleSearchParser::ParseExpression(FAView str, TArray<FAView> _Columns) {
+void SimpleSearchParser::ParseExpression(FAView str, const TArray<FAView>& _Columns) {
 	Commands.Empty();
 
+	// Inline storage instead of TMem since the search indexer parses on a worker thread.
 	struct StackInfo {
-		TArray<Test> Tests = { {} };
-		TArray<Operator> OPs;
+		TArray<Test, TInlineAllocator<16>> Tests = { {} };
+		TArray<Operator, TInlineAllocator<8>> OPs;
 	};
-	TArray<StackInfo> Stack = { {} };
+	TArray<StackInfo, TInlineAllocator<8>> Stack = { {} };
 
 	auto EatToken = [&str](FAView Token) -> bool {
 		if (str.StartsWith(Token)) {
@@ -2295,55 +7080,152 @@ void SimpleSearchParser::ParseExpression(FAView str, TArray<FAView> _Columns) {
 			}
 		}
 	}
+
+	Compile();
 }
 
-bool SimpleSearchParser::ApplyTests(CachedColumnText& ColumnTexts) {
-	TArray<bool> Bools;
-	for (auto Command : Commands) {
+void SimpleSearchParser::Compile() {
+	Tests.Empty();
+	Program.Empty();
+	StackDepth = 0;
+
+	for (auto& Command : Commands) {
 		if (Command.Type == Command_Test) {
 			Test& Tst = Command.Tst;
-			FAView* FoundString = ColumnTexts.Get(Tst.ColumnID);
-			if (!FoundString)
-				continue;
-			FAView ColStr = *FoundString;
-
-			bool Result;
-			if     (!Tst.Mod)                     Result = StringView_Contains<ANSICHAR>(ColStr, Tst.Ident);
-			else if (Tst.Mod == Mod_Exact)        Result = ColStr.Equals(Tst.Ident, ESearchCase::IgnoreCase);
-			else if (Tst.Mod == Mod_Equal)        Result = ColStr.Len() ? FCStringAnsi::Atod(*ColStr) == FCStringAnsi::Atod(*Tst.Ident) : false;
-			else if (Tst.Mod == Mod_Greater)      Result = ColStr.Len() ? FCStringAnsi::Atod(*ColStr) >  FCStringAnsi::Atod(*Tst.Ident) : false;
-			else if (Tst.Mod == Mod_Less)         Result = ColStr.Len() ? FCStringAnsi::Atod(*ColStr) <  FCStringAnsi::Atod(*Tst.Ident) : false;
-			else if (Tst.Mod == Mod_GreaterEqual) Result = ColStr.Len() ? FCStringAnsi::Atod(*ColStr) >= FCStringAnsi::Atod(*Tst.Ident) : false;
-			else if (Tst.Mod == Mod_LessEqual)    Result = ColStr.Len() ? FCStringAnsi::Atod(*ColStr) <= FCStringAnsi::Atod(*Tst.Ident) : false;
-
-			else if (Tst.Mod == Mod_Regex) {
-				FRegexMatcher RegMatcher(FRegexPattern(*Tst.Ident), *ColStr);
-				Result = RegMatcher.FindNext();
+			CompiledTest& Compiled = Tests.AddDefaulted_GetRef();
+			Compiled.Mod = Tst.Mod;
+			Compiled.ColumnID = Tst.ColumnID;
+
+			// Ident is a view into the search string, so it's not null terminated.
+			FString IdentString(Tst.Ident);
+			if (!Tst.Mod || Tst.Mod == Mod_Exact) {
+				Compiled.FoldedIdent.Reserve(Tst.Ident.Len());
+				for (ANSICHAR c : Tst.Ident)
+					Compiled.FoldedIdent.Push(FoldChar(c));
 			}
-			Bools.Push(Result);
+
+			if (Tst.Mod == Mod_Exact && Tst.ColumnID == ColumnID_Name)
+				Compiled.Name = FName(*IdentString, FNAME_Find);
+			else if (Tst.Mod == Mod_Regex)
+				Compiled.Regex.Emplace(IdentString);
+			else if (Tst.Mod >= Mod_Equal)
+				Compiled.Number = FCString::Atod(*IdentString);
+
+			Program.Push({ OpCode_Test, Tests.Num() - 1 });
 
 		} else if (Command.Type == Command_Op) {
-			if (Command.Op == OP_And) {
-				if (Bools.Num() > 1) {
-					Bools[Bools.Num() - 2] &= Bools.Last();
-					Bools.Pop();
-				}
+			if      (Command.Op == OP_And) Program.Push({ OpCode_And, 0 });
+			else if (Command.Op == OP_Or)  Program.Push({ OpCode_Or, 0 });
+			else if (Command.Op == OP_Not) Program.Push({ OpCode_Not, 0 });
+		}
+	}
 
-			} else if (Command.Op == OP_Or) {
-				if (Bools.Num() > 1) {
-					Bools[Bools.Num() - 2] |= Bools.Last();
-					Bools.Pop();
-				}
+	// Same stack moves as ApplyTests with every test pushing, so it's an upper bound.
+	int Depth = 0;
+	for (Instruction& Inst : Program) {
+		if (Inst.Code == OpCode_Test)
+			StackDepth = FMath::Max(StackDepth, ++Depth);
+		else if ((Inst.Code == OpCode_And || Inst.Code == OpCode_Or) && Depth > 1)
+			Depth--;
+	}
+}
 
-			} else if (Command.Op == OP_Not)
-				Bools.Last() = !Bools.Last();
+bool SimpleSearchParser::ApplyTests(CachedColumnText& ColumnTexts) {
+	SCOPE_EVENT("PropertyWatcher::SimpleSearchParser::ApplyTests");
+
+	TArray<bool, TInlineAllocator<InlineStackSize>> Stack;
+	Stack.SetNumUninitialized(StackDepth);
+	int StackSize = 0;
+	for (Instruction& Inst : Program) {
+		switch (Inst.Code) {
+		case OpCode_Test: {
+			bool Result;
+			if (RunTest(Tests[Inst.TestIndex], ColumnTexts, Result))
+				Stack[StackSize++] = Result;
+		} break;
+		case OpCode_And: {
+			if (StackSize > 1) {
+				Stack[StackSize - 2] &= Stack[StackSize - 1];
+				StackSize--;
+			}
+		} break;
+		case OpCode_Or: {
+			if (StackSize > 1) {
+				Stack[StackSize - 2] |= Stack[StackSize - 1];
+				StackSize--;
+			}
+		} break;
+		case OpCode_Not: {
+			if (StackSize)
+				Stack[StackSize - 1] = !Stack[StackSize - 1];
+		} break;
 		}
 	}
 
-	if (Bools.Num())
-		return Bools[0];
-	else
+	return StackSize ? Stack[0] : false;
+}
+
+bool SimpleSearchParser::RunTest(CompiledTest& Tst, CachedColumnText& ColumnTexts, bool& Result) {
+	FAView* FoundString = ColumnTexts.Get(Tst.ColumnID);
+	if (!FoundString)
+		return false;
+	FAView ColStr = *FoundString;
+
+	FAView Ident(Tst.FoldedIdent.GetData(), Tst.FoldedIdent.Num());
+	switch (Tst.Mod) {
+	case 0:                Result = FoldedContains(ColStr, Ident); break;
+	case Mod_Exact: {
+		if (!Tst.Name.IsNone() && !ColumnTexts.Name.IsNone() && Tst.ColumnID == ColumnID_Name)
+			Result = ColumnTexts.Name == Tst.Name; // Names are case insensitive, same as the text compare.
+		else
+			Result = FoldedEquals(ColStr, Ident);
+	} break;
+	case Mod_Equal:        Result = ColStr.Len() ? FCStringAnsi::Atod(*ColStr) == Tst.Number : false; break;
+	case Mod_Greater:      Result = ColStr.Len() ? FCStringAnsi::Atod(*ColStr) >  Tst.Number : false; break;
+	case Mod_Less:         Result = ColStr.Len() ? FCStringAnsi::Atod(*ColStr) <  Tst.Number : false; break;
+	case Mod_GreaterEqual: Result = ColStr.Len() ? FCStringAnsi::Atod(*ColStr) >= Tst.Number : false; break;
+	case Mod_LessEqual:    Result = ColStr.Len() ? FCStringAnsi::Atod(*ColStr) <= Tst.Number : false; break;
+	case Mod_Regex: {
+		RegexInput.Reset();
+		RegexInput.AppendChars(ColStr.GetData(), ColStr.Len());
+		FRegexMatcher RegMatcher(*Tst.Regex, RegexInput);
+		Result = RegMatcher.FindNext();
+	} break;
+	default: Result = false;
+	}
+	return true;
+}
+
+bool FoldedContains(FAView Text, FAView FoldedSearch) {
+	int SearchLen = FoldedSearch.Len();
+	if (!SearchLen)
+		return true;
+
+	const ANSICHAR* T = Text.GetData();
+	const ANSICHAR* S = FoldedSearch.GetData();
+	ANSICHAR First = S[0];
+	int LastStart = Text.Len() - SearchLen;
+	for (int i = 0; i <= LastStart; i++) {
+		if (FoldChar(T[i]) != First)
+			continue;
+
+		int j = 1;
+		while (j < SearchLen && FoldChar(T[i + j]) == S[j])
+			j++;
+		if (j == SearchLen)
+			return true;
+	}
+	return false;
+}
+
+bool FoldedEquals(FAView Text, FAView FoldedSearch) {
+	if (Text.Len() != FoldedSearch.Len())
 		return false;
+
+	for (int i = 0; i < Text.Len(); i++)
+		if (FoldChar(Text[i]) != FoldedSearch[i])
+			return false;
+	return true;
 }
 
 FAView SimpleSearchParser::Command::ToString() {
@@ -2460,7 +7342,7 @@ const char* SearchBoxHelpText =
 	"	Value Comparisons -> =value, >value, <value, >=value, <=value\n"
 	"\n"
 	"Specify table column entries like this:\n"
-	"	name:, value:, metadata:, type:, cpptype:, class:, category:, address:, size:\n"
+	"	name:, value:, metadata:, type:, cpptype:, class:, category:, address:, size:, distance:\n"
 	"\n"
 	"	(name: is default, so the search term \"varName\" searches the property name column.)\n"
 	"\n"
@@ -2476,14 +7358,252 @@ const char* HelpText =
 	"Shift click + digit on a node -> Specify how many layers to open.\n"
 	"  Usefull since doing open all on an actor for example can open a whole lot of things.\n"
 	"\n"
-	"Right click on an item to inline it.\n"
+	"Right click on an item to inline it or take a memory snapshot.\n"
+	"\n"
+	"Deep Search button searches closed items as well.\n"
+	"F3/Shift+F3 -> Go to next/previous deep search result.\n"
 	;
 
 // -------------------------------------------------------------------------------------------
 
+TRACE_DECLARE_INT_COUNTER(PropertyWatcher_RowsVisited, TEXT("PropertyWatcher/RowsVisited"));
+TRACE_DECLARE_INT_COUNTER(PropertyWatcher_RowsDrawn, TEXT("PropertyWatcher/RowsDrawn"));
+TRACE_DECLARE_INT_COUNTER(PropertyWatcher_ReflectionWalks, TEXT("PropertyWatcher/ReflectionWalks"));
+TRACE_DECLARE_INT_COUNTER(PropertyWatcher_StringConversions, TEXT("PropertyWatcher/StringConversions"));
+TRACE_DECLARE_INT_COUNTER(PropertyWatcher_WatchResolves, TEXT("PropertyWatcher/WatchResolves"));
+TRACE_DECLARE_MEMORY_COUNTER(PropertyWatcher_TMemBytes, TEXT("PropertyWatcher/TMemBytes"));
+
+// Runs after TMem.Reset() so the arena size of this frame is known.
+void FrameCounters::Emit() {
+	TRACE_COUNTER_SET(PropertyWatcher_RowsVisited, RowsVisited);
+	TRACE_COUNTER_SET(PropertyWatcher_RowsDrawn, RowsDrawn);
+	TRACE_COUNTER_SET(PropertyWatcher_ReflectionWalks, ReflectionWalks);
+	TRACE_COUNTER_SET(PropertyWatcher_StringConversions, StringConversions);
+	TRACE_COUNTER_SET(PropertyWatcher_WatchResolves, WatchResolves);
+	TRACE_COUNTER_SET(PropertyWatcher_TMemBytes, TMem.LastFrameBytes);
+	*this = {};
+}
+
+bool MallocCounter::IsAvailable() {
+#if PLATFORM_USES_FIXED_GMalloc_CLASS
+	return false; // FMemory calls the allocator class directly, GMalloc is never asked.
+#else
+	return true;
+#endif
+}
+
+void MallocCounter::Install() {
+	if (HeapCounter || !IsAvailable())
+		return;
+
+	// Reused after being taken out, a thread that read GMalloc before the swap could still call it.
+	static MallocCounter* Counter = 0;
+	if (!Counter)
+		Counter = new MallocCounter(GMalloc);
+	Counter->Inner = GMalloc;
+	Counter->Counting = false;
+	HeapCounter = Counter;
+	GMalloc = Counter;
+}
+
+bool MallocCounter::Uninstall() {
+	if (!HeapCounter)
+		return true;
+	if (GMalloc != HeapCounter)
+		return false;
+	HeapCounter->Counting = false;
+	GMalloc = HeapCounter->Inner;
+	HeapCounter = 0;
+	return true;
+}
+
+void MallocCounter::StartCounting() {
+	if (!HeapCounter)
+		return;
+	HeapCounter->Allocations = 0;
+	HeapCounter->Counting = true;
+}
+
+int MallocCounter::StopCounting() {
+	if (!HeapCounter)
+		return -1;
+	HeapCounter->Counting = false;
+	return HeapCounter->Allocations;
+}
+
+const char* ProfilePhaseNames[Phase_Count] = {
+	"Frame", "Search parse", "Objects tab", "Actors tab", "Watch tab", "Snapshots tab", "Watch resolve", "Reflection walk", "String conversion",
+};
+
+void FrameProfiler::BeginFrame() {
+	FrameStart = FPlatformTime::Seconds();
+	for (auto& It : PhaseTimes)
+		It = 0;
+
+	if (HeapCounter) {
+		HeapCounter->Allocations = 0;
+		HeapCounter->Counting = Enabled;
+	}
+}
+
+// Runs after TMem.Reset() and before the counters get cleared.
+void FrameProfiler::EndFrame() {
+	if (HeapCounter)
+		HeapCounter->Counting = false;
+	if (!Enabled)
+		return;
+
+	PhaseTimes[Phase_Frame] = FPlatformTime::Seconds() - FrameStart;
+	if (!Samples.Num())
+		Samples.SetNumZeroed(MaxWindow);
+
+	Sample& S = Samples[SampleIndex];
+	for (int i = 0; i < Phase_Count; i++)
+		S.Ms[i] = PhaseTimes[i] * 1000.0;
+	S.TMemBytes = TMem.LastFrameBytes;
+	S.HeapAllocations = HeapCounter ? HeapCounter->Allocations : -1;
+	S.RowsVisited = Counters.RowsVisited;
+	S.RowsDrawn = Counters.RowsDrawn;
+
+	SampleIndex = (SampleIndex + 1) % MaxWindow;
+	SampleCount = FMath::Min(SampleCount + 1, MaxWindow);
+}
+
+float FrameProfiler::GetAverageMs(ProfilePhase Phase) {
+	int Count = FMath::Min(Window, SampleCount);
+	if (!Count)
+		return 0;
+
+	float Sum = 0;
+	for (int i = 0; i < Count; i++)
+		Sum += Samples[(SampleIndex - 1 - i + MaxWindow) % MaxWindow].Ms[Phase];
+	return Sum / Count;
+}
+
+void FrameProfiler::DrawWindow(bool* IsOpen) {
+	ImGui::SetNextWindowSize(ImVec2(520, 440), ImGuiCond_FirstUseEver);
+	bool WindowIsOpen = ImGui::Begin("Property Watcher: Profiler", IsOpen); defer{ ImGui::End(); };
+	if (!WindowIsOpen)
+		return;
+
+	ImGui::SetNextItemWidth(150);
+	ImGui::SliderInt("Window (frames)", &Window, 30, MaxWindow);
+	ImGui::SameLine();
+	static bool UninstallFailed = false;
+	bool CountHeapAllocations = HeapCounter != 0;
+	ImGui::BeginDisabled(!MallocCounter::IsAvailable());
+	if (ImGui::Checkbox("Count heap allocations", &CountHeapAllocations)) {
+		if (CountHeapAllocations)
+			MallocCounter::Install();
+		else
+			UninstallFailed = !MallocCounter::Uninstall();
+	}
+	ImGui::EndDisabled();
+	if (!MallocCounter::IsAvailable())
+		ImGuiAddon::QuickTooltip("Unavailable, this platform calls its allocator directly instead of going through GMalloc.", ImGuiHoveredFlags_DelayNormal | ImGuiHoveredFlags_AllowWhenDisabled);
+	else if (UninstallFailed && HeapCounter)
+		ImGuiAddon::QuickTooltip("Can't be turned off, another allocator got put in front of it.");
+	else
+		ImGuiAddon::QuickTooltip("Puts a counting allocator in front of GMalloc while it's on.");
+
+	int Count = FMath::Min(Window, SampleCount);
+	if (!Count) {
+		ImGui::TextDisabled("No samples yet.");
+		return;
+	}
+
+	auto GetSample = [&](int i) -> Sample& { return Samples[(SampleIndex - 1 - i + MaxWindow) % MaxWindow]; };
+
+	// Values get sorted, percentiles are nearest rank.
+	TempArray<float> Values;
+	auto Percentile = [&Values](float P) { return Values[FMath::Clamp((int)(P * (Values.Num() - 1) + 0.5f), 0, Values.Num() - 1)]; };
+
+	ImGuiTableFlags TableFlags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders;
+	if (ImGui::BeginTable("Phases", 6, TableFlags)) {
+		const char* Headers[] = { "Phase (ms)", "avg", "p50", "p95", "p99", "max" };
+		for (auto It : Headers)
+			ImGui::TableSetupColumn(It);
+		ImGui::TableHeadersRow();
+
+		for (int Phase = 0; Phase < Phase_Count; Phase++) {
+			Values.Reset();
+			float Sum = 0;
+			for (int i = 0; i < Count; i++) {
+				Values.Push(GetSample(i).Ms[Phase]);
+				Sum += Values.Last();
+			}
+			Values.Sort();
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(ProfilePhaseNames[Phase]);
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", Sum / Count);
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", Percentile(0.50f));
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", Percentile(0.95f));
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", Percentile(0.99f));
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", Values.Last());
+		}
+		ImGui::EndTable();
+	}
+
+	if (ImGui::BeginTable("Counts", 6, TableFlags)) {
+		const char* Headers[] = { "Per frame", "avg", "p50", "p95", "p99", "max" };
+		for (auto It : Headers)
+			ImGui::TableSetupColumn(It);
+		ImGui::TableHeadersRow();
+
+		auto CountRow = [&](const char* Name, int Sample::* Member) {
+			Values.Reset();
+			float Sum = 0;
+			for (int i = 0; i < Count; i++) {
+				int Value = GetSample(i).*Member;
+				if (Value < 0) // Not counted in that frame.
+					continue;
+				Values.Push(Value);
+				Sum += Value;
+			}
+			if (!Values.Num())
+				return;
+			Values.Sort();
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(Name);
+			ImGui::TableNextColumn(); ImGui::Text("%.0f", Sum / Values.Num());
+			ImGui::TableNextColumn(); ImGui::Text("%.0f", Percentile(0.50f));
+			ImGui::TableNextColumn(); ImGui::Text("%.0f", Percentile(0.95f));
+			ImGui::TableNextColumn(); ImGui::Text("%.0f", Percentile(0.99f));
+			ImGui::TableNextColumn(); ImGui::Text("%.0f", Values.Last());
+		};
+		CountRow("TMem bytes", &Sample::TMemBytes);
+		CountRow("Heap allocations", &Sample::HeapAllocations);
+		CountRow("Rows visited", &Sample::RowsVisited);
+		CountRow("Rows drawn", &Sample::RowsDrawn);
+		ImGui::EndTable();
+	}
+
+	// Frame time histogram.
+	{
+		float MaxMs = 0;
+		for (int i = 0; i < Count; i++)
+			MaxMs = FMath::Max(MaxMs, GetSample(i).Ms[Phase_Frame]);
+
+		float Buckets[HistogramBuckets] = {};
+		for (int i = 0; i < Count; i++) {
+			int Bucket = MaxMs > 0 ? (int)(GetSample(i).Ms[Phase_Frame] / MaxMs * HistogramBuckets) : 0;
+			Buckets[FMath::Min(Bucket, HistogramBuckets - 1)]++;
+		}
+
+		ImGui::Spacing();
+		ImGui::Text("Frame times, 0 - %.3f ms:", MaxMs);
+		ImGui::PlotHistogram("##FrameTimes", Buckets, HistogramBuckets, 0, 0, 0, FLT_MAX, ImVec2(-1, 80));
+	}
+}
+
+// -------------------------------------------------------------------------------------------
+
 char* TempMemoryPool::MemBucket::Get(int Count) {
 	char* Result = Data + Position;
 	Position += Count;
+	HighPosition = FMath::Max(HighPosition, Position);
 	return Result;
 }
 
@@ -2498,8 +7618,8 @@ void TempMemoryPool::Init(int _StartSize) {
 		AddBucket();
 }
 
-void TempMemoryPool::AddBucket() {
-	int BucketSize = Buckets.Num() == 0 ? StartSize : Buckets.Last().Size * 2; // Double every bucket.
+void TempMemoryPool::AddBucket(int Size) {
+	int BucketSize = Size ? Size : Buckets.Num() == 0 ? StartSize : Buckets.Last().Size * 2; // Double every bucket.
 	MemBucket Bucket = {};
 	Bucket.Data = (char*)FMemory::Malloc(BucketSize);
 	Bucket.Size = BucketSize;
@@ -2511,14 +7631,51 @@ void TempMemoryPool::ClearAll() {
 		FMemory::Free(It.Data);
 	Buckets.Empty();
 	CurrentBucketIndex = 0;
+	MaxBucketIndex = 0;
 
 	Markers.Empty();
 }
 
+// End of frame. Keeps the memory, the buckets only get merged when the frame didn't fit into the first one,
+// or shrunk every few seconds when the peak went down a lot.
+void TempMemoryPool::Reset() {
+	int Needed = 0;
+	for (int i = 0; i <= MaxBucketIndex && i < Buckets.Num(); i++) {
+		Needed += Buckets[i].HighPosition;
+		Buckets[i].Position = 0;
+		Buckets[i].HighPosition = 0;
+	}
+	HighWater = FMath::Max(Needed, HighWater - HighWater / 256);
+	LastFrameBytes = Needed;
+
+	bool Overflowed = MaxBucketIndex > 0;
+	CurrentBucketIndex = 0;
+	MaxBucketIndex = 0;
+	Markers.Reset();
+
+	int WantedSize = FMath::RoundUpToPowerOfTwo(FMath::Max(StartSize, HighWater + HighWater / 4));
+	if (Overflowed)
+		Coalesce(WantedSize);
+	else if (++FramesSinceShrink >= ShrinkInterval) {
+		FramesSinceShrink = 0;
+		if (Buckets.Num() && Buckets[0].Size > WantedSize * 4)
+			Coalesce(WantedSize);
+	}
+}
+
+void TempMemoryPool::Coalesce(int Size) {
+	for (auto& It : Buckets)
+		FMemory::Free(It.Data);
+	Buckets.Reset();
+	AddBucket(Size);
+	FramesSinceShrink = 0;
+}
+
 void TempMemoryPool::GoToNextBucket() {
 	if (!Buckets.IsValidIndex(CurrentBucketIndex + 1))
 		AddBucket();
 	CurrentBucketIndex++;
+	MaxBucketIndex = FMath::Max(MaxBucketIndex, CurrentBucketIndex);
 }
 
 char* TempMemoryPool::Get(int Count) {
@@ -2528,19 +7685,25 @@ char* TempMemoryPool::Get(int Count) {
 	return GetCurrentBucket().Get(Count);
 }
 
-void TempMemoryPool::Free(int Count) {
-	int BytesToFree = Count;
+char* TempMemoryPool::Get(int Count, int Alignment) {
 	while (true) {
-		auto Bucket = GetCurrentBucket();
-		int BucketBytesToFree = FMath::Min(Bucket.Position, BytesToFree);
-		Bucket.Free(BucketBytesToFree);
-		BytesToFree -= BucketBytesToFree;
-		if (BytesToFree)
-			break;
-		GoToPrevBucket();
+		MemBucket& Bucket = GetCurrentBucket();
+		int Padding = (int)(Align((UPTRINT)(Bucket.Data + Bucket.Position), Alignment) - (UPTRINT)(Bucket.Data + Bucket.Position));
+		if (Bucket.MemoryFits(Padding + Count)) {
+			Bucket.Get(Padding);
+			return Bucket.Get(Count);
+		}
+		GoToNextBucket();
 	}
 }
 
+// Frees the last allocation, which is always in the current bucket.
+void TempMemoryPool::Free(int Count) {
+	MemBucket& Bucket = GetCurrentBucket();
+	check(Count <= Bucket.Position);
+	Bucket.Free(Count);
+}
+
 void TempMemoryPool::PushMarker() {
 	Markers.Add({ CurrentBucketIndex, Buckets[CurrentBucketIndex].Position });
 }
@@ -2560,6 +7723,31 @@ void TempMemoryPool::PopMarker(bool Free) {
 	Markers.Pop(false);
 }
 
+void TempMemoryAllocator::ForAnyElementType::ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement) {
+	int NewBytes = NumElements * NumBytesPerElement;
+	if (!NewBytes) {
+		Data = 0;
+		AllocatedBytes = 0;
+		return;
+	}
+	if (NewBytes <= AllocatedBytes)
+		return;
+
+	// Still the last thing in the bucket, just move the position.
+	TempMemoryPool::MemBucket& Bucket = TMem.GetCurrentBucket();
+	if (Data && Data + AllocatedBytes == Bucket.Data + Bucket.Position && Bucket.MemoryFits(NewBytes - AllocatedBytes)) {
+		Bucket.Get(NewBytes - AllocatedBytes);
+		AllocatedBytes = NewBytes;
+		return;
+	}
+
+	char* NewData = TMem.Get(NewBytes, FMath::Max((int)AlignmentOfElement, 1));
+	if (Data && PreviousNumElements)
+		FMemory::Memcpy(NewData, Data, PreviousNumElements * NumBytesPerElement);
+	Data = NewData;
+	AllocatedBytes = NewBytes;
+}
+
 // Copied from FString::Printf().
 FAView TempMemoryPool::Printf(const char* Fmt, ...) {
 	int BufferSize = 128;
@@ -2586,6 +7774,8 @@ FAView TempMemoryPool::Printf(const char* Fmt, ...) {
 
 // Copied partially from StringCast.
 FAView TempMemoryPool::CToA(const TCHAR* SrcBuffer, int SrcLen) {
+	PROFILE_PHASE(Phase_StringConversion);
+	Counters.StringConversions++;
 	int StringLength = TStringConvert<TCHAR, ANSICHAR>::ConvertedLength(SrcBuffer, SrcLen);
 	int32 BufferSize = StringLength;
 	ANSICHAR* Buffer = (ANSICHAR*)Get(BufferSize + 1);
@@ -2597,19 +7787,600 @@ FAView TempMemoryPool::CToA(const TCHAR* SrcBuffer, int SrcLen) {
 }
 
 // I wish there was a way to get the FName data ansi pointer directly instead of having to copy it.
-FAView TempMemoryPool::NToA(FName Name) {
+FAView NameInternTable::Get(FName Name) {
+	uint64 Key = (uint64)Name.GetDisplayIndex().ToUnstableInt() | (uint64)Name.GetNumber() << 32;
+	if (FAView* Found = Views.Find(Key))
+		return *Found;
+
+	if (!Storage.IsInitialized)
+		Storage.Init(16 * 1024);
+
 	const FNameEntry* NameEntry = Name.GetDisplayNameEntry();
-	if (NameEntry->IsWide())
-		return "<WideFNameError>";
+	ANSICHAR Text[NAME_SIZE * 3 + 16]; // Utf8 can take 3 bytes per wide char.
+	int Len;
+	if (!NameEntry->IsWide()) {
+		ANSICHAR AnsiName[NAME_SIZE];
+		NameEntry->GetAnsiName(AnsiName);
+		Len = NameEntry->GetNameLength();
+		FMemory::Memcpy(Text, AnsiName, Len);
 
-	int Len = NameEntry->GetNameLength();
-	ANSICHAR* Buffer = Get(Len + 1);
-	NameEntry->GetAnsiName((ANSICHAR(&)[NAME_SIZE])(*Buffer));
+	} else {
+		WIDECHAR WideName[NAME_SIZE];
+		NameEntry->GetWideName(WideName);
+		FTCHARToUTF8 Converted(WideName, NameEntry->GetNameLength());
+		Len = Converted.Length();
+		FMemory::Memcpy(Text, Converted.Get(), Len);
+	}
+	if (Name.GetNumber() != NAME_NO_NUMBER_INTERNAL)
+		Len += FCStringAnsi::Sprintf(Text + Len, "_%d", NAME_INTERNAL_TO_EXTERNAL(Name.GetNumber()));
+
+	ANSICHAR* Buffer = Storage.Get(Len + 1);
+	FMemory::Memcpy(Buffer, Text, Len);
+	Buffer[Len] = '\0';
 
 	FAView View(Buffer, Len);
+	Views.Add(Key, View);
 	return View;
 }
 
+// -------------------------------------------------------------------------------------------
+
+#if PROPERTY_WATCHER_BENCHMARKS
+
+// Frames of nested scopes with small allocations, roughly what drawing a big open tree does.
+// Compares the pool against freeing it every frame (the old behaviour) and FMemStack.
+void BenchmarkTempMemory(const TArray<FString>& Args) {
+	int Frames = Args.Num() ? FCString::Atoi(*Args[0]) : 1000;
+	const int StepsPerFrame = 4000;
+	const int MaxDepth = 16;
+
+	auto Run = [&](auto&& PushScope, auto&& PopScope, auto&& Alloc, auto&& EndFrame) {
+		FRandomStream Random(1234);
+		double StartTime = FPlatformTime::Seconds();
+		for (int Frame = 0; Frame < Frames; Frame++) {
+			int Depth = 0;
+			for (int Step = 0; Step < StepsPerFrame; Step++) {
+				int Action = Random.RandRange(0, 9);
+				if (Action == 0 && Depth < MaxDepth) {
+					PushScope(Depth++);
+				} else if (Action == 1 && Depth > 0) {
+					PopScope(--Depth);
+				} else {
+					char* Data = Alloc(Action == 2 ? Random.RandRange(1024, 8192) : Random.RandRange(8, 256));
+					Data[0] = (char)Step;
+				}
+			}
+			while (Depth > 0)
+				PopScope(--Depth);
+			EndFrame();
+		}
+		return (FPlatformTime::Seconds() - StartTime) * 1000.0 / Frames;
+	};
+
+	TempMemoryPool Pool = {};
+	Pool.Init(1024);
+	double PoolMs = Run(
+		[&](int) { Pool.PushMarker(); },
+		[&](int) { Pool.PopMarker(); },
+		[&](int Size) { return Pool.Get(Size); },
+		[&]() { Pool.Reset(); });
+	int PoolSize = Pool.Buckets.Num() ? Pool.Buckets[0].Size : 0;
+	Pool.ClearAll();
+
+	TempMemoryPool FreeingPool = {};
+	double FreeingPoolMs = Run(
+		[&](int) { FreeingPool.PushMarker(); },
+		[&](int) { FreeingPool.PopMarker(); },
+		[&](int Size) { return FreeingPool.Get(Size); },
+		[&]() { FreeingPool.ClearAll(); FreeingPool.Init(1024); });
+	FreeingPool.ClearAll();
+
+	FMemStack& Stack = FMemStack::Get();
+	TOptional<FMemMark> Marks[MaxDepth + 1];
+	Marks[MaxDepth].Emplace(Stack); // Frame scope.
+	double MemStackMs = Run(
+		[&](int Depth) { Marks[Depth].Emplace(Stack); },
+		[&](int Depth) { Marks[Depth].Reset(); },
+		[&](int Size) { return (char*)Stack.Alloc(Size, 8); },
+		[&]() { Marks[MaxDepth].Reset(); Marks[MaxDepth].Emplace(Stack); });
+	Marks[MaxDepth].Reset();
+
+	UE_LOG(LogTemp, Display, TEXT("PropertyWatcher temp memory, %d frames, per frame: pool %.3f ms (%d KB block), pool freed every frame %.3f ms, FMemStack %.3f ms"),
+		Frames, PoolMs, PoolSize / 1024, FreeingPoolMs, MemStackMs);
+}
+
+static FAutoConsoleCommand BenchmarkTempMemoryCommand(
+	TEXT("PropertyWatcher.Benchmark.TempMemory"),
+	TEXT("Compares the temp memory pool with FMemStack. Optional argument is the frame count."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTempMemory));
+
+// Reflected types that only exist at runtime, put together like blueprint structs so the benchmark doesn't need generated code.
+struct BenchmarkGraph {
+	static const EObjectFlags PropFlags = RF_Public | RF_Transient;
+
+	TArray<UObject*> Rooted;
+	TArray<TPair<UScriptStruct*, uint8*>> Instances;
+	TArray<PropertyItemCategory> Categories = { { "Benchmark", {} } };
+	TArray<FString> WatchPaths;
+	FObjectProperty* AttachParentProp = 0;
+
+	UScriptStruct* NewStruct(const TCHAR* Name) {
+		FName UniqueName = MakeUniqueObjectName(GetTransientPackage(), UScriptStruct::StaticClass(), Name);
+		UScriptStruct* Struct = NewObject<UScriptStruct>(GetTransientPackage(), UniqueName, RF_Transient);
+		Struct->AddToRoot();
+		Rooted.Add(Struct);
+		return Struct;
+	}
+
+	// AddCppProperty puts the property in front, so members have to be added back to front.
+	template<typename T> T* AddProperty(UStruct* Owner, const FString& Name) {
+		T* Prop = new T(Owner, FName(*Name), PropFlags);
+		Owner->AddCppProperty(Prop);
+		return Prop;
+	}
+
+	void Link(UScriptStruct* Struct) {
+		Struct->Bind();
+		Struct->StaticLink(true);
+	}
+
+	uint8* Instantiate(UScriptStruct* Struct) {
+		uint8* Data = (uint8*)FMemory::Malloc(Struct->GetStructureSize(), Struct->GetMinAlignment());
+		Struct->InitializeStruct(Data);
+		Instances.Add({ Struct, Data });
+		return Data;
+	}
+
+	void AddRoot(const char* Name, UScriptStruct* Struct, uint8* Data) {
+		Categories[0].Items.Add({ PointerType::Struct, Data, 0, Name, Struct });
+	}
+
+	void BuildWide(int MemberCount, int WatchCount) {
+		UScriptStruct* Struct = NewStruct(TEXT("PropertyWatcherBenchmarkWide"));
+		for (int i = MemberCount - 1; i >= 0; i--) {
+			FString Name = FString::Printf(TEXT("Member_%d"), i);
+			if      (i % 3 == 0) AddProperty<FIntProperty>(Struct, Name);
+			else if (i % 3 == 1) AddProperty<FFloatProperty>(Struct, Name);
+			else                 AddProperty<FStrProperty>(Struct, Name);
+		}
+		Link(Struct);
+		AddRoot("Wide", Struct, Instantiate(Struct));
+
+		for (int i = 0; i < WatchCount; i++)
+			WatchPaths.Add(FString::Printf(TEXT("Wide.Member_%d"), (int)((int64)i * MemberCount / WatchCount)));
+	}
+
+	void BuildDeep(int Levels) {
+		UScriptStruct* Child = 0;
+		for (int Level = Levels - 1; Level >= 0; Level--) {
+			UScriptStruct* Struct = NewStruct(*FString::Printf(TEXT("PropertyWatcherBenchmarkDeep%d"), Level));
+			if (Child)
+				AddProperty<FStructProperty>(Struct, TEXT("Child"))->Struct = Child;
+			for (int i = 3; i >= 0; i--)
+				AddProperty<FIntProperty>(Struct, FString::Printf(TEXT("Value_%d"), i));
+			Link(Struct);
+			Child = Struct;
+		}
+		AddRoot("Deep", Child, Instantiate(Child));
+	}
+
+	// Scene components in a ring over their reflected AttachParent property. SetupAttachment() refuses cycles,
+	// so the property gets written directly and cleared again before the components are let go.
+	void BuildCyclic(int RingLength) {
+		AttachParentProp = FindFProperty<FObjectProperty>(USceneComponent::StaticClass(), TEXT("AttachParent"));
+		if (!AttachParentProp)
+			return;
+
+		TArray<USceneComponent*> Ring;
+		for (int i = 0; i < RingLength; i++) {
+			USceneComponent* Object = NewObject<USceneComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+			Object->AddToRoot();
+			Rooted.Add(Object);
+			Ring.Add(Object);
+		}
+		for (int i = 0; i < RingLength; i++)
+			AttachParentProp->SetObjectPropertyValue_InContainer(Ring[i], Ring[(i + 1) % RingLength]);
+
+		Categories[0].Items.Add(MakeObjectItemNamed(Ring[0], "Cyclic"));
+	}
+
+	void BuildArrays(int ElementCount) {
+		UScriptStruct* Element = NewStruct(TEXT("PropertyWatcherBenchmarkElement"));
+		for (int i = 2; i >= 0; i--)
+			AddProperty<FIntProperty>(Element, FString::Printf(TEXT("Value_%d"), i));
+		Link(Element);
+
+		UScriptStruct* Struct = NewStruct(TEXT("PropertyWatcherBenchmarkArrays"));
+		FArrayProperty* Elements = AddProperty<FArrayProperty>(Struct, TEXT("Elements"));
+		FStructProperty* ElementProp = new FStructProperty(Elements, TEXT("Inner"), PropFlags);
+		ElementProp->Struct = Element;
+		Elements->AddCppProperty(ElementProp);
+		FArrayProperty* Ints = AddProperty<FArrayProperty>(Struct, TEXT("Ints"));
+		Ints->AddCppProperty(new FIntProperty(Ints, TEXT("Inner"), PropFlags));
+		Link(Struct);
+
+		uint8* Data = Instantiate(Struct);
+		FScriptArrayHelper IntsHelper(Ints, Ints->ContainerPtrToValuePtr<void>(Data));
+		IntsHelper.AddValues(ElementCount);
+		for (int i = 0; i < ElementCount; i++)
+			*(int32*)IntsHelper.GetRawPtr(i) = i;
+
+		FScriptArrayHelper ElementsHelper(Elements, Elements->ContainerPtrToValuePtr<void>(Data));
+		ElementsHelper.AddValues(ElementCount / 10);
+		for (int i = 0; i < ElementsHelper.Num(); i++)
+			*(int32*)ElementsHelper.GetRawPtr(i) = i;
+
+		AddRoot("Arrays", Struct, Data);
+	}
+
+	void BuildMaps(int ElementCount) {
+		UScriptStruct* Struct = NewStruct(TEXT("PropertyWatcherBenchmarkMaps"));
+		FMapProperty* Map = AddProperty<FMapProperty>(Struct, TEXT("IntMap"));
+		Map->AddCppProperty(new FIntProperty(Map, TEXT("Key"), PropFlags));
+		Map->AddCppProperty(new FIntProperty(Map, TEXT("Value"), PropFlags));
+		Link(Struct);
+
+		uint8* Data = Instantiate(Struct);
+		FScriptMapHelper Helper(Map, Map->ContainerPtrToValuePtr<void>(Data));
+		for (int i = 0; i < ElementCount; i++) {
+			int32 Index = Helper.AddDefaultValue_Invalid_NeedsRehash();
+			*(int32*)Helper.GetKeyPtr(Index) = i;
+			*(int32*)Helper.GetValuePtr(Index) = i * 2;
+		}
+		Helper.Rehash();
+
+		AddRoot("Maps", Struct, Data);
+	}
+
+	void Destroy() {
+		for (auto& It : Instances) {
+			It.Key->DestroyStruct(It.Value);
+			FMemory::Free(It.Value);
+		}
+		Instances.Empty();
+		for (UObject* Object : Rooted) {
+			if (AttachParentProp && Object->IsA<USceneComponent>())
+				AttachParentProp->SetObjectPropertyValue_InContainer(Object, 0);
+			Object->RemoveFromRoot();
+		}
+		Rooted.Empty();
+	}
+};
+
+// Drives Update() with its own headless ImGui context through scripted scenarios and writes the per-frame numbers as json.
+// Runs without a GPU, e.g.: -game -nullrhi -unattended -ExecCmds="PropertyWatcher.Benchmark.Update Shapes=wide,deep MaxP95Ms=8 Exit"
+// Arguments (all optional): Shapes=wide,deep,cyclic,arrays,maps Frames= Members= Levels= Elements= Watch= Virtualized=0/1
+// MaxP95Ms= MaxP95Allocations= Out=<file> Exit (quits with exit code 1 when a threshold failed).
+void BenchmarkUpdate(const TArray<FString>& Args) {
+	FString Cmd = FString::Join(Args, TEXT(" "));
+	FString Shapes = TEXT("wide,deep,cyclic,arrays,maps");
+	FString OutPath = FPaths::ProjectSavedDir() / TEXT("PropertyWatcherBenchmark.json");
+	int Frames = 300, Members = 10000, Levels = 50, Elements = 100000, WatchCount = 100, RingLength = 64;
+	int Virtualized = 0;
+	float MaxP95Ms = 0, MaxP95Allocations = -1;
+	FParse::Value(*Cmd, TEXT("Shapes="), Shapes);
+	FParse::Value(*Cmd, TEXT("Out="), OutPath);
+	FParse::Value(*Cmd, TEXT("Frames="), Frames);
+	FParse::Value(*Cmd, TEXT("Members="), Members);
+	FParse::Value(*Cmd, TEXT("Levels="), Levels);
+	FParse::Value(*Cmd, TEXT("Elements="), Elements);
+	FParse::Value(*Cmd, TEXT("Watch="), WatchCount);
+	FParse::Value(*Cmd, TEXT("Virtualized="), Virtualized);
+	FParse::Value(*Cmd, TEXT("MaxP95Ms="), MaxP95Ms);
+	FParse::Value(*Cmd, TEXT("MaxP95Allocations="), MaxP95Allocations);
+	bool ExitWhenDone = FParse::Param(*Cmd, TEXT("Exit"));
+
+	// Warmup runs until the node cache and the flattened rows stop changing for a scroll cycle.
+	const int StableFramesNeeded = 30;
+	const int MaxWarmupFrames = 2000;
+
+	BenchmarkGraph Graph;
+	if (Shapes.Contains(TEXT("wide")))   Graph.BuildWide(Members, WatchCount);
+	if (Shapes.Contains(TEXT("deep")))   Graph.BuildDeep(Levels);
+	if (Shapes.Contains(TEXT("cyclic"))) Graph.BuildCyclic(RingLength);
+	if (Shapes.Contains(TEXT("arrays"))) Graph.BuildArrays(Elements);
+	if (Shapes.Contains(TEXT("maps")))   Graph.BuildMaps(Elements);
+
+	bool CounterWasInstalled = HeapCounter != 0;
+	MallocCounter::Install();
+	defer{ if (!CounterWasInstalled) MallocCounter::Uninstall(); };
+	if (!HeapCounter)
+		UE_LOG(LogTemp, Warning, TEXT("PropertyWatcher benchmark: heap allocations can't be counted on this platform, reported as -1 and MaxP95Allocations is ignored."));
+
+	ImGuiContext* PrevContext = ImGui::GetCurrentContext();
+	ImGuiContext* Context = ImGui::CreateContext();
+	ImGui::SetCurrentContext(Context);
+	ImGuiIO& IO = ImGui::GetIO();
+	IO.DisplaySize = ImVec2(1920, 1080);
+	IO.DeltaTime = 1.0f / 60.0f;
+	IO.IniFilename = 0;
+	unsigned char* Pixels;
+	int Width, Height;
+	IO.Fonts->GetTexDataAsRGBA32(&Pixels, &Width, &Height);
+
+	TArray<MemberPath> WatchedMembers;
+	bool FirstFrame = true;
+	auto RunFrame = [&]() {
+		ImGui::NewFrame();
+		ImGui::SetWindowSize("Property Watcher: Benchmark", ImVec2(1600, 1000));
+		bool IsOpen = true, WantsToSave, WantsToLoad;
+		Update("Benchmark", Graph.Categories, WatchedMembers, 0, &IsOpen, &WantsToSave, &WantsToLoad, FirstFrame);
+		ImGui::Render();
+		FirstFrame = false;
+	};
+
+	auto OpenAll = []() {
+		bool Changed = false;
+		for (auto& It : NodeCache.Nodes)
+			if (!It.Value->IsOpen) {
+				It.Value->IsOpen = true;
+				Changed = true;
+			}
+		if (Changed)
+			NodeCache.StructureVersion++;
+	};
+
+	TArray<ANSICHAR> Json;
+	JsonWriter Writer = { Json };
+	Writer.BeginObject();
+	Writer.Key("shapes"); Writer.String(Shapes);
+	Writer.Key("frames"); Writer.Rawf("%d", Frames);
+	Writer.Key("virtualized"); Writer.Rawf("%s", Virtualized ? "true" : "false");
+	Writer.Key("scenarios");
+	Writer.BeginArray();
+
+	bool AllPassed = true;
+	auto RunScenario = [&](const char* Name, TFunctionRef<void(int Frame)> PrepareFrame) {
+		TArray<float> FrameMs, Allocations, TMemBytes;
+		int WarmupFrames = 0, StableFrames = 0, LastNodeCount = -1, LastFlatRows = -1;
+		for (int Frame = 0; Frame < WarmupFrames + Frames; Frame++) {
+			Benchmark = {};
+			Benchmark.Active = true;
+			Benchmark.VirtualizedRows = Virtualized != 0;
+			PrepareFrame(Frame);
+			RunFrame();
+
+			if (Frame == WarmupFrames && StableFrames < StableFramesNeeded && WarmupFrames < MaxWarmupFrames) {
+				bool Stable = NodeCache.Nodes.Num() == LastNodeCount && Benchmark.FlatRows == LastFlatRows;
+				StableFrames = Stable ? StableFrames + 1 : 0;
+				LastNodeCount = NodeCache.Nodes.Num();
+				LastFlatRows = Benchmark.FlatRows;
+				WarmupFrames++;
+				continue;
+			}
+
+			FrameProfiler::Sample& Sample = Profiler.Samples[(Profiler.SampleIndex - 1 + FrameProfiler::MaxWindow) % FrameProfiler::MaxWindow];
+			FrameMs.Add(Sample.Ms[Phase_Frame]);
+			Allocations.Add(Sample.HeapAllocations);
+			TMemBytes.Add(Sample.TMemBytes);
+		}
+
+		auto Stats = [&](const char* Key, TArray<float>& Values) {
+			TArray<float> Sorted = Values;
+			Sorted.Sort();
+			auto Percentile = [&](float P) { return Sorted.Num() ? Sorted[FMath::Clamp((int)(P * (Sorted.Num() - 1) + 0.5f), 0, Sorted.Num() - 1)] : 0.0f; };
+			Writer.Key(Key);
+			Writer.BeginObject();
+			Writer.Key("p50"); Writer.Rawf("%.4f", Percentile(0.50f));
+			Writer.Key("p95"); Writer.Rawf("%.4f", Percentile(0.95f));
+			Writer.Key("p99"); Writer.Rawf("%.4f", Percentile(0.99f));
+			Writer.Key("max"); Writer.Rawf("%.4f", Sorted.Num() ? Sorted.Last() : 0.0f);
+			Writer.Key("values");
+			Writer.BeginArray();
+			for (float Value : Values)
+				Writer.Rawf("%.4f", Value);
+			Writer.EndArray();
+			Writer.EndObject();
+			return Percentile(0.95f);
+		};
+
+		Writer.BeginObject();
+		Writer.Key("name"); Writer.String(FAView(Name));
+		Writer.Key("warmup_frames"); Writer.Rawf("%d", WarmupFrames);
+		float P95Ms = Stats("frame_ms", FrameMs);
+		float P95Allocations = Stats("allocations", Allocations);
+		float P95Bytes = Stats("tmem_bytes", TMemBytes);
+		bool Passed = (MaxP95Ms <= 0 || P95Ms <= MaxP95Ms) && (MaxP95Allocations < 0 || P95Allocations <= MaxP95Allocations);
+		Writer.Key("passed"); Writer.Rawf("%s", Passed ? "true" : "false");
+		Writer.EndObject();
+
+		AllPassed &= Passed;
+		UE_LOG(LogTemp, Display, TEXT("PropertyWatcher benchmark %hs: p95 %.3f ms, p95 %.0f allocations, p95 %.0f KB temp memory%s"),
+			Name, P95Ms, P95Allocations, P95Bytes / 1024, Passed ? TEXT("") : TEXT(" - FAILED"));
+	};
+
+	RunScenario("open-all", [&](int Frame) { OpenAll(); });
+	RunScenario("search", [&](int Frame) { OpenAll(); Benchmark.SearchString = TEXT("Member_1 | Value_2"); });
+	RunScenario("filter", [&](int Frame) { OpenAll(); Benchmark.SearchString = TEXT("Member_1 | Value_2"); Benchmark.SearchFilter = true; });
+	RunScenario("scroll", [&](int Frame) { Benchmark.ScrollY = (Frame % 30) * 1000.0f; });
+
+	for (auto& Path : Graph.WatchPaths) {
+		MemberPath& Member = WatchedMembers.AddDefaulted_GetRef();
+		Member.PathString = Path;
+	}
+	RunScenario("watch", [&](int Frame) { Benchmark.Tab = "Watch"; });
+
+	Writer.EndArray();
+	Writer.Key("passed"); Writer.Rawf("%s", AllPassed ? "true" : "false");
+	Writer.EndObject();
+	FFileHelper::SaveArrayToFile(TArrayView<const uint8>((uint8*)Json.GetData(), Json.Num()), *OutPath);
+
+	// One more frame with default input so the statics of Update() don't keep the benchmark search.
+	Benchmark = {};
+	Benchmark.Active = true;
+	WatchedMembers.Empty();
+	RunFrame();
+	Benchmark = {};
+
+	ImGui::DestroyContext(Context);
+	ImGui::SetCurrentContext(PrevContext);
+
+	NodeCache.Clear();
+	WatchPaths.Clear();
+	ClearReflectionCaches();
+	Graph.Destroy();
+
+	UE_LOG(LogTemp, Display, TEXT("PropertyWatcher benchmark %s, results in %s"), AllPassed ? TEXT("passed") : TEXT("FAILED"), *OutPath);
+	if (ExitWhenDone)
+		FPlatformMisc::RequestExitWithStatus(false, AllPassed ? 0 : 1);
+}
+
+static FAutoConsoleCommand BenchmarkUpdateCommand(
+	TEXT("PropertyWatcher.Benchmark.Update"),
+	TEXT("Runs Update() headless over generated object graphs and writes per-frame timings/allocations as json. See BenchmarkUpdate() for the arguments."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkUpdate));
+
+// Parse and match cost of the search over column texts recorded from the class defaults of everything loaded.
+// Arguments: Rows=, Passes=, Out=, and Query="..." to only run a single query.
+void BenchmarkSearch(const TArray<FString>& Args) {
+	FString Cmd = FString::Join(Args, TEXT(" "));
+	FString OutPath = FPaths::ProjectSavedDir() / TEXT("PropertyWatcherSearchBenchmark.json");
+	FString SingleQuery;
+	int MaxRows = 50000, Passes = 20;
+	FParse::Value(*Cmd, TEXT("Rows="), MaxRows);
+	FParse::Value(*Cmd, TEXT("Passes="), Passes);
+	FParse::Value(*Cmd, TEXT("Out="), OutPath);
+	FParse::Value(*Cmd, TEXT("Query="), SingleQuery);
+	const int ParsePasses = 10000;
+
+	// Same order as the ColumnIDs.
+	TArray<FAView> Columns = { "name", "value", "metadata", "type", "cpptype", "class", "category", "address", "size", "distance" };
+
+	// Record the corpus. The texts get copied since values and sizes come from TMem.
+	TempMemoryPool CorpusText;
+	CorpusText.Init(1024 * 1024);
+	defer{ CorpusText.ClearAll(); };
+	TMem.Init(TMemoryStartSize);
+
+	TArray<CachedColumnText> Rows;
+	for (TObjectIterator<UClass> It; It && Rows.Num() < MaxRows; ++It) {
+		UObject* Defaults = It->GetDefaultObject(false);
+		if (!Defaults)
+			continue;
+
+		for (FProperty* Prop : TFieldRange<FProperty>(*It, EFieldIteratorFlags::ExcludeSuper)) {
+			if (Rows.Num() >= MaxRows)
+				break;
+
+			TMem.PushMarker();
+			PropertyItem Item = MakePropertyItem(Prop->ContainerPtrToValuePtr<void>(Defaults), Prop);
+			CachedColumnText& Row = Rows.AddDefaulted_GetRef();
+			Row.Name = Prop->GetFName();
+			Row.Add(ColumnID_Name, NameTable.Get(Row.Name));
+			for (int ColumnID = ColumnID_Value; ColumnID < ColumnID_Remove; ColumnID++) {
+				FAView Text = GetColumnCellText(Item, ColumnID);
+				Row.Add(ColumnID, CorpusText.Printf("%.*s", Text.Len(), Text.GetData()));
+			}
+			TMem.PopMarker();
+		}
+	}
+
+	if (!Rows.Num()) {
+		UE_LOG(LogTemp, Warning, TEXT("PropertyWatcher search benchmark: no rows recorded."));
+		return;
+	}
+
+	struct Query {
+		const char* Kind;
+		const char* Text;
+	};
+	TArray<Query> Queries = {
+		{ "plain",      "location" },
+		{ "plain",      "e" },
+		{ "exact",      "+bHidden" },
+		{ "exact",      "name:+RootComponent" },
+		{ "regex",      "r:\"^b[A-Z][a-z]+Enabled$\"" },
+		{ "regex",      "cpptype:r:\"TArray<.*Ptr\"" },
+		{ "numeric",    "value:>100" },
+		{ "numeric",    "size:<=8 !value:=0" },
+		{ "column",     "class:Actor category:rendering" },
+		{ "nested",     "(health | armor | ammo) !cpptype:float" },
+		{ "nested",     "!(b | (cpptype:int32 value:0)) | (type:object !value:none)" },
+		{ "many-terms", "a | b | c | d | e | f | g | h | i | j | k | l | m | n | o | p" },
+		{ "many-terms", "e a i o n t r s type:property !value:0 !metadata:deprecated" },
+	};
+	auto SingleQueryText = StringCast<ANSICHAR>(*SingleQuery);
+	if (!SingleQuery.IsEmpty())
+		Queries = { { "custom", SingleQueryText.Get() } };
+
+	bool CounterWasInstalled = HeapCounter != 0;
+	MallocCounter::Install();
+	defer{ if (!CounterWasInstalled) MallocCounter::Uninstall(); };
+
+	TArray<ANSICHAR> Json;
+	JsonWriter Writer = { Json };
+	Writer.BeginObject();
+	Writer.Key("rows"); Writer.Rawf("%d", Rows.Num());
+	Writer.Key("passes"); Writer.Rawf("%d", Passes);
+	Writer.Key("queries");
+	Writer.BeginArray();
+
+	UE_LOG(LogTemp, Display, TEXT("PropertyWatcher search benchmark over %d rows, %d passes:"), Rows.Num(), Passes);
+	for (Query& Q : Queries) {
+		FAView QueryText = Q.Text;
+		SimpleSearchParser Parser;
+
+		MallocCounter::StartCounting();
+		uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int i = 0; i < ParsePasses; i++)
+			Parser.ParseExpression(QueryText, Columns);
+		double ParseNs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000000.0 / ParsePasses;
+		int ParseAllocationCount = MallocCounter::StopCounting();
+		double ParseAllocations = ParseAllocationCount < 0 ? -1 : (double)ParseAllocationCount / ParsePasses;
+
+		// Only the columns the query tests are filled in, like when drawing rows.
+		bool UsedColumns[ColumnID_MAX_SIZE] = {};
+		for (auto& Command : Parser.Commands)
+			if (Command.Type == SimpleSearchParser::Command_Test)
+				UsedColumns[Command.Tst.ColumnID] = true;
+		UsedColumns[ColumnID_Name] = true;
+
+		TArray<CachedColumnText> QueryRows = Rows;
+		for (CachedColumnText& Row : QueryRows)
+			for (int ColumnID = 0; ColumnID < ColumnID_MAX_SIZE; ColumnID++)
+				Row.ColumnTextsCached[ColumnID] &= UsedColumns[ColumnID];
+
+		int Matches = 0;
+		for (CachedColumnText& Row : QueryRows)
+			Matches += Parser.ApplyTests(Row);
+
+		MallocCounter::StartCounting();
+		StartCycles = FPlatformTime::Cycles64();
+		for (int Pass = 0; Pass < Passes; Pass++)
+			for (CachedColumnText& Row : QueryRows)
+				Parser.ApplyTests(Row);
+		double TotalRows = (double)Passes * QueryRows.Num();
+		double MatchNs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000000.0 / TotalRows;
+		int MatchAllocationCount = MallocCounter::StopCounting();
+		double MatchAllocations = MatchAllocationCount < 0 ? -1 : MatchAllocationCount / TotalRows;
+
+		Writer.BeginObject();
+		Writer.Key("kind"); Writer.String(FAView(Q.Kind));
+		Writer.Key("query"); Writer.String(QueryText);
+		Writer.Key("parse_ns"); Writer.Rawf("%.1f", ParseNs);
+		Writer.Key("parse_allocations"); Writer.Rawf("%.2f", ParseAllocations);
+		Writer.Key("ns_per_row"); Writer.Rawf("%.2f", MatchNs);
+		Writer.Key("allocations_per_row"); Writer.Rawf("%.4f", MatchAllocations);
+		Writer.Key("matches"); Writer.Rawf("%d", Matches);
+		Writer.EndObject();
+
+		UE_LOG(LogTemp, Display, TEXT("  %-10hs %-70s parse %8.1f ns %5.1f allocs | %7.2f ns/row %.4f allocs/row | %d matches"),
+			Q.Kind, *FString(QueryText.Len(), QueryText.GetData()), ParseNs, ParseAllocations, MatchNs, MatchAllocations, Matches);
+	}
+
+	Writer.EndArray();
+	Writer.EndObject();
+	FFileHelper::SaveArrayToFile(TArrayView<const uint8>((uint8*)Json.GetData(), Json.Num()), *OutPath);
+	UE_LOG(LogTemp, Display, TEXT("PropertyWatcher search benchmark results in %s"), *OutPath);
+}
+
+static FAutoConsoleCommand BenchmarkSearchCommand(
+	TEXT("PropertyWatcher.Benchmark.Search"),
+	TEXT("Times SimpleSearchParser parsing and matching over column texts of the loaded classes, reports ns/row and allocations/row. See BenchmarkSearch() for the arguments."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkSearch));
+
+#endif
+
 } // namespace PropertyWatcher
 
 #endif // UE_SERVER
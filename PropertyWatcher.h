@@ -120,6 +120,59 @@ namespace PropertyWatcher {
 		Function,
 	};
 
+	// Every FProperty gets resolved once into a tag, value drawing/formatting/coloring is then a table lookup.
+	enum PropertyTag : uint8 {
+		Tag_Unresolved = 0,
+		Tag_None, // No property.
+		Tag_Unknown,
+
+		Tag_Bool,
+		Tag_Int8,
+		Tag_Byte,
+		Tag_Enum, // FByteProperty with enum.
+		Tag_Int16,
+		Tag_UInt16,
+		Tag_Int,
+		Tag_UInt32,
+		Tag_Int64,
+		Tag_UInt64,
+		Tag_Float,
+		Tag_Double,
+		Tag_Str,
+		Tag_Name,
+		Tag_Text,
+
+		Tag_Object,
+		Tag_Class,
+		Tag_SoftClass,
+		Tag_WeakObject,
+		Tag_LazyObject,
+		Tag_SoftObject,
+		Tag_Interface,
+
+		Tag_Array,
+		Tag_Map,
+		Tag_Set,
+		Tag_Delegate,
+		Tag_MulticastDelegate,
+
+		// Structs, Tag_Struct has to stay first and Tag_Transform last.
+		Tag_Struct,
+		Tag_Vector,
+		Tag_Rotator,
+		Tag_Vector2D,
+		Tag_IntVector,
+		Tag_IntVector2,
+		Tag_IntPoint,
+		Tag_Timespan,
+		Tag_DateTime,
+		Tag_LinearColor,
+		Tag_Color,
+		Tag_Transform,
+
+		Tag_Count,
+	};
+
 	struct PropertyItem {
 		// Maybe in future write list of all possible combinations that are possible and or used in code.
 		// So we don't have to check everything all the time.
@@ -130,8 +183,11 @@ namespace PropertyWatcher {
 		FAView NameOverwrite = "";
 		UStruct* StructPtr = 0; // Top level structs use this as UScriptStruct and Functions as UFunction
 		FAView NameIDOverwrite = ""; // Optional
+		FAView CachedName = ""; // Persistent property name from the struct layout cache, used when NameOverwrite is empty.
 
 		int CachedMemberCount = -1;
+		PropertyTag Tag = Tag_Unresolved;
+		uint64 NodeID = 0; // Identifies the row in the retained tree, see TreeNodeCache.
 
 		bool IsValid() { return !(Ptr == 0 && Prop == 0); };
 		FName GetName();
@@ -142,6 +198,7 @@ namespace PropertyWatcher {
 		FAView GetPropertyType();
 		FAView GetCPPType();
 		int GetSize();
+		PropertyTag GetTag();
 		bool CanBeOpened() { return IsExpandable() && !IsEmpty(); };
 
 		int GetMembers(TArray<PropertyItem>* MemberArray);
@@ -158,8 +215,12 @@ namespace PropertyWatcher {
 		FString PathString;
 		PropertyItem CachedItem;
 
+		// For value change highlighting.
+		uint64 ValueHash = 0;
+		void* HashedPtr = 0;
+		double LastChangeTime = -1;
+
 		MemberPath() {};
-		bool UpdateItemFromPath(TArray<PropertyItem>& Items);
 	};
 
 	PropertyItem MakeObjectItem(void* _Ptr);
@@ -185,6 +246,20 @@ namespace PropertyWatcher {
 #ifdef PROPERTY_WATCHER_INTERNAL
 #undef PROPERTY_WATCHER_INTERNAL
 
+#include "Async/Async.h"
+#include "Internationalization/Regex.h"
+#include "Engine/EngineBaseTypes.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/CoreDelegates.h"
+#include "UObject/ObjectKey.h"
+#include <atomic>
+
+// Switch on to register the PropertyWatcher.Benchmark console commands.
+#ifndef PROPERTY_WATCHER_BENCHMARKS
+#define PROPERTY_WATCHER_BENCHMARKS 0
+#endif
+
 namespace PropertyWatcher {
 	struct SimpleSearchParser {
 		enum Modifier {
@@ -225,10 +300,46 @@ namespace PropertyWatcher {
 
 		TArray<Command> Commands;
 
-		void ParseExpression(FAView SearchString, TArray<FAView> _Columns);
+		// Commands get compiled into a flat program once per parse, so nothing has to be converted or built per row.
+
+		struct CompiledTest {
+			Modifier Mod;
+			int ColumnID;
+			TArray<ANSICHAR> FoldedIdent;    // Lower case, for contains and exact tests.
+			double Number;                   // Pre-parsed for numeric tests.
+			FName Name;                      // For exact tests on names, NAME_None if no such name exists.
+			TOptional<FRegexPattern> Regex;
+		};
+
+		enum OpCode : uint8 {
+			OpCode_Test,
+			OpCode_And,
+			OpCode_Or,
+			OpCode_Not,
+		};
+
+		struct Instruction {
+			OpCode Code;
+			int TestIndex;
+		};
+
+		static const int InlineStackSize = 64; // Deeper programs put the evaluation stack on the heap.
+
+		TArray<CompiledTest> Tests;
+		TArray<Instruction> Program;
+		int StackDepth = 0; // Most values the program has on the stack at once.
+		FString RegexInput; // Reused for every regex test, the matcher only takes FStrings.
+
+		void ParseExpression(FAView SearchString, const TArray<FAView>& _Columns);
+		void Compile();
 		bool ApplyTests(struct CachedColumnText& ColumnTexts);
+		bool RunTest(CompiledTest& Tst, struct CachedColumnText& ColumnTexts, bool& Result);
 	};
 
+	FORCEINLINE ANSICHAR FoldChar(ANSICHAR c) { return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c; }
+	bool FoldedContains(FAView Text, FAView FoldedSearch);
+	bool FoldedEquals(FAView Text, FAView FoldedSearch);
+
 	//
 
 	struct VisitedPropertyInfo {
@@ -239,10 +350,16 @@ namespace PropertyWatcher {
 		bool Compare(VisitedPropertyInfo& Info) { return Address == Info.Address; }
 	};
 
+	bool IsInfiniteLooping(TArray<VisitedPropertyInfo>& VisitedStack, VisitedPropertyInfo& PropertyInfo);
+
+	uint64 HashItemValue(PropertyItem& Item);
+	void UpdateValueChange(MemberPath& Member, double Time);
+
 	struct TreeState {
 		// Watch item vars.
 
 		int CurrentWatchItemIndex = -1;
+		float ValueChangeHighlight; // 0-1, fades out after a change.
 		bool WatchItemGotDeleted; // Out
 		bool MoveHappened; // Out
 		int MoveFrom, MoveTo; // Out
@@ -256,12 +373,14 @@ namespace PropertyWatcher {
 
 		// Global options.
 
-		SimpleSearchParser SearchParser;
+		SimpleSearchParser* SearchParser = 0; // Compiled once per search string edit, shared by all tabs.
 		bool SearchFilterActive;
 
 		bool EnableClassCategoriesOnObjectItems;
 		bool ListFunctionsOnObjectItems;
 		bool ShowObjectNamesOnAllProperties;
+		bool HighlightValueChanges;
+		float ValueChangeFadeTime; // Seconds.
 
 		// Temp options that get set by items
 
@@ -278,6 +397,15 @@ namespace PropertyWatcher {
 
 		int ItemDrawCount; // Info.
 
+		// Deep search navigation.
+		uint64 ScrollTargetID;
+		bool ScrolledToTarget; // Out
+		uint64 HighlightedNodeID;
+
+		// Virtualized rows, see FlatTree.
+		bool IsVirtualized;        // Rows come from a flattened tree, items don't draw their children.
+		bool RowHasInlinedParent;  // Name gets the inlined path prefix from CurrentMemberPath like inlined children do.
+
 		// Visual helper.
 		bool AddressWasHovered;
 		bool DrawHoveredAddress;
@@ -289,7 +417,7 @@ namespace PropertyWatcher {
 		void DisableForceToggleNode() { ForceToggleNodeOpenClose = false; }
 		bool IsForceToggleNodeActive(int StackIndex) { return ForceToggleNodeOpenClose && (StackIndex <= ForceToggleNodeStackIndexLimit); }
 		bool ItemIsInfiniteLooping(VisitedPropertyInfo& PropertyInfo);
-		bool IsCurrentItemVisible() { return ScrollRegionRange.Contains(ImGui::GetCursorPosY()); }
+		bool IsCurrentItemVisible() { return IsVirtualized || ScrollRegionRange.Contains(ImGui::GetCursorPosY()); }
 	};
 
 	void DrawItemRow(TreeState& State, PropertyItem& Item, TInlineComponentArray<FAView>& CurrentPath, int StackIndex = 0);
@@ -317,6 +445,7 @@ namespace PropertyWatcher {
 
 		bool HasBranches;
 		VisitedPropertyInfo ItemInfo;
+		struct TreeNode* Node; // Retained open state, falls back to imgui storage if not set.
 
 		bool PushTextColor;
 		ImVec4 TextColor;
@@ -342,6 +471,7 @@ namespace PropertyWatcher {
 		ColumnID_Category,
 		ColumnID_Address,
 		ColumnID_Size,
+		ColumnID_Distance,
 		ColumnID_Remove,
 
 		ColumnID_MAX_SIZE,
@@ -358,6 +488,7 @@ namespace PropertyWatcher {
 	struct CachedColumnText {
 		bool ColumnTextsCached[ColumnID_MAX_SIZE] = {};
 		FAView ColumnTexts[ColumnID_MAX_SIZE];
+		FName Name; // Optional, only set when the name text is exactly this name.
 
 		void Add(int ColumnID, FAView Text) {
 			ColumnTextsCached[ColumnID] = true;
@@ -394,8 +525,8 @@ namespace PropertyWatcher {
 	bool BeginSection(FAView Name, TreeNodeState& NodeState, TreeState& State, int StackIndex, int ExtraFlags = 0);
 	void EndSection(TreeNodeState& NodeState, TreeState& State);
 
-	TArray<FName> GetClassFunctionList(UClass* Class);
-	TArray<UFunction*> GetObjectFunctionList(UObject* Obj);
+	void GetClassFunctionList(UClass* Class, TArray<FName>& FunctionNames);
+	struct StructLayout* GetFunctionLayout(UObject* Obj);
 	FAView GetItemMetadataCategory(PropertyItem& Item);
 	bool GetItemColor(PropertyItem& Item, ImVec4& Color);
 	bool GetObjFromObjPointerProp(PropertyItem& Item, UObject*& Object);
@@ -429,6 +560,7 @@ namespace PropertyWatcher {
 			char* Data = 0;
 			int Size = 0;
 			int Position = 0;
+			int HighPosition = 0; // Since the last reset.
 
 			FORCEINLINE bool MemoryFits(int Count) { return Position + Count < Size; };
 			char* Get(int Count);
@@ -446,14 +578,24 @@ namespace PropertyWatcher {
 		bool IsInitialized = false;
 		int StartSize = 1024;
 		int CurrentBucketIndex = 0;
+		int MaxBucketIndex = 0; // Since the last reset.
+
+		// Buckets are kept between frames and merged into one block sized to the decaying peak of what a frame needed.
+		static const int ShrinkInterval = 120;
+		int HighWater = 0;
+		int FramesSinceShrink = 0;
+		int LastFrameBytes = 0;
 
 		void Init(int _StartSize);
 		void GoToNextBucket();
 		void GoToPrevBucket() { CurrentBucketIndex--; }
 		FORCEINLINE MemBucket& GetCurrentBucket() { return Buckets[CurrentBucketIndex]; }
-		void AddBucket();
+		void AddBucket(int Size = 0);
 		void ClearAll();
+		void Reset();
+		void Coalesce(int Size);
 		char* Get(int Count);
+		char* Get(int Count, int Alignment);
 		void Free(int Count);
 
 		void PushMarker();
@@ -466,7 +608,6 @@ namespace PropertyWatcher {
 		FAView CToA(const TCHAR* SrcBuffer, int SrcLen);
 		FAView SToA(FString&& String) { return CToA(*String, String.Len()); }
 		FAView SToA(FString& String) { return CToA(*String, String.Len()); }
-		FAView NToA(FName Name);
 
 		// @Note: 512 bytes should be fine? If not the text gets cut off, shouldn't be a big deal.
 		#define TMemBuilderS(Name, Size) TStringBuilderBase<ANSICHAR> Name(TMem.Get(Size), Size)
@@ -476,30 +617,1238 @@ namespace PropertyWatcher {
 	TempMemoryPool TMem;
 	int TMemoryStartSize = 1024;
 
+	// Container allocator for TArrays that only live inside a TMem marker scope, e.g.: TempArray<UFunction*> Functions;
+	// Memory is never given back, it goes away with the marker or the frame. Growing the last allocation extends it in place.
+	struct TempMemoryAllocator {
+		using SizeType = int32;
+		enum { NeedsElementType = false };
+		enum { RequireRangeCheck = true };
+
+		class ForAnyElementType {
+		public:
+			ForAnyElementType() = default;
+			ForAnyElementType(const ForAnyElementType&) = delete;
+			ForAnyElementType& operator=(const ForAnyElementType&) = delete;
+
+			FORCEINLINE void MoveToEmpty(ForAnyElementType& Other) {
+				check(this != &Other);
+				Data = Other.Data;
+				AllocatedBytes = Other.AllocatedBytes;
+				Other.Data = 0;
+				Other.AllocatedBytes = 0;
+			}
+
+			FORCEINLINE FScriptContainerElement* GetAllocation() const { return (FScriptContainerElement*)Data; }
+			void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement = DEFAULT_ALIGNMENT);
+
+			FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement = DEFAULT_ALIGNMENT) const {
+				return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false, AlignmentOfElement);
+			}
+			FORCEINLINE SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement = DEFAULT_ALIGNMENT) const {
+				return NumAllocatedElements; // Shrinking wouldn't give anything back.
+			}
+			FORCEINLINE SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement, uint32 AlignmentOfElement = DEFAULT_ALIGNMENT) const {
+				return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false, AlignmentOfElement);
+			}
+
+			SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const { return NumAllocatedElements * NumBytesPerElement; }
+			bool HasAllocation() const { return !!Data; }
+			SizeType GetInitialCapacity() const { return 0; }
+
+		private:
+			char* Data = 0;
+			int AllocatedBytes = 0;
+		};
+
+		template<typename ElementType>
+		class ForElementType : public ForAnyElementType {
+		public:
+			FORCEINLINE ElementType* GetAllocation() const { return (ElementType*)ForAnyElementType::GetAllocation(); }
+		};
+	};
+}
+
+template <> struct TAllocatorTraits<PropertyWatcher::TempMemoryAllocator> : TAllocatorTraitsBase<PropertyWatcher::TempMemoryAllocator> {
+	enum { SupportsMove = true };
+	enum { IsZeroConstruct = true };
+	enum { SupportsElementAlignment = true };
+};
+
+namespace PropertyWatcher {
+	template<typename T> using TempArray = TArray<T, TempMemoryAllocator>;
+
+	// FName strings converted once and kept around, so the same name always gives back the same view.
+	// Keyed by display index and number, so "Member_1" and "Member_2" get their own strings. Wide names get stored as utf8.
+	struct NameInternTable {
+		TMap<uint64, FAView> Views;
+		TempMemoryPool Storage; // Never reset, bucket memory doesn't move.
+
+		FAView Get(FName Name);
+	};
+
+	NameInternTable NameTable;
+
+	// Work done during one Update, sent to Insights as PropertyWatcher/* counters at the end of the frame.
+	struct FrameCounters {
+		int RowsVisited = 0;
+		int RowsDrawn = 0;
+		int ReflectionWalks = 0;
+		int StringConversions = 0;
+		int WatchResolves = 0;
+
+		void Emit();
+	};
+
+	FrameCounters Counters;
+
+	// Counts heap allocations of the game thread while a frame is profiled. Sits in front of GMalloc and forwards everything.
+	// Gets put in front when turned on in the profiler window and taken out again when turned off, unless something else
+	// got in front of it in the meantime. The object itself is never deleted, other threads could still be inside of it.
+	// Platforms with a fixed allocator class call it directly (FMEMORY_INLINE_GMalloc), there it's unavailable.
+	struct MallocCounter : public FMalloc {
+		FMalloc* Inner;
+		bool Counting = false;
+		int Allocations = 0;
+
+		MallocCounter(FMalloc* _Inner) : Inner(_Inner) {}
+		static bool IsAvailable();
+		static void Install();
+		static bool Uninstall(); // False when it can't be taken out.
+		static void StartCounting();
+		static int StopCounting(); // -1 when not installed.
+
+		FORCEINLINE void Count() {
+			if (Counting && IsInGameThread())
+				Allocations++;
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override { this->Count(); return Inner->Malloc(Count, Alignment); }
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override { this->Count(); return Inner->TryMalloc(Count, Alignment); }
+		virtual void* Realloc(void* Ptr, SIZE_T NewSize, uint32 Alignment) override { this->Count(); return Inner->Realloc(Ptr, NewSize, Alignment); }
+		virtual void* TryRealloc(void* Ptr, SIZE_T NewSize, uint32 Alignment) override { this->Count(); return Inner->TryRealloc(Ptr, NewSize, Alignment); }
+#if !UE_VERSION_OLDER_THAN(5, 3, 0)
+		virtual void* MallocZeroed(SIZE_T Count, uint32 Alignment) override { this->Count(); return Inner->MallocZeroed(Count, Alignment); }
+		virtual void* TryMallocZeroed(SIZE_T Count, uint32 Alignment) override { this->Count(); return Inner->TryMallocZeroed(Count, Alignment); }
+#endif
+		virtual void Free(void* Ptr) override { Inner->Free(Ptr); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUsedOnCurrentThread() override { Inner->MarkTLSCachesAsUsedOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUnusedOnCurrentThread() override { Inner->MarkTLSCachesAsUnusedOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+		virtual void OnMallocInitialized() override { Inner->OnMallocInitialized(); }
+		virtual void OnPreFork() override { Inner->OnPreFork(); }
+		virtual void OnPostFork() override { Inner->OnPostFork(); }
+#if !UE_VERSION_OLDER_THAN(5, 2, 0)
+		virtual uint64 GetImmediatelyFreeableCachedMemorySize() override { return Inner->GetImmediatelyFreeableCachedMemorySize(); }
+		virtual uint64 GetTotalFreeCachedMemorySize() override { return Inner->GetTotalFreeCachedMemorySize(); }
+#endif
+		virtual bool Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) override { return Inner->Exec(InWorld, Cmd, Ar); }
+	};
+
+	MallocCounter* HeapCounter = 0; // Set while installed.
+
+	// Self profiling. Phase times are inclusive and only taken while the profiler window is open.
+	enum ProfilePhase {
+		Phase_Frame = 0,
+		Phase_SearchParse,
+		Phase_ObjectsTab,
+		Phase_ActorsTab,
+		Phase_WatchTab,
+		Phase_SnapshotsTab,
+		Phase_WatchResolve,
+		Phase_ReflectionWalk,
+		Phase_StringConversion,
+
+		Phase_Count
+	};
+
+	struct FrameProfiler {
+		static const int MaxWindow = 1024;
+		static const int HistogramBuckets = 32;
+
+		struct Sample {
+			float Ms[Phase_Count];
+			int TMemBytes;
+			int HeapAllocations; // -1 when not counted.
+			int RowsVisited;
+			int RowsDrawn;
+		};
+
+		bool Enabled = false;
+		int Window = 240;
+		double FrameStart = 0;
+		double PhaseTimes[Phase_Count] = {}; // Seconds, current frame.
+		TArray<Sample> Samples; // Ring buffer of MaxWindow.
+		int SampleIndex = 0;
+		int SampleCount = 0;
+
+		void BeginFrame();
+		void EndFrame();
+		FORCEINLINE void Add(ProfilePhase Phase, double Seconds) { PhaseTimes[Phase] += Seconds; }
+		float GetAverageMs(ProfilePhase Phase);
+		void DrawWindow(bool* IsOpen);
+	};
+
+	FrameProfiler Profiler;
+
+	struct ProfileScope {
+		ProfilePhase Phase;
+		uint64 StartCycles;
+
+		FORCEINLINE ProfileScope(ProfilePhase _Phase) : Phase(_Phase), StartCycles(Profiler.Enabled ? FPlatformTime::Cycles64() : 0) {}
+		FORCEINLINE ~ProfileScope() {
+			if (StartCycles)
+				Profiler.Add(Phase, FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles));
+		}
+	};
+
+	#define PROFILE_PHASE(Phase) ProfileScope PREPROCESSOR_JOIN(ProfilePhaseScope, __LINE__)(Phase)
+
+#if PROPERTY_WATCHER_BENCHMARKS
+	// Settings the benchmark command puts into Update() in place of user input.
+	struct BenchmarkInput {
+		bool Active = false;
+		FString Tab = "Objects";
+		FString SearchString;
+		bool SearchFilter = false;
+		bool VirtualizedRows = false;
+		float ScrollY = -1; // Table scroll, -1 leaves it alone.
+
+		int FlatRows = 0; // Filled in by the frame, for the warmup.
+	};
+
+	BenchmarkInput Benchmark;
+#endif
+
+	//
+
+	// Reflection data of a UStruct/UClass, built once so we don't have to walk TFieldRange<FProperty> for every open item every frame.
+	// Gets cleared on hot reload/live coding since classes can be replaced, layouts of collected structs get dropped after GC.
+	enum MemberKind : uint8 {
+		MemberKind_Value = 0, // Member pointer is container + offset.
+		MemberKind_Object,    // FObjectProperty, member pointer is the object it points to.
+	};
+
+	struct MemberLayout {
+		FProperty* Prop;
+		int32 Offset;
+		MemberKind Kind;
+		PropertyTag Tag;
+		int16 SectionIndex; // Owner class/struct of the member, index into StructLayout::SectionNames.
+		FAView Name;
+	};
+
+	struct StructLayout {
+		UStruct* Struct = 0;
+		TArray<MemberLayout> Members;
+		TArray<FAView> SectionNames;
+		TArray<int> SectionStartIndexes; // Has one more entry than SectionNames for the end index of the last section.
+
+		// Functions of a class and its super classes, only built once the functions section gets shown.
+		bool FunctionsBuilt = false;
+		TArray<UFunction*> Functions;
+		TArray<FAView> FunctionSectionNames;
+		TArray<int> FunctionSectionStartIndexes;
+
+		void Build(UStruct* _Struct);
+		void BuildFunctions();
+		FORCEINLINE void* GetMemberPtr(const MemberLayout& Member, void* ContainerPtr) const {
+			void* MemberPtr = (uint8*)ContainerPtr + Member.Offset;
+			if (Member.Kind == MemberKind_Object)
+				return ((FObjectProperty*)Member.Prop)->GetObjectPropertyValue(MemberPtr);
+			return MemberPtr;
+		}
+	};
+
+	// Retained state of an expandable row that lives across frames.
+	// Open/inline state is stored here and the child items are only rebuilt when the node gets opened,
+	// when the container changes (pointer, class or element count) or on the refresh tick.
+	// In between only the child pointers get updated from the layout, which doesn't allocate.
+	struct TreeNode {
+		uint64 ID = 0;
+		bool IsOpen = false;
+		bool IsInlined = false;
+		int InlinedStackDepth = 1;
+
+		TArray<PropertyItem> Children;
+		TArray<ANSICHAR> ChildNameData; // Child names that are not persistent, like array indexes and map keys.
+		TWeakObjectPtr<UObject> ChildrenOwner; // Struct or function the child properties belong to.
+		void* ContainerPtr = 0;
+		UStruct* ContainerStruct = 0;
+		int ContainerCount = -1;
+		bool ChildrenValid = false;
+		uint64 ChildrenSignature = 0;
+
+		uint32 RefreshFrame = 0;
+		uint32 ChildrenFrame = 0; // Children were already updated this frame.
+		uint32 LastUsedFrame = 0;
+	};
+
+	// Keys to make node ids for rows that aren't properties.
+	enum NodeKey {
+		NodeKey_ObjectsTab = 1,
+		NodeKey_ActorsTab,
+		NodeKey_WatchTab,
+		NodeKey_Category,
+		NodeKey_Section,
+		NodeKey_Functions,
+	};
+
+	struct TreeNodeCache {
+		TMap<uint64, TUniquePtr<TreeNode>> Nodes;
+		uint32 FrameIndex = 0;
+		uint32 StructureVersion = 0; // Changes when nodes get toggled in bulk or lose their children, flattened trees fully rebuild on change.
+		TArray<uint64> ChangedNodes; // Nodes whose open/inline state or child list changed, flattened trees rebuild the rows below them.
+		uint32 ChangedNodesStart = 0; // Change count before ChangedNodes[0], the list gets trimmed when it grows.
+		int RefreshInterval = 30; // In frames.
+		int PruneInterval = 300;  // In frames.
+
+		void NewFrame();
+		void Clear() { Nodes.Empty(); StructureVersion++; }
+		void InvalidateChildren();
+		void InvalidateCollected();
+		void MarkChanged(uint64 ID) { ChangedNodes.Add(ID); }
+		TreeNode* FindOrAdd(uint64 ID, bool DefaultOpen = false);
+		TArray<PropertyItem>& GetChildren(TreeNode& Node, PropertyItem& Item);
+		void RefreshChildren(TreeNode& Node, PropertyItem& Item);
+	};
+
+	TreeNodeCache NodeCache;
+
+	// Derived from container pointer, property and index so ids are stable across frames.
+	uint64 MakeNodeID(uint64 ParentID, const void* ContainerPtr, const void* Prop, int Index);
+
+	// Virtualized drawing for big trees. The open part of a tab gets flattened into rows and only the rows
+	// in the visible range get resolved and submitted through ImGuiListClipper, so the cost doesn't grow with the open tree.
+	// Rows only remember how to get to their item from the parent row, the pointers are resolved fresh every frame.
+	// Only the rows below changed nodes get rebuilt, the whole tree gets rebuilt when the roots or the settings change.
+	// Rows that aren't drawn get rechecked a few per frame, so the cost of noticing changes is spread over the refresh interval.
+	enum FlatRowKind : uint8 {
+		FlatRow_Item = 0,
+		FlatRow_Section, // Category, class or function section.
+		FlatRow_Function,
+	};
+
+	struct FlatRow {
+		FlatRowKind Kind = FlatRow_Item;
+		bool IsHidden = false; // Inlined items don't get a row, only their children do.
+		bool InInline = false; // Built inside of an inlined item, so it can only be rebuilt with that item.
+		bool CanBeOpened = false;
+		bool IsExpanded = false; // Member rows were added.
+		int16 StackIndex = 0;
+		int16 IndentLevel = 0;
+		int Parent = -1; // Item row this row is a member of, -1 for roots.
+		int Index = 0;   // Root index, member index or section index.
+		uint64 ID = 0;   // Node id, also used as imgui id for the row.
+		UFunction* Function = 0;
+		int NameOffset = 0, NameLen = 0;      // Section name in FlatTree::NameData.
+		int MemberStart = 0, MemberEnd = -1; // Member range of sections, for force toggling.
+		int SubtreeEnd = 0; // One past the last row below this item.
+
+		uint32 ResolvedFrame = 0;
+		bool IsResolved = false;
+		PropertyItem Item; // Only valid in the frame it was resolved in.
+	};
+
+	struct FlatCategory {
+		FAView Name;
+		uint64 ID;
+		int Start, End; // Root index range.
+	};
+
+	struct FlatBuildContext {
+		bool ClassSections;
+		bool ListFunctions;
+		bool ForceInline;
+		int InlineStackIndexLimit;
+		TArray<VisitedPropertyInfo> VisitedStack;
+	};
+
+	struct FlatTree {
+		TArray<FlatRow> Rows;
+		TArray<int> VisibleRows;
+		TArray<ANSICHAR> NameData;
+		TArray<PropertyItem>* Roots = 0; // Set every frame.
+
+		uint64 Signature = 0;
+		uint32 ChangeCursor = 0; // Node changes up to here are in the rows.
+		int RecheckRow = 0;
+		int NameDataBuilt = 0;
+		bool Dirty = true;
+		bool Truncated = false; // Rows stopped at MaxRowCount, shown under the table.
+		int MaxRowCount = 1000000; // Against open cycles and huge containers, like the draw count limit of DrawItemRow.
+		int MaxChangesPerFrame = 16; // More than that and a full build is cheaper.
+
+		void Clear() { Rows.Empty(); VisibleRows.Empty(); NameData.Empty(); Dirty = true; Truncated = false; }
+		void Update(TreeState& State, TArray<PropertyItem>& _Roots, TArray<FlatCategory>& Categories);
+		void Build(TreeState& State, TArray<FlatCategory>& Categories);
+		void RecheckRows();
+		bool RebuildChangedRows(TreeState& State);
+		bool RebuildRows(FlatBuildContext& Ctx, int RowIndex);
+		void AddItemRows(FlatBuildContext& Ctx, PropertyItem& Item, int Parent, int Index, int StackIndex, int IndentLevel);
+		void AddMemberRows(FlatBuildContext& Ctx, PropertyItem& Item, int ItemRow, int StackIndex, int IndentLevel);
+		int AddSectionRow(FlatBuildContext& Ctx, FAView Name, uint64 ID, bool DefaultOpen, int Parent, int StackIndex, int IndentLevel, bool& IsOpen);
+		PropertyItem* ResolveItem(int RowIndex);
+		FAView GetRowName(FlatRow& Row) { return FAView(NameData.GetData() + Row.NameOffset, Row.NameLen); }
+	};
+
+	void DrawFlatTree(TreeState& State, FlatTree& Tree);
+	void DrawFlatRow(TreeState& State, FlatTree& Tree, int RowIndex);
+	PropertyItem GetContainerItem(PropertyItem& Item, int& StackOffset); // Resolves weak/soft/lazy pointers to the object item.
+	void ForceToggleNode(TreeState& State, PropertyItem& Item, int StackIndex);
+	void ForceToggleNodesRecursive(TreeState& State, PropertyItem& Item, int StackIndex, int MemberStart = 0, int MemberEnd = -1);
+
+	// Searches the whole graph that's reachable from the roots of a tab, closed items included.
+	// Runs a bit every frame within a time budget, objects are the unit of work and are only held weakly between frames.
+	// Results remember which nodes have to be opened so we can jump to them.
+	struct DeepSearchResult {
+		FString Path;               // Member path like in the watch tab.
+		TArray<uint64> OpenNodeIDs; // Nodes that have to be open for the result row to be drawn.
+		uint64 RowID;
+	};
+
+	struct DeepSearchWork {
+		TWeakObjectPtr<UObject> Object;
+		uint64 NodeID;
+		int Depth;
+		FString Path;
+		TArray<uint64> OpenNodeIDs;
+	};
+
+	// Deep search can also run against an index that gets built on a worker thread.
+	// The builder only reads reflection data and plain values while holding FGCScopeGuard.
+	// Dynamic containers and object pointers other than FObjectProperty are not followed, 
+	// the game thread can reallocate or resolve those at any time.
+
+	struct SearchIndexEntry {
+		int Parent; // -1 for roots.
+		uint64 NodeID;
+		uint64 OpenNodeID; // Category or class section between parent and entry, 0 if there is none.
+		int TextOffsets[ColumnID_MAX_SIZE]; // 0 is the empty string.
+	};
+
+	struct SearchIndex {
+		FString TabName;
+		bool ClassSections;
+		int MaxDepth;
+		double StartTime;
+		double BuildMs;
+		int ObjectCount;
+
+		TArray<SearchIndexEntry> Entries;
+		TArray<ANSICHAR> TextData;
+
+		FAView GetText(const SearchIndexEntry& Entry, int ColumnID) const { return FAView(TextData.GetData() + Entry.TextOffsets[ColumnID]); }
+	};
+
+	typedef TSharedPtr<SearchIndex, ESPMode::ThreadSafe> SearchIndexPtr;
+
+	struct SearchIndexRoot {
+		TWeakObjectPtr<UObject> Object;
+		FString Name;
+		uint64 NodeID;
+		uint64 CategoryID;
+	};
+
+	struct SearchIndexBuilder {
+		struct Work {
+			TWeakObjectPtr<UObject> Object;
+			int Entry;
+			int Depth;
+		};
+
+		// Strings that are the same for every instance of a property only get stored once.
+		struct PropertyTexts {
+			int Name;
+			int Metadata;
+			int Type;
+			int Cpptype;
+			int Class;
+			int Category;
+			int Size;
+		};
+
+		SearchIndex* Index;
+		int MaxEntries;
+		TArray<Work> Queue;
+		TSet<FObjectKey> VisitedObjects; // Outlives the GC guard, a collected address can come back as a different object.
+		TMap<FProperty*, PropertyTexts> PropertyTextCache;
+		TMap<UStruct*, TArray<int>> SectionIndexCache;
+
+		void Run(TArray<SearchIndexRoot>& Roots);
+		void AddRoot(SearchIndexRoot& Root);
+		void AddMembers(UStruct* Struct, void* Container, bool IsObject, int Parent, int Depth);
+		int AddEntry(int Parent, uint64 NodeID, uint64 OpenNodeID);
+		int AddText(const FString& Text);
+		int AddTextf(const char* Fmt, ...);
+		int AddValueText(FProperty* Prop, PropertyTag Tag, void* ValuePtr);
+		PropertyTexts& GetPropertyTexts(FProperty* Prop);
+		TArray<int>& GetSectionIndexes(UStruct* Struct);
+	};
+
+	struct SearchIndexer {
+		bool Enabled = false;
+		float RefreshInterval = 5.0f; // Seconds.
+		int MaxEntries = 1000000;
+
+		SearchIndexPtr Index; // Last finished build, doesn't get modified anymore.
+		SearchIndexPtr PendingIndex; // Owned by the worker until PendingBuild is ready.
+		TFuture<void> PendingBuild;
+		TFuture<TArray<DeepSearchResult>> PendingResults;
+
+		bool IsBuilding() { return PendingBuild.IsValid(); }
+		bool IsQuerying() { return PendingResults.IsValid(); }
+		bool IndexMatches(SearchIndex* Idx, const FString& TabName, bool ClassSections, int MaxDepth) { return Idx && Idx->TabName == TabName && Idx->ClassSections == ClassSections && Idx->MaxDepth == MaxDepth; }
+		bool HasIndex(const FString& TabName, bool ClassSections, int MaxDepth) { return IndexMatches(Index.Get(), TabName, ClassSections, MaxDepth); }
+		bool IsBuilding(const FString& TabName, bool ClassSections, int MaxDepth) { return IsBuilding() && IndexMatches(PendingIndex.Get(), TabName, ClassSections, MaxDepth); }
+		bool NeedsRefresh(const FString& TabName);
+		void Build(FString TabName, TArray<PropertyItem>& Roots, TArray<FlatCategory>& Categories, bool ClassSections, int MaxDepth);
+		void Refresh(TArray<PropertyItem>& Roots, TArray<FlatCategory>& Categories) { Build(Index->TabName, Roots, Categories, Index->ClassSections, Index->MaxDepth); }
+		void Query(TArray<char>& QueryString, TArray<FAView>& Columns, int MaxResults);
+		void Update();
+		void Clear();
+
+		static void BuildIndex(SearchIndexPtr Index, TArray<SearchIndexRoot> Roots, int MaxEntries);
+		static TArray<DeepSearchResult> QueryIndex(SearchIndexPtr Index, TArray<char> QueryString, TArray<FAView> Columns, int MaxResults);
+	};
+
+	SearchIndexer DeepSearchIndex;
+
+	struct DeepSearchState {
+		TArray<char> Query; // Parser views point into this.
+		SimpleSearchParser Parser;
+		TArray<FAView> Columns;
+		FString TabName;
+		bool ClassSections;
+
+		bool StartRequested;
+		bool IsRunning;
+		bool UsesIndex; // Results come from DeepSearchIndex.
+		TArray<DeepSearchWork> Queue;
+		int QueueIndex;
+		TSet<FObjectKey> VisitedObjects; // Kept over frames, so not by address.
+		TArray<DeepSearchResult> Results;
+		int CurrentResult = -1;
+
+		int MaxDepth = 8;
+		float BudgetMs = 2.0f;
+		int MaxResults = 10000;
+
+		uint64 ScrollTargetID; // Cleared once the row was scrolled to.
+		bool SelectTab;
+
+		bool QueryEquals(const char* String) { return Query.Num() ? FCStringAnsi::Strcmp(Query.GetData(), String) == 0 : !String[0]; }
+		void Request(const char* SearchString, TArray<FAView> _Columns, bool _ClassSections);
+		void Start(FString _TabName, TArray<PropertyItem>& Roots, TArray<FlatCategory>& Categories);
+		void Stop();
+		void Clear();
+		void Step();
+		void Goto(int ResultIndex);
+		void VisitItem(PropertyItem& Item, int Depth, FString& Path, TArray<uint64>& OpenNodeIDs);
+		void VisitMembers(PropertyItem& Container, int Depth, FString& Path, TArray<uint64>& OpenNodeIDs);
+		bool TestItem(PropertyItem& Item);
+	};
+
+	DeepSearchState DeepSearch;
+
+	//
+
+	// Snapshots copy the memory of an object and its subobjects (e.g. the components of an actor) into an arena.
+	// Every property gets a node that points into the arena, container and string contents get appended after the object memory.
+
+	enum SnapshotNodeKind : uint8 {
+		SnapshotNode_Value,
+		SnapshotNode_Struct,
+		SnapshotNode_Container, // Array, set or map, map elements are structs with key and value.
+		SnapshotNode_String,
+	};
+
+	struct SnapshotNode {
+		FProperty* Prop; // Inner property for container elements.
+		int Parent;
+		int SubtreeEnd; // Index after the last node of the subtree.
+		int DataOffset;
+		int Size;
+		int Index; // Element index in containers, -1 for members.
+		int Count; // Element count of containers.
+		SnapshotNodeKind Kind;
+		bool HasOutOfLineData; // Subtree has container or string contents which aren't covered by the block compare.
+	};
+
+	struct ObjectSnapshot {
+		TWeakObjectPtr<UObject> Object;
+		TWeakObjectPtr<UClass> Class; // Nodes point to properties of this class.
+		FString Name;
+		int ObjectSize;
+		TArray<SnapshotNode> Nodes;
+		TArray<uint8> Data;
+
+		static const int MaxContainerElements = 10000;
+
+		void Capture(UObject* Obj);
+		void CaptureMembers(UStruct* Struct, int BaseOffset, int Parent);
+		void CaptureValue(int NodeIndex);
+		int AddNode(FProperty* Prop, int Parent, int DataOffset, int Size, int Index);
+		void MarkOutOfLine(int NodeIndex);
+		FString GetNodePath(int NodeIndex);
+		FString FormatNodeValue(int NodeIndex);
+	};
+
+	struct MemorySnapshot {
+		FString Name;
+		double CaptureMs;
+		TArray<ObjectSnapshot> Objects;
+
+		void Capture(UObject* Root);
+		int GetDataSize();
+	};
+
+	struct SnapshotChange {
+		FString Path;
+		FString OldValue;
+		FString NewValue;
+	};
+
+	struct SnapshotDiffer {
+		TArray<SnapshotChange>& Changes;
+		TBitArray<> ChangedBlocks;
+
+		static const int BlockSize = 64;
+
+		void Diff(MemorySnapshot& A, MemorySnapshot& B);
+		void DiffObjects(ObjectSnapshot& A, ObjectSnapshot& B);
+		void DiffChildren(ObjectSnapshot& A, int AIndex, int AEnd, ObjectSnapshot& B, int BIndex, int BEnd, bool UseBlocks);
+		void DiffNode(ObjectSnapshot& A, int AIndex, ObjectSnapshot& B, int BIndex, bool UseBlocks);
+		void AddChange(ObjectSnapshot& A, int AIndex, ObjectSnapshot& B, int BIndex);
+		bool AnyBlockChanged(int Offset, int Size);
+	};
+
+	bool SnapshotBlockEquals(const uint8* A, const uint8* B, int Size);
+
+	struct SnapshotState {
+		TArray<TUniquePtr<MemorySnapshot>> Snapshots;
+		int SelectedA = -1;
+		int SelectedB = -1; // -1 compares against live memory.
+
+		TArray<SnapshotChange> Changes;
+		FString DiffInfo;
+
+		void Capture(UObject* Root);
+		void Diff();
+	};
+
+	SnapshotState Snapshots;
+
+	UObject* GetItemObject(PropertyItem& Item);
+	void SnapshotsTab();
+
+	//
+
+	// Json copy/paste. The writer streams into a reused scratch buffer, no string trees get built.
+	// Paste parses the json into a plan of typed writes at fixed offsets, which gets applied at the end of the frame
+	// when nothing is iterating over the memory anymore.
+	//
+	// Big objects get written in chunks over several frames. A chunk stops between two elements and remembers the
+	// element index of every open container, the next chunk walks down the same indexes from the root object without
+	// writing anything, so no pointers are kept between frames.
+
+	struct JsonWriter {
+		static const int MaxDepth = 64;
+		static const int MaxSize = 16 * 1024 * 1024;
+
+		TArray<ANSICHAR>& Out;
+		int Depth = 0;
+		bool AfterKey = false;
+		bool HasElements[MaxDepth + 1] = {};
+		UObject* Objects[MaxDepth + 1] = {}; // Subobjects that are being written inline, per depth.
+		UObject* NextObject = 0; // Goes into Objects with the next object that gets opened.
+
+		int ChunkEnd = MaxSize;
+		int Path[MaxDepth + 1] = {}; // Element index per depth where the last chunk stopped.
+		int ResumeDepth = 0; // Containers above this depth still have to be entered again.
+		bool Paused = false;
+		bool Truncated = false; // Size or depth limit was hit, the values past it are missing or null.
+		bool Failed = false;    // The path of the last chunk doesn't exist anymore.
+
+		bool IsFull() { return Out.Num() >= MaxSize; }
+		bool IsResuming() { return ResumeDepth > Depth; }
+		bool IsBeingWritten(UObject* Obj);
+		void BeginValue();
+		void NewLine();
+		int BeginContainer(ANSICHAR c);
+		void EndContainer(ANSICHAR c);
+		int BeginObject() { return BeginContainer('{'); } // Returns the element index to start at.
+		void EndObject() { EndContainer('}'); }
+		int BeginArray() { return BeginContainer('['); }
+		void EndArray() { EndContainer(']'); }
+		bool BeginElement(int Index);
+		bool EndElement(int Level, int Index);
+		void Fail() { Failed = true; Paused = true; }
+		void Key(FAView Name);
+		void String(FAView Utf8);
+		void String(const FString& Text);
+		void Rawf(const char* Fmt, ...);
+		void RawValue(FAView Json);
+	};
+
+	void WriteJsonMembers(JsonWriter& Writer, UStruct* Struct, void* Container, UObject* Root, int Depth);
+	void WriteJsonStaticArray(JsonWriter& Writer, FProperty* Prop, void* Ptr, UObject* Root, int Depth);
+	void WriteJsonMapPair(JsonWriter& Writer, FMapProperty* MapProp, FScriptMapHelper& Helper, int Index, UObject* Root, int Depth);
+	void WriteJsonValue(JsonWriter& Writer, FProperty* Prop, void* Ptr, UObject* Root, int Depth);
+
+	struct JsonReader {
+		static const int MaxDepth = 256; // Way past what the writer makes, only there so bad clipboard text can't overflow the stack.
+
+		FAView Text;
+		int Pos = 0;
+		int Depth = 0;
+		FString Error;
+
+		ANSICHAR Peek();
+		bool Consume(ANSICHAR c);
+		bool Expect(ANSICHAR c);
+		bool Enter();
+		void Leave() { Depth--; }
+		bool ReadHex(uint32& Value);
+		bool ReadString(FString& Out);
+		bool ReadNumber(double& Number, int64& Integer);
+		bool ReadBool(bool& Value);
+		bool SkipValue();
+		bool Fail(const TCHAR* Message);
+	};
+
+	enum PasteStepKind : uint8 {
+		PasteStep_Members,
+		PasteStep_Object, // Owned subobject that got written inline.
+		PasteStep_Array,
+		PasteStep_Bool,
+		PasteStep_Integer,
+		PasteStep_Number,
+		PasteStep_String,
+	};
+
+	struct PasteStep {
+		PasteStepKind Kind;
+		FProperty* Prop;
+		int Offset; // From the parent memory.
+		int Index;  // Array element, -1 for members.
+		int ChildEnd;
+		int Count;  // New array size.
+		int64 Integer;
+		double Number;
+		int StringIndex;
+		UClass* Class; // For PasteStep_Object, the object has to have the same class when the plan gets applied.
+	};
+
+	struct PastePlan {
+		void* Target;
+		TArray<PasteStep> Steps;
+		TArray<FString> Strings;
+
+		bool Compile(FAView Json, PropertyItem& Item, FString& Error);
+		bool CompileMembers(JsonReader& Reader, UStruct* Struct, void* Memory, FProperty* Prop, int Offset, int Index);
+		bool CompileStaticArray(JsonReader& Reader, FProperty* Prop, void* Memory, int Offset);
+		bool CompileValue(JsonReader& Reader, FProperty* Prop, void* Memory, int Offset, int Index);
+		int AddStep(PasteStepKind Kind, FProperty* Prop, int Offset, int Index);
+		void Apply() { ApplyStep(0, Target); }
+		void ApplyStep(int StepIndex, void* Base);
+	};
+
+	struct JsonPreset {
+		FString Name;
+		FString TypeKey; // Presets only show up on items of the same type.
+		TArray<ANSICHAR> Json;
+	};
+
+	struct JsonState {
+		static const int ExportChunkSize = 256 * 1024; // Per frame.
+
+		TArray<ANSICHAR> Scratch; // Reused for every copy, holds the export until it's done.
+		TArray<PastePlan> PendingWrites;
+		TArray<JsonPreset> Presets;
+		bool PresetsLoaded;
+
+		// Running export, only objects can be found again in a later frame so other items are written in one go.
+		TUniquePtr<JsonWriter> Export;
+		TWeakObjectPtr<UObject> ExportRoot;
+		FString ExportPreset; // Empty when the export goes to the clipboard.
+		FString ExportTypeKey;
+		FString ExportStatus; // Progress, or why the last export is incomplete.
+
+		void StartExport(PropertyItem& Item, FString PresetName);
+		void UpdateExport();
+		void FinishExport();
+		void CancelExport(FString Reason);
+		void Copy(PropertyItem& Item) { StartExport(Item, ""); }
+		bool Paste(PropertyItem& Item, FAView Json, FString& Error);
+		void SavePreset(FString Name, PropertyItem& Item);
+		bool ApplyPreset(int PresetIndex, PropertyItem& Item, FString& Error);
+		void ApplyPendingWrites();
+		FString GetPresetsFilePath();
+		void LoadPresets();
+		void SavePresets();
+	};
+
+	JsonState JsonIO;
+
+	FString GetItemTypeKey(PropertyItem& Item);
+	void DrawJsonPopupControls(PropertyItem& Item);
+
+	//
+
+	TMap<UStruct*, TUniquePtr<StructLayout>> StructLayoutCache;
+	TMap<FProperty*, PropertyTag> PropertyTagCache;
+
+	// Keys of the reflection caches with the object that frees them. Garbage collection only drops the entries of
+	// collected objects, everything gets cleared after a reload.
+	TMap<const void*, TWeakObjectPtr<UObject>> ReflectionCacheOwners;
+	FORCEINLINE void TrackReflectionKey(const void* Key, UObject* Owner) { ReflectionCacheOwners.Add(Key, Owner); }
+
+	// Column texts that only depend on the property/function and not on the value, built the first time a row needs them.
+	struct FieldTexts {
+		FAView Type;
+		FAView CppType;
+		FAView Class;
+		FAView Category;
+		FAView Metadata;
+	};
+
+	struct DisplayTextCache {
+		TMap<FProperty*, FieldTexts> Properties;
+		TMap<UStruct*, FieldTexts> Structs; // Functions and script structs.
+		TMap<UEnum*, FAView> EnumComboItems; // Zero separated labels for ImGui::Combo.
+		TempMemoryPool Storage;
+
+		FieldTexts& Get(FProperty* Prop);
+		FieldTexts& Get(UStruct* Struct);
+		FAView GetEnumComboItems(UEnum* Enum);
+		FAView Store(const TCHAR* Text, int Len);
+		FAView Store(const FString& String) { return Store(*String, String.Len()); }
+		void Remove(const void* Key); // Texts stay in Storage until the next Clear.
+		void Clear();
+	};
+
+	DisplayTextCache DisplayTexts;
+
+	StructLayout* GetStructLayout(UStruct* Struct);
+	void ClearReflectionCaches();
+	void PruneReflectionCaches();
+
+	//
+
+	// Watch paths get compiled into a trie, paths that share a prefix share nodes so the shared part only gets
+	// resolved once per frame. Member steps remember their index in the struct layout and only search again when
+	// the class of the container changes.
+	struct WatchPathNode {
+		int Parent = -1;
+		FString Segment;
+		TMap<FString, int> Children;
+		int Index = -1;  // From "[n]" segments.
+		int MapPart = 0; // 1 for "[n] Key", 2 for "[n] Value".
+
+		UStruct* CachedStruct = 0;
+		int CachedMember = -1;
+
+		uint64 ResolvedFrame = 0;
+		bool Found = false;
+		PropertyItem Item;
+	};
+
+	struct WatchPathResolver {
+		static const int MaxNodes = 4096;
+
+		TArray<WatchPathNode> Nodes; // Node 0 is the root.
+		TMap<FString, int> PathNodes;
+		TMap<FString, FIntPoint> RootLookup; // Category and item index.
+		TArray<PropertyItemCategory>* Categories = 0;
+		uint64 RootsHash = 0;
+		uint64 Frame = 0;
+
+		void NewFrame(TArray<PropertyItemCategory>& _Categories);
+		bool Resolve(MemberPath& Member);
+		int Compile(const FString& PathString);
+		bool ResolveNode(int NodeIndex);
+		bool ResolveStep(WatchPathNode& Node, PropertyItem& Parent);
+		UObject* FindOwner(const FString& PathString, void* Ptr);
+		void InvalidateMembers();
+		void InvalidateStructs(const TSet<const void*>& Collected);
+		void Clear();
+	};
+
+	WatchPathResolver WatchPaths;
+
+	//
+
+	// Samples watch values from a tick function, so changes between UI frames or while the window is closed get
+	// recorded as well. Only numbers, bools and enums that live inside a UObject are sampled, the owner is kept as a
+	// weak pointer and the value is read at its offset. Bindings get refreshed whenever the watch tab resolves the paths.
+	// Without the watch tab the tick only finds owners again that got replaced by an object with the same path name.
+	//
+	// Every watch has its own ring, the tick is the only producer and drawing the only consumer. The consumer doesn't
+	// take samples out, it copies the newest ones and drops what the producer overwrote in the meantime.
+	struct SampleRing {
+		static const uint32 Capacity = 2048; // Power of two, ~34 seconds at 60 ticks per second.
+
+		struct Sample {
+			double Time;
+			double Value;
+		};
+
+		Sample Samples[Capacity];
+		std::atomic<uint32> Head{ 0 }; // Samples pushed so far, only written by the producer.
+
+		FORCEINLINE void Push(double Time, double Value) {
+			uint32 Index = Head.load(std::memory_order_relaxed);
+			Samples[Index & (Capacity - 1)] = { Time, Value };
+			Head.store(Index + 1, std::memory_order_release);
+		}
+		void CopySince(double MinTime, TempArray<Sample>& Out);
+	};
+
+	struct SampledWatch {
+		TWeakObjectPtr<UObject> Owner;
+		int Offset = -1; // -1 when not bound.
+		FNumericProperty* Numeric = 0;
+		FBoolProperty* Bool = 0;
+		// Where the owner was last bound, so the tick can pick up a replacement with the same path.
+		FSoftObjectPath OwnerPath;
+		TWeakObjectPtr<UClass> OwnerClass;
+		FProperty* OwnerProp = 0; // Only used while OwnerClass is still the owner's class.
+		int OwnerOffset = -1;
+		double NextRebindTime = 0;
+		uint64 SeenFrame = 0;
+		bool PlotOpen = false;
+		int CaptureColumn = -1;
+		SampleRing Ring;
+	};
+
+	bool GetSampleProperties(FProperty* Prop, FNumericProperty*& Numeric, FBoolProperty*& Bool);
+
+	struct WatchSamplerTickFunction : public FTickFunction {
+		virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+		virtual FString DiagnosticMessage() override { return TEXT("PropertyWatcher::WatchSampler"); }
+	};
+
+	struct WatchSampler {
+		bool Enabled = false;
+		ETickingGroup TickGroup = TG_PostUpdateWork;
+		float PlotSeconds = 10.0f;
+
+		TWeakObjectPtr<UWorld> World;
+		WatchSamplerTickFunction TickFunction;
+		FDelegateHandle WorldCleanupHandle;
+		TMap<FString, TUniquePtr<SampledWatch>> Watches; // By path.
+		double LastTickUs = 0;
+
+		void Update(UWorld* _World);
+		void Bind(UWorld* _World);
+		void Unbind();
+		void Tick();
+		SampledWatch* Find(const FString& Path);
+		void SetSampled(const FString& Path, bool Sampled);
+		void BindWatch(SampledWatch& Watch, MemberPath& Member);
+		UObject* RebindStale(SampledWatch& Watch, double Time);
+		void RemoveUnseen(uint64 Frame);
+		void InvalidateBindings();
+	};
+
+	WatchSampler Sampler;
+	void DrawSampleRow(MemberPath& Member);
+	void DrawSamplePlot(SampleRing& Ring, float Height, bool Detailed);
+
+	//
+
+	struct ByteWriter {
+		TArray<uint8>& Out;
+
+		void Bytes(const void* Data, int Count) { Out.Append((const uint8*)Data, Count); }
+		void U8(uint8 Value) { Out.Add(Value); }
+		void U32(uint32 Value) { Bytes(&Value, sizeof(Value)); }
+		void VarInt(uint64 Value);
+		void ZigZag(int64 Value) { VarInt(((uint64)Value << 1) ^ (uint64)(Value >> 63)); }
+		void XorFloat(uint64 Bits, uint64 Prev);
+	};
+
+	struct ByteReader {
+		const uint8* Ptr;
+		const uint8* End;
+		bool Failed = false;
+
+		const uint8* Skip(int64 Count);
+		bool Bytes(void* Data, int64 Count);
+		uint8 U8() { const uint8* Data = Skip(1); return Data ? *Data : 0; }
+		uint32 U32() { uint32 Value = 0; Bytes(&Value, sizeof(Value)); return Value; }
+		uint64 VarInt();
+		int64 ZigZag() { uint64 Value = VarInt(); return (int64)(Value >> 1) ^ -(int64)(Value & 1); }
+		uint64 XorFloat(uint64 Prev);
+	};
+
+	// Records the sampled watches over a whole session into a columnar file, one column per watch. The sampler tick
+	// writes the raw values straight into the current block, full blocks get encoded and written by a worker while the
+	// tick fills the other one. If the worker is still busy when the next block is full, that block gets dropped.
+	//
+	// File: header with the watch paths, then blocks of up to BlockRows rows. Times (microseconds) and integer columns
+	// are delta encoded zigzag varints, float columns are XORed with the previous value and only the non zero bytes
+	// are stored. Every KeyframeInterval blocks, and after a dropped block, the deltas start over from zero.
+	struct CaptureBlock {
+		int RowCount = 0;
+		TArray<double> Times;
+		TArray<uint64> Values; // Row major, int64 or double bits depending on the column.
+		TArray<uint8> Valid;
+	};
+
+	struct CaptureColumn {
+		FString Path;
+		bool IsFloat;
+	};
+
+	struct CaptureWriter {
+		static const int BlockRows = 256;
+		static const int KeyframeInterval = 16;
+		static const uint32 Version = 1;
+		static const uint32 BlockMagic = 0x4B425750; // "PWBK"
+		static constexpr const char* FileMagic = "PWCAPTUR";
+
+		bool IsCapturing = false;
+		FString FilePath;
+		TArray<CaptureColumn> Columns;
+		CaptureBlock Blocks[2];
+		int CurrentBlock = 0;
+		double StartTime = 0;
+		TUniquePtr<IFileHandle> File;
+		TFuture<void> PendingWrite;
+		FDelegateHandle PreExitHandle; // Flushes the last block when the engine shuts down mid capture.
+
+		// Only used by the write task.
+		TArray<uint8> Encoded;
+		TArray<uint64> Prev;
+		int64 PrevTime = 0;
+		int BlocksSinceKeyframe = 0;
+		std::atomic<bool> ForceKeyframe{ false };
+
+		int64 RowsWritten = 0;
+		int DroppedBlocks = 0;
+		std::atomic<int64> BytesWritten{ 0 };
+
+		bool Start(FString& Error);
+		void Stop();
+		void Submit();
+		void EncodeBlock(CaptureBlock& Block);
+		int FindColumn(const FString& Path);
+
+		FORCEINLINE int BeginRow(double Time) {
+			CaptureBlock& Block = Blocks[CurrentBlock];
+			int Row = Block.RowCount;
+			Block.Times[Row] = Time - StartTime;
+			FMemory::Memzero(&Block.Valid[Row * Columns.Num()], Columns.Num());
+			return Row;
+		}
+
+		FORCEINLINE void SetValue(int Row, int Column, double Value, int64 IntValue) {
+			CaptureBlock& Block = Blocks[CurrentBlock];
+			int Index = Row * Columns.Num() + Column;
+			if (Columns[Column].IsFloat)
+				FMemory::Memcpy(&Block.Values[Index], &Value, sizeof(Value));
+			else
+				Block.Values[Index] = (uint64)IntValue;
+			Block.Valid[Index] = 1;
+		}
+
+		FORCEINLINE void EndRow() {
+			if (++Blocks[CurrentBlock].RowCount == BlockRows)
+				Submit();
+		}
+	};
+
+	CaptureWriter Capture;
+	bool ExportCaptureToCsv(const FString& CapturePath, const FString& CsvPath, FString& Error);
+
+	//
+
+	// All actors of the loaded levels, kept up to date by the spawn/destroy and level streaming delegates instead of
+	// walking the levels. Actors are bucketed by class, so a class filter only looks at the matching buckets.
+	struct ActorRegistry {
+		struct ActorSlot {
+			UClass* Class;
+			int Index;
+		};
+
+		TWeakObjectPtr<UWorld> World;
+		FDelegateHandle SpawnedHandle;
+		FDelegateHandle DestroyedHandle;
+		FDelegateHandle LevelAddedHandle;
+		FDelegateHandle LevelRemovedHandle;
+
+		struct ActorChange {
+			AActor* Actor;
+			bool Added;
+		};
+
+		static const int MaxChangeLog = 4096;
+
+		TMap<UClass*, TArray<AActor*>> Buckets;
+		TMap<AActor*, ActorSlot> Slots;
+		uint32 Version = 0; // Changes when actors get added or removed.
+
+		// Changes since ChangeLogVersion, so views can update incrementally. Starts over when it gets too long.
+		TArray<ActorChange> ChangeLog;
+		uint32 ChangeLogVersion = 0;
+
+		void Update(UWorld* _World);
+		void Bind(UWorld* _World);
+		void Unbind();
+		void AddActor(AActor* Actor);
+		void RemoveActor(AActor* Actor);
+		void AddLevel(ULevel* Level);
+		void RemoveLevel(ULevel* Level);
+		int Num() { return Slots.Num(); }
+		void GetActors(UClass* FilterClass, bool IncludeSubclasses, TArray<PropertyItem>& Out);
+		bool GetChanges(uint32 SinceVersion, TArrayView<ActorChange>& Changes);
+		void LogChange(AActor* Actor, bool Added);
+		void ResetChangeLog();
+	};
+
+	ActorRegistry WorldActors;
+
+	// Uniform grid of actor locations, kept in sync with the actor registry, so searching around the player doesn't
+	// need a physics query or collision. Locations get refreshed a slice per frame instead of reading every transform.
+	struct ActorGrid {
+		static constexpr float CellSize = 5000.0f; // 50 meters.
+		static const int RefreshBudget = 4096;
+
+		struct Entry {
+			AActor* Actor;
+			FVector Location;
+			uint64 Cell;
+		};
+
+		TArray<Entry> Entries;
+		TMap<AActor*, int> EntryIndexes;
+		TMap<uint64, TArray<int>> Cells;
+		int RefreshCursor = 0;
+		uint32 RegistryVersion = 0;
+
+		FVector Origin = FVector::ZeroVector; // Player location for the distance column, updated every frame.
+		bool HasOrigin = false;
+
+		void Update(ActorRegistry& Registry);
+		void Rebuild(ActorRegistry& Registry);
+		void Add(AActor* Actor);
+		void Remove(AActor* Actor);
+		void Move(int Index, const FVector& Location);
+		void RemoveFromCell(uint64 Cell, int Index);
+		static FIntVector GetCellCoord(const FVector& Location);
+		static uint64 GetCellKey(const FIntVector& Coord);
+		bool QueryIndexes(const FVector& Center, float Radius, UClass* FilterClass, bool IncludeSubclasses, TArray<int>& Out);
+		void QueryRadius(const FVector& Center, float Radius, UClass* FilterClass, bool IncludeSubclasses, TArray<AActor*>& Out);
+		void QueryNearest(const FVector& Center, int Count, UClass* FilterClass, bool IncludeSubclasses, TArray<AActor*>& Out);
+	};
+
+	ActorGrid SpatialIndex;
+
+	bool GetPlayerLocation(UWorld* World, FVector& Location);
+	float GetActorDistanceSq(AActor* Actor);
+
+	// Lexical ranks of names, by name entry so numbered names like "Actor_12" share one and then sort by number.
+	// Ranks are spaced out, so names that show up later can be put in between without ranking everything again.
+	struct NameRanks {
+		static const uint32 Spacing = 1 << 12;
+
+		TMap<FNameEntryId, uint32> Ranks;
+		TArray<FName> Sorted; // Without numbers.
+		TArray<uint32> SortedRanks;
+
+		void Build(TArray<FName>& Names);
+		bool GetKey(FName Name, uint64& Key); // False when there is no room left between the neighbours.
+	};
+
+	struct ActorSortKey {
+		uint64 NameKey;
+		uint64 ClassKey;
+		uint64 Address;
+		int Size;
+		float DistanceSq; // To SpatialIndex.Origin, updated when sorting by distance.
+	};
+
+	struct ActorSortSpec {
+		int ColumnID;
+		bool Descending;
+	};
+
+	// Actors tab items with their sort keys, which are made once when an actor gets added,
+	// so sorting never has to touch the actors.
+	struct ActorTable {
+		TArray<PropertyItem> Items;
+		TArray<ActorSortKey> Keys; // Same order as Items.
+		TArray<ActorSortSpec> Specs;
+		NameRanks Names;
+
+		void Set(TArray<PropertyItem>& NewItems);
+		void Add(AActor* Actor);
+		void Remove(TSet<AActor*>& Actors);
+		void Empty();
+		void SetSpecs(ImGuiTableSortSpecs* SortSpecs);
+		void Sort();
+		void RebuildKeys();
+		bool MakeKey(PropertyItem& Item, ActorSortKey& Key);
+		bool Less(const ActorSortKey& A, const ActorSortKey& B) const;
+	};
+
+	//
+
+	enum PropertyTagFlags {
+		TagFlag_Expandable    = 1 << 0,
+		TagFlag_Numeric       = 1 << 1,
+		TagFlag_Object        = 1 << 2, // FObjectProperty, item pointer is the object.
+		TagFlag_ObjectPointer = 1 << 3, // Weak/lazy/soft object pointers.
+		TagFlag_Struct        = 1 << 4,
+	};
+
+	struct PropertyTagInfo {
+		typedef void (*DrawFunc)(PropertyItem& Item);
+		typedef FAView (*FormatFunc)(PropertyItem& Item);
+
+		DrawFunc DrawValue;
+		FormatFunc FormatValue; // Optional.
+		ImVec4 Color;
+		bool HasColor;
+		int Flags;
+	};
+
+	PropertyTag ResolvePropertyTag(FProperty* Prop);
+	PropertyTag GetPropertyTag(FProperty* Prop);
+	const PropertyTagInfo& GetTagInfo(PropertyTag Tag);
+	FORCEINLINE bool TagHasFlag(PropertyTag Tag, int Flag) { return GetTagInfo(Tag).Flags & Flag; }
+
 	//
 
 	struct SectionHelper {
-		FName                         CurrentName = NAME_None;
 		int                           CurrentIndex = 0;
 		bool                          Enabled = false;
-		TInlineComponentArray<FAView> SectionNames;
-		TInlineComponentArray<int>    StartIndexes;
+		TempArray<FAView>             SectionNames;
+		TempArray<int>                StartIndexes;
 		int                           CurrentSectionIndex = 0;
 
-		FORCEINLINE void Add(FName Name) {
-			if (Name != CurrentName) {
-				CurrentName = Name;
-				SectionNames.Add(TMem.NToA(CurrentName));
-				StartIndexes.Push(CurrentIndex);
-			}
-			CurrentIndex++;
-		}
-
-		void Init() {
-			StartIndexes.Push(CurrentIndex); // For last section to get correct member end index.
+		// Object members and functions are already partitioned by owner class in the layout cache.
+		void InitFromSections(const TArray<FAView>& Names, const TArray<int>& SectionStartIndexes) {
+			SectionNames.Append(Names);
+			StartIndexes.Append(SectionStartIndexes);
+			CurrentIndex = StartIndexes.Num() ? StartIndexes.Last() : 0;
 			if (SectionNames.Num() >= 2)
 				Enabled = true;
 		}
+		void InitFromLayout(StructLayout& Layout) { InitFromSections(Layout.SectionNames, Layout.SectionStartIndexes); }
+		void InitFromFunctions(StructLayout& Layout) { InitFromSections(Layout.FunctionSectionNames, Layout.FunctionSectionStartIndexes); }
 
 		int GetSectionCount() { return SectionNames.Num(); };
 